@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+/** Calls batch() (which performs batch_size operations) for the given seconds split into rounds, returns operations
+ * per second of the fastest round, which filters out interruptions by other processes */
+template<typename Batch>
+double measureRate(Batch &&batch, uint64_t batch_size, double seconds = 1.0, unsigned int rounds = 5){
+  double best_rate = 0;
+  for(unsigned int round = 0; round < rounds; round++){
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t operations = 0;
+    double elapsed = 0;
+    do{
+      batch();
+      operations += batch_size;
+      elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while(elapsed < seconds / rounds);
+    best_rate = std::max(best_rate, operations / elapsed);
+  }
+  return best_rate;
+}
+
+/** Keeps the compiler from optimizing the computation of the value away */
+template<typename T>
+inline void doNotOptimize(const T &value){
+  asm volatile("" : : "r,m"(value) : "memory");
+}
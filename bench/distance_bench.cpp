@@ -0,0 +1,155 @@
+/** Distance access benchmark, move evaluations per second through RoutingInstance::getDistance (inline load from
+ * the padded full matrix, rows hoisted by getDistanceRow) against the former out-of-line access, which mapped the
+ * depot aliases to the depot and switched over the storages:
+ *    distance_bench instance.tsp|instance.vrp ...
+ * Evaluates the costs of random 2-opt and node swap moves on a random tour and the length of a random flat
+ * solution with the routes separated by the depot aliases. The legacy access is measured only on the instances
+ * stored in the full 32-bit matrix. */
+#include "bench_utils.h"
+#include "common/routing_instance.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+
+/** Matrix accessed the way getDistance worked before the padded matrix */
+class LegacyDistances{
+private:
+  std::vector<uint> matrix_;
+  uint node_count_;
+  DistanceStorage storage_;
+
+public:
+  explicit LegacyDistances(const RoutingInstance &instance) :
+    matrix_((size_t)instance.getNodesCount() * instance.getNodesCount()), node_count_(instance.getNodesCount()),
+    storage_(FULL_MATRIX_STORAGE) {
+    for(uint from = 0; from < node_count_; from++)
+      for(uint to = 0; to < node_count_; to++)
+        matrix_[(size_t)from * node_count_ + to] = instance.getDistance(from, to);
+  }
+
+  [[nodiscard]] __attribute__((noinline)) uint getDistance(uint from, uint to) const {
+    from = from >= node_count_ ? 0 : from;
+    to = to >= node_count_ ? 0 : to;
+    switch(storage_){
+      case FULL_MATRIX_STORAGE:
+        return matrix_[(size_t)from * node_count_ + to];
+      default:
+        return 0;
+    }
+  }
+};
+
+struct Move{
+  uint i;
+  uint j;
+};
+
+template<typename Distances>
+static double twoOptCosts(const Distances &distances, const std::vector<uint> &tour, const std::vector<Move> &moves){
+  const uint size = tour.size();
+  return measureRate([&](){
+    long long sum = 0;
+    for(const Move &move : moves){
+      const uint a = tour[move.i], b = tour[move.i + 1 == size ? 0 : move.i + 1];
+      const uint c = tour[move.j], d = tour[move.j + 1 == size ? 0 : move.j + 1];
+      sum += (long long)distances.getDistance(a, c) + distances.getDistance(b, d) - distances.getDistance(a, b) -
+             distances.getDistance(c, d);
+    }
+    doNotOptimize(sum);
+  }, moves.size());
+}
+
+template<typename Distances>
+static double swapCosts(const Distances &distances, const std::vector<uint> &tour, const std::vector<Move> &moves){
+  const uint size = tour.size();
+  return measureRate([&](){
+    long long sum = 0;
+    for(const Move &move : moves){
+      const uint prev_i = tour[move.i == 0 ? size - 1 : move.i - 1], i = tour[move.i];
+      const uint next_i = tour[move.i + 1 == size ? 0 : move.i + 1];
+      const uint prev_j = tour[move.j == 0 ? size - 1 : move.j - 1], j = tour[move.j];
+      const uint next_j = tour[move.j + 1 == size ? 0 : move.j + 1];
+      sum += (long long)distances.getDistance(prev_i, j) + distances.getDistance(j, next_i) +
+             distances.getDistance(prev_j, i) + distances.getDistance(i, next_j) -
+             distances.getDistance(prev_i, i) - distances.getDistance(i, next_i) -
+             distances.getDistance(prev_j, j) - distances.getDistance(j, next_j);
+    }
+    doNotOptimize(sum);
+  }, moves.size());
+}
+
+/** Edges per second of the length of the flat solution */
+template<typename Distances>
+static double flatLength(const Distances &distances, const std::vector<uint> &flat){
+  return measureRate([&](){
+    long long sum = 0;
+    for(size_t k = 1; k < flat.size(); k++)
+      sum += distances.getDistance(flat[k - 1], flat[k]);
+    doNotOptimize(sum);
+  }, flat.size() - 1);
+}
+
+static double flatLengthByRows(const RoutingInstance &instance, const std::vector<uint> &flat){
+  return measureRate([&](){
+    long long sum = 0;
+    const uint *row = instance.getDistanceRow(flat[0]);
+    for(size_t k = 1; k < flat.size(); k++){
+      sum += row[flat[k]];
+      row = instance.getDistanceRow(flat[k]);
+    }
+    doNotOptimize(sum);
+  }, flat.size() - 1);
+}
+
+int main(int argc, char *argv[]){
+  if(argc < 2){
+    fprintf(stderr, "Usage: %s instance ...\n", argv[0]);
+    return 100;
+  }
+  for(int arg = 1; arg < argc; arg++){
+    RoutingInstance instance;
+    instance.loadTSPlibInstance(argv[arg]);
+    const uint size = instance.getNodesCount();
+    std::mt19937 gen(0);
+
+    std::vector<uint> tour(size);
+    std::iota(tour.begin(), tour.end(), 0);
+    std::shuffle(tour.begin(), tour.end(), gen);
+    std::vector<Move> moves;
+    std::uniform_int_distribution<uint> position(0, size - 1);
+    while(moves.size() < 100000){
+      const uint i = position(gen);
+      const uint j = position(gen);
+      // 2-opt and swap formulas above assume nonadjacent positions
+      if(i + 1 < j && !(i == 0 && j + 1 == size))
+        moves.push_back({i, j});
+    }
+
+    // customers split into routes by the depot aliases size .. size + vehicles - 1, as in the flat individuals
+    const uint vehicles = std::max(instance.getVehicleCount(), 1);
+    std::vector<uint> flat(tour);
+    flat.erase(std::find(flat.begin(), flat.end(), 0u));
+    for(uint v = 0; v < vehicles; v++)
+      flat.insert(flat.begin() + (size_t)v * flat.size() / vehicles, size + v);
+
+    printf("%s (%u nodes, %u vehicles), millions per second\n", argv[arg], size, vehicles);
+    printf("%24s %10s %10s\n", "", "legacy", "inline");
+    if(instance.getDistanceRow(0) == nullptr){
+      // no full matrix to compare with, getDistance falls back to getStoredDistance
+      printf("%24s %10s %10.1f\n", "2-opt move costs", "-", twoOptCosts(instance, tour, moves) / 1e6);
+      printf("%24s %10s %10.1f\n", "swap move costs", "-", swapCosts(instance, tour, moves) / 1e6);
+      printf("%24s %10s %10.1f\n", "flat solution edges", "-", flatLength(instance, flat) / 1e6);
+      continue;
+    }
+    const LegacyDistances legacy(instance);
+    printf("%24s %10.1f %10.1f\n", "2-opt move costs", twoOptCosts(legacy, tour, moves) / 1e6,
+           twoOptCosts(instance, tour, moves) / 1e6);
+    printf("%24s %10.1f %10.1f\n", "swap move costs", swapCosts(legacy, tour, moves) / 1e6,
+           swapCosts(instance, tour, moves) / 1e6);
+    printf("%24s %10.1f %10.1f\n", "flat solution edges", flatLength(legacy, flat) / 1e6,
+           flatLength(instance, flat) / 1e6);
+    printf("%24s %10s %10.1f\n", "  by getDistanceRow", "", flatLengthByRows(instance, flat) / 1e6);
+  }
+  return 0;
+}
@@ -0,0 +1,52 @@
+/** Instance loading benchmark, wall-clock time of parsing the instance file and building its distances:
+ *    load_bench [--runs n] [--solomon] [--cache directory] instance ...
+ * TSPLIB files by default, Solomon files with --solomon. With --cache the first run fills the binary instance cache
+ * and the reported runs load from it. Prints the fastest and the median of the runs (default 5). */
+#include "common/routing_instance.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static double loadSeconds(const char *filename, bool solomon){
+  const auto start = std::chrono::steady_clock::now();
+  RoutingInstance instance;
+  if(solomon)
+    instance.loadSolomonInstance(filename);
+  else
+    instance.loadTSPlibInstance(filename);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]){
+  uint runs = 5;
+  bool solomon = false;
+  std::vector<const char *> filenames;
+  for(int i = 1; i < argc; i++){
+    if(strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+      runs = std::max(std::stoul(argv[++i]), 1ul);
+    else if(strcmp(argv[i], "--solomon") == 0)
+      solomon = true;
+    else if(strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+      RoutingInstance::setCacheDirectory(argv[++i]);
+    else
+      filenames.push_back(argv[i]);
+  }
+  if(filenames.empty()){
+    fprintf(stderr, "Usage: %s [--runs n] [--solomon] [--cache directory] instance ...\n", argv[0]);
+    return 100;
+  }
+  printf("%-40s %10s %10s\n", "instance", "min [s]", "median [s]");
+  for(const char *filename : filenames){
+    // warms the page cache (and fills the instance cache)
+    loadSeconds(filename, solomon);
+    std::vector<double> times;
+    for(uint run = 0; run < runs; run++)
+      times.push_back(loadSeconds(filename, solomon));
+    std::sort(times.begin(), times.end());
+    printf("%-40s %10.4f %10.4f\n", filename, times.front(), times[times.size() / 2]);
+  }
+  return 0;
+}
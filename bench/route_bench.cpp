@@ -0,0 +1,168 @@
+/** Route evaluation benchmark, customers per second of the full evaluation of a random solution, every route
+ * evaluated from scratch:
+ *    route_bench [--solomon] instance ...
+ * CVRP instances in the TSPLIB format by default, VRP-TW Solomon instances with --solomon. Copies of the route
+ * evaluation loop (evaluateRoute of the VRP-TW individual) read the node attributes from the Node structs and from
+ * the structure-of-arrays of RoutingInstance, the last column is evaluate() of the individual itself. */
+#include "CVRP/cvrp_structured_individual.h"
+#include "VRP-TW/vrptw_structured_individual.h"
+#include "bench_utils.h"
+#include "common/routing_instance.h"
+#include <cstdio>
+#include <cstring>
+
+/** Node attributes read from the Node structs, as before the structure-of-arrays form */
+struct NodeStructAttributes{
+  const Node *nodes;
+
+  explicit NodeStructAttributes(const RoutingInstance &instance) : nodes(instance.getNodes().data()) {}
+  [[nodiscard]] inline uint demand(uint node) const {return nodes[node].demand;}
+  [[nodiscard]] inline int readyTime(uint node) const {return nodes[node].ready_time;}
+  [[nodiscard]] inline int dueDate(uint node) const {return nodes[node].due_date;}
+  [[nodiscard]] inline int serviceTime(uint node) const {return nodes[node].service_time;}
+};
+
+/** Node attributes read from the arrays of RoutingInstance */
+struct NodeArrayAttributes{
+  const uint *demands;
+  const int *ready_times;
+  const int *due_dates;
+  const int *service_times;
+
+  explicit NodeArrayAttributes(const RoutingInstance &instance) : demands(instance.getDemands()),
+    ready_times(instance.getReadyTimes()), due_dates(instance.getDueDates()), service_times(instance.getServiceTimes()) {}
+  [[nodiscard]] inline uint demand(uint node) const {return demands[node];}
+  [[nodiscard]] inline int readyTime(uint node) const {return ready_times[node];}
+  [[nodiscard]] inline int dueDate(uint node) const {return due_dates[node];}
+  [[nodiscard]] inline int serviceTime(uint node) const {return service_times[node];}
+};
+
+/** Copy of the VRP-TW route evaluation (both time window directions), returns the total time */
+template<typename Attributes>
+static long long vrptwEvaluation(const RoutingInstance &instance, const Attributes &attributes,
+                                 std::vector<VrptwIndividualRoute> &routes){
+  long long total_time = 0;
+  for(auto &route : routes){
+    auto &customers = route.customers;
+    route.demand = 0;
+    route.travel_time = 0;
+    VrptwTimeWindowSegment time_windows = VrptwTimeWindowSegment::routeStart();
+    uint prev_node = 0;
+    for(auto &customer : customers){
+      const uint node = customer.idx;
+      const uint dist = instance.getDistance(prev_node, node);
+      route.travel_time += dist;
+      route.demand += attributes.demand(node);
+      time_windows = time_windows.concatenate(VrptwTimeWindowSegment::visit(attributes.readyTime(node),
+          attributes.dueDate(node), attributes.serviceTime(node)), (int)dist);
+      customer.time_up_to = (uint)(time_windows.endTime() - attributes.serviceTime(node));
+      customer.travel_time_up_to = route.travel_time;
+      customer.demand_up_to = route.demand;
+      customer.time_windows_up_to = time_windows;
+      prev_node = node;
+    }
+    const uint dist = instance.getDistance(prev_node, 0);
+    route.travel_time += dist;
+    time_windows = time_windows.concatenate(VrptwTimeWindowSegment::routeEnd(), (int)dist);
+    route.time = (uint)time_windows.endTime();
+    route.time_violation = (uint)time_windows.time_warp;
+
+    VrptwTimeWindowSegment time_windows_from = VrptwTimeWindowSegment::routeEnd();
+    uint next_node = 0;
+    for(int c = (int)customers.size() - 1; c >= 0; c--){
+      const uint node = customers[c].idx;
+      time_windows_from = VrptwTimeWindowSegment::visit(attributes.readyTime(node), attributes.dueDate(node),
+          attributes.serviceTime(node)).concatenate(time_windows_from, (int)instance.getDistance(node, next_node));
+      customers[c].time_windows_from = time_windows_from;
+      next_node = node;
+    }
+    total_time += route.time;
+  }
+  return total_time;
+}
+
+/** Copy of the CVRP route evaluation, returns the total time */
+template<typename Attributes>
+static long long cvrpEvaluation(const RoutingInstance &instance, const Attributes &attributes,
+                                std::vector<CvrpIndividualRoute> &routes){
+  long long total_time = 0;
+  for(auto &route : routes){
+    route.demand = 0;
+    route.time = 0;
+    uint prev_node = 0;
+    for(auto &customer : route.customers){
+      route.demand += attributes.demand(customer.idx);
+      route.time += instance.getDistance(prev_node, customer.idx);
+      customer.time_up_to = route.time;
+      customer.demand_up_to = route.demand;
+      prev_node = customer.idx;
+    }
+    route.time += instance.getDistance(prev_node, 0);
+    total_time += route.time;
+  }
+  return total_time;
+}
+
+template<typename IndividualType, typename Evaluation>
+static void compare(const RoutingInstance &instance, Evaluation &&evaluation){
+  IndividualType individual(&instance);
+  individual.initialize();
+  individual.evaluate();
+  auto routes = individual.getRoutes();
+  long long total_time = 0;
+  for(const auto &route : routes)
+    total_time += route.time;
+  const NodeStructAttributes struct_attributes(instance);
+  const NodeArrayAttributes array_attributes(instance);
+  const bool same = evaluation(instance, struct_attributes, routes) == total_time &&
+                    evaluation(instance, array_attributes, routes) == total_time;
+  const uint customers = instance.getNodesCount() - 1;
+  const double struct_rate = measureRate([&](){
+    doNotOptimize(evaluation(instance, struct_attributes, routes));
+  }, customers);
+  const double array_rate = measureRate([&](){
+    doNotOptimize(evaluation(instance, array_attributes, routes));
+  }, customers);
+  const double individual_rate = measureRate([&](){
+    individual.resetEvaluated();
+    individual.evaluate();
+    doNotOptimize(individual.getFitness());
+  }, customers);
+  printf("%-16s %10.1f %10.1f %12.1f %s\n", instance.getInstanceName().c_str(), struct_rate / 1e6, array_rate / 1e6,
+         individual_rate / 1e6, same ? "" : "(results differ)");
+}
+
+int main(int argc, char *argv[]){
+  bool solomon = false;
+  std::vector<const char *> filenames;
+  for(int i = 1; i < argc; i++){
+    if(strcmp(argv[i], "--solomon") == 0)
+      solomon = true;
+    else
+      filenames.push_back(argv[i]);
+  }
+  if(filenames.empty()){
+    fprintf(stderr, "Usage: %s [--solomon] instance ...\n", argv[0]);
+    return 100;
+  }
+  printf("%-16s %10s %10s %12s   millions of evaluated customers per second\n", "instance", "structs", "arrays",
+         "evaluate()");
+  for(const char *filename : filenames){
+    RoutingInstance instance;
+    if(solomon){
+      instance.loadSolomonInstance(filename);
+      compare<VrptwIndividualStructured>(instance, [](const RoutingInstance &instance, const auto &attributes,
+                                                      std::vector<VrptwIndividualRoute> &routes){
+        return vrptwEvaluation(instance, attributes, routes);
+      });
+    }
+    else{
+      instance.loadTSPlibInstance(filename);
+      compare<CvrpIndividualStructured>(instance, [](const RoutingInstance &instance, const auto &attributes,
+                                                     std::vector<CvrpIndividualRoute> &routes){
+        return cvrpEvaluation(instance, attributes, routes);
+      });
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+/** Tour representations benchmark, 2-opt moves per second of TspArrayTour and TspTwoLevelTour:
+ *    tour_bench [nodes ...]          random 2-opt moves on random tours (default 1000 10000 100000 1000000 nodes)
+ *    tour_bench --instance file.tsp  accepted moves of a first-improvement 2-opt search over the 8 nearest
+ *                                    candidates, restarted from a random tour when it reaches a local optimum */
+#include "TSP/tsp_array_tour.h"
+#include "TSP/tsp_two_level_tour.h"
+#include "bench_utils.h"
+#include "common/routing_instance.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+
+static std::vector<uint> randomOrder(uint size, std::mt19937 &gen){
+  std::vector<uint> order(size);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), gen);
+  return order;
+}
+
+static double randomMoves(TspTour &tour, uint size){
+  std::mt19937 gen(0);
+  tour.load(randomOrder(size, gen));
+  std::uniform_int_distribution<uint> node_dist(0, size - 1);
+  return measureRate([&](){
+    for(uint i = 0; i < 1000; i++){
+      const uint a = node_dist(gen);
+      const uint c = node_dist(gen);
+      const uint b = tour.next(a);
+      const uint d = tour.next(c);
+      if(a == c || b == c || d == a)
+        continue;
+      tour.make2optMove(a, b, c, d);
+    }
+  }, 1000);
+}
+
+static double accepted2optMoves(TspTour &tour, const RoutingInstance &instance){
+  const uint size = instance.getNodesCount();
+  const uint candidate_count = instance.getCandidateCount();
+  std::mt19937 gen(0);
+  tour.load(randomOrder(size, gen));
+  uint node = 0;
+  uint since_improvement = 0;
+  uint64_t accepted = 0;
+  const auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  do{
+    for(uint i = 0; i < 1000; i++){
+      const uint a = node;
+      node = node + 1 == size ? 0 : node + 1;
+      const uint b = tour.next(a);
+      const long long removed_ab = instance.getDistance(a, b);
+      const uint *candidates = instance.getCandidates(a);
+      const uint *candidate_distances = instance.getCandidateDistances(a);
+      bool improved = false;
+      for(uint k = 0; k < candidate_count && candidate_distances[k] < removed_ab; k++){
+        const uint c = candidates[k];
+        const uint d = tour.next(c);
+        if(c == b || d == a)
+          continue;
+        const long long delta = (long long)candidate_distances[k] + instance.getDistance(b, d) - removed_ab -
+                                instance.getDistance(c, d);
+        if(delta < 0){
+          tour.make2optMove(a, b, c, d);
+          accepted++;
+          improved = true;
+          break;
+        }
+      }
+      since_improvement = improved ? 0 : since_improvement + 1;
+      if(since_improvement == size){
+        tour.load(randomOrder(size, gen));
+        since_improvement = 0;
+      }
+    }
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while(elapsed < 2.0);
+  return accepted / elapsed;
+}
+
+int main(int argc, char *argv[]){
+  if(argc == 3 && strcmp(argv[1], "--instance") == 0){
+    RoutingInstance instance;
+    instance.loadTSPlibInstance(argv[2]);
+    instance.buildCandidateLists(8);
+    TspArrayTour array_tour;
+    TspTwoLevelTour two_level_tour;
+    printf("%s (%d nodes), accepted 2-opt moves/s\n", argv[2], instance.getNodesCount());
+    printf("  array      %12.0f\n", accepted2optMoves(array_tour, instance));
+    printf("  two_level  %12.0f\n", accepted2optMoves(two_level_tour, instance));
+    return 0;
+  }
+  std::vector<uint> sizes;
+  for(int i = 1; i < argc; i++)
+    sizes.push_back(std::stoul(argv[i]));
+  if(sizes.empty())
+    sizes = {1000, 10000, 100000, 1000000};
+  printf("%10s %14s %14s   random 2-opt moves/s\n", "nodes", "array", "two_level");
+  for(const uint size : sizes){
+    TspArrayTour array_tour;
+    TspTwoLevelTour two_level_tour;
+    const double array_rate = randomMoves(array_tour, size);
+    const double two_level_rate = randomMoves(two_level_tour, size);
+    printf("%10u %14.0f %14.0f\n", size, array_rate, two_level_rate);
+  }
+  return 0;
+}
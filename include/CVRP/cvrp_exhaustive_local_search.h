@@ -21,7 +21,8 @@ private:
 public:
   CvrpExhaustiveLocalSearch(const std::shared_ptr<RoutingInstance> &instance, const std::shared_ptr<Neighborhood> &neighborhood);
   void initialize(HeuristicPortfolio *portfolio) override;
-  void run() override;
+  bool startUnits() override;
+  bool runUnit() override;
   void terminate() override;
   void acceptSolution(std::shared_ptr<Solution> solution) override;
 };
\ No newline at end of file
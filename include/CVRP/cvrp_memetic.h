@@ -34,7 +34,8 @@ public:
               );
 
   void initialize(HeuristicPortfolio *portfolio) override;
-  void run() override;
+  bool startUnits() override;
+  bool runUnit() override;
   void terminate() override;
   void acceptSolution(std::shared_ptr<Solution> solution) override;
 };
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include "heuristic_framework/neighborhood.h"
+#include "common/route_sectors.h"
 #include "CVRP/cvrp_structured_individual.h"
+#include <deque>
 #include <random>
 
 class CvrpNeighborhood : public Neighborhood {
@@ -18,18 +20,49 @@ private:
   std::random_device rand_;
   std::mt19937 gen_;
   std::uniform_real_distribution<double> dist_;
+  /** Node-centered mode: moves connecting an active customer to its partners (candidate_count_ nearest neighbors or all nodes) */
+  std::shared_ptr<RoutingInstance> instance_;
+  uint candidate_count_;
+  uint partner_count_;
+  std::vector<uint> all_nodes_;
+  std::vector<int> route_of_; // route index of each customer
+  std::vector<int> position_of_; // position of each customer in its route
+  /** Don't-look bits: FIFO of customers to examine and their membership flags, separate for each move type */
+  std::deque<uint> active_nodes_[neighborhood_options::SIZE];
+  std::vector<bool> is_active_[neighborhood_options::SIZE];
+  /** Inter-route moves are tried only for routes with overlapping polar sectors (disabled by default) */
+  RouteSectors sectors_;
 
   bool perform2opt(const std::shared_ptr<CvrpIndividualStructured> &individual);
   bool performExchange(const std::shared_ptr<CvrpIndividualStructured> &individual);
   bool performRelocate(const std::shared_ptr<CvrpIndividualStructured> &individual);
   bool performCross(const std::shared_ptr<CvrpIndividualStructured> &individual);
 
+  bool perform2optGranular(const std::shared_ptr<CvrpIndividualStructured> &individual);
+  bool performExchangeGranular(const std::shared_ptr<CvrpIndividualStructured> &individual);
+  bool performRelocateGranular(const std::shared_ptr<CvrpIndividualStructured> &individual);
+  bool performCrossGranular(const std::shared_ptr<CvrpIndividualStructured> &individual);
+  /** Tests and performs 2-opt move of customers [start, end] of the route if it is valid and improving */
+  bool try2optMove(const std::shared_ptr<CvrpIndividualStructured> &individual, uint route_idx, int start, int end);
+  /** Updates route_of_ and position_of_ for customers of the changed route and clears their don't-look bits */
+  void updateRoute(const std::shared_ptr<CvrpIndividualStructured> &individual, uint route_idx);
+  /** Recomputes the sectors of all routes, the full neighborhood does it before each pass */
+  void updateSectors(const std::shared_ptr<CvrpIndividualStructured> &individual);
+  bool popActiveNode(neighborhood_options option, uint &node);
+  [[nodiscard]] const uint *getPartners(uint node) const;
+
   neighborhood_options selectNeighborhoodOption();
   void success(neighborhood_options neighborhood);
   void failure(neighborhood_options neighborhood);
 
 public:
   CvrpNeighborhood();
+  /** Node-centered neighborhood with don't-look bits, using candidate lists of the instance
+   * (must be built with at least candidate_count) or all nodes if candidate_count is 0 */
+  CvrpNeighborhood(const std::shared_ptr<RoutingInstance> &instance, uint candidate_count);
+  /** Skips route pairs whose polar sectors around the depot, widened by the tolerance in degrees on both sides,
+   * don't overlap; instances without coordinates aren't pruned */
+  void setRoutePruning(const RoutingInstance &instance, double tolerance_degrees);
   SearchResult search(const std::shared_ptr<Individual> &individual) override;
   void reset(const std::shared_ptr<Individual> &individual) override;
 };
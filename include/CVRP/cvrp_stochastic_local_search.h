@@ -9,7 +9,6 @@ class CvrpStochasticLocalSearch : public Heuristic{
 private:
   std::shared_ptr<Solution> best_solution_;
   std::shared_ptr<RoutingInstance> instance_;
-  const uint *matrix_;
   HeuristicPortfolio *portfolio_;
   std::atomic<bool> terminate_;
   std::shared_ptr<Mutation> mutation_;
@@ -22,7 +21,8 @@ private:
 public:
   explicit CvrpStochasticLocalSearch(const std::shared_ptr<RoutingInstance> &instance, const std::shared_ptr<Mutation> &mutation);
   void initialize(HeuristicPortfolio *portfolio) override;
-  void run() override;
+  bool startUnits() override;
+  bool runUnit() override;
   void terminate() override;
   void acceptSolution(std::shared_ptr<Solution>) override;
 };
\ No newline at end of file
@@ -53,10 +53,13 @@ private:
   std::vector<double> demand_violation_; // stored as vector for multi-constraint algorithms
   bool is_evaluated_;
 
-  /** Returns a new route where remove segment in to_route is replaced by insert_segment from from_route */
-  CvrpIndividualRoute insertSegment(const CvrpIndividualRoute &to_route, const CvrpIndividualRoute &from_route, const CvrpRouteSegment &remove_segment, const CvrpRouteSegment &insert_segment);
-  /** Exchanges route on the given index with the new route and performs necessary changes to fitness and demand violation */
-  void exchange_route(const uint &route_idx, const CvrpIndividualRoute &new_route);
+  /** Replaces remove segment by the nodes in place, reusing the route's capacity, re-evaluates the route from the first
+   * changed position and updates fitness and demand violation */
+  void replaceSegment(const CvrpRouteSegment &remove_segment, const std::vector<uint> &nodes);
+  /** Each of the segments takes the place of the other one, the segments must be in different routes */
+  void swapSegments(const CvrpRouteSegment &segment1, const CvrpRouteSegment &segment2);
+  /** Recomputes the prefix times and demands of the route from the customer on and the route totals */
+  void evaluateRouteFrom(CvrpIndividualRoute &route, uint first_idx);
   /** Returns travel time of the segment (excluding time to move from/to segment) */
   uint getSegmentTime(const CvrpRouteSegment &segment);
   /** Returns demand of the route segment*/
@@ -72,6 +75,9 @@ public:
   std::shared_ptr<Solution> convertSolution();
   void initialize() override;
   void smartInitialize() override;
+  /** Routes grown from a random customer by the nearest customer fitting into the vehicle, the last route takes the rest,
+   * checks should_terminate once per added customer and gives up with false and initialize() when it returns true */
+  bool nearestNeighborInitialize(const std::function<bool()> &should_terminate);
   void resetEvaluated() override;
   bool betterThan(const std::shared_ptr<Individual> &other) override;
   double getFitness() override;
@@ -113,6 +119,13 @@ public:
   FitnessDiff getRelocateMoveCost(const CvrpRouteSegment &segment_moved, const CvrpRouteSegment &target_pos);
   FitnessDiff getCrossMoveCost(const CvrpRouteSegment &segment1, const CvrpRouteSegment &segment2);
 
+  /** Removes the given route segment */
+  void performRemoval(const CvrpRouteSegment &segment);
+  /** Inserts the node before start idx of the target position, customers.size() for insertion at the end */
+  void performInsertion(const CvrpRouteSegment &target_pos, uint node);
+  FitnessDiff getRemovalCost(const CvrpRouteSegment &segment);
+  FitnessDiff getInsertionCost(const CvrpRouteSegment &target_pos, uint node);
+
   FitnessDiff getFitnessDiff(const CvrpIndividualStructured &other);
 
   bool assertIndividual();
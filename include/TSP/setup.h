@@ -6,5 +6,6 @@ using JSON = nlohmann::json;
 
 class SetupTSP{
 public:
-  std::shared_ptr<HeuristicPortfolio> preparePortfolio(const JSON &config, const char* instance_filename);
+  std::shared_ptr<HeuristicPortfolio> preparePortfolio(const JSON &config, const char* instance_filename,
+                                                       const std::shared_ptr<ThreadScheduling> &scheduling);
 };
@@ -12,6 +12,8 @@ private:
     TWO_OPT,
     SWAP,
     RELOCATE,
+    OR_OPT,
+    THREE_OPT,
     SIZE
   };
   double try_count[neighborhood_options::SIZE]{};
@@ -23,6 +25,10 @@ private:
   StepResult perform2opt(const std::shared_ptr<TspIndividualStructured> &individual, const std::shared_ptr<SASchedule> &schedule, const std::shared_ptr<TspIndividualStructured> &best_individual);
   StepResult performSwap(const std::shared_ptr<TspIndividualStructured> &individual, const std::shared_ptr<SASchedule> &schedule, const std::shared_ptr<TspIndividualStructured> &best_individual);
   StepResult performRelocate(const std::shared_ptr<TspIndividualStructured> &individual, const std::shared_ptr<SASchedule> &schedule, const std::shared_ptr<TspIndividualStructured> &best_individual);
+  StepResult performOrOpt(const std::shared_ptr<TspIndividualStructured> &individual, const std::shared_ptr<SASchedule> &schedule, const std::shared_ptr<TspIndividualStructured> &best_individual);
+  StepResult perform3opt(const std::shared_ptr<TspIndividualStructured> &individual, const std::shared_ptr<SASchedule> &schedule, const std::shared_ptr<TspIndividualStructured> &best_individual);
+  /** Moves the segment to idx_to if the move is improving or accepted by the schedule */
+  StepResult trySegmentInsertion(const std::shared_ptr<TspIndividualStructured> &individual, const std::shared_ptr<SASchedule> &schedule, const std::shared_ptr<TspIndividualStructured> &best_individual, const TspIndividualSegment &segment);
 
   neighborhood_options selectNeighborhoodOption();
   void success(neighborhood_options neighborhood);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "TSP/tsp_tour.h"
+
+/** Tour stored as an array with a position index, next/prev are O(1) and 2-opt moves reverse
+ * the shorter side of the tour (O(n) worst case) */
+class TspArrayTour : public TspTour{
+private:
+  std::vector<uint> order_;
+  std::vector<uint> positions_;
+
+  /** Reverses the cyclic range of positions from..to (inclusive, may wrap around) */
+  void reverse(uint from, uint to);
+
+public:
+  TspArrayTour() = default;
+  explicit TspArrayTour(const std::vector<uint> &order);
+  void load(const std::vector<uint> &order) override;
+  [[nodiscard]] std::vector<uint> getOrder() const override {return order_;}
+  [[nodiscard]] uint size() const override {return order_.size();}
+
+  [[nodiscard]] uint next(uint node) const override {
+    const uint pos = positions_[node] + 1;
+    return order_[pos == order_.size() ? 0 : pos];
+  }
+  [[nodiscard]] uint prev(uint node) const override {
+    const uint pos = positions_[node];
+    return order_[pos == 0 ? order_.size() - 1 : pos - 1];
+  }
+
+  void make2optMove(uint a, uint b, uint c, uint d) override;
+};
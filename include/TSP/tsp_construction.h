@@ -0,0 +1,29 @@
+#pragma once
+#include "TSP/tsp_individual_structured.h"
+#include "common/heuristic.h"
+#include <atomic>
+#include <random>
+
+/** Constructive heuristic run once at the start, builds the given number of starting solutions by the algorithm
+ * and hands them to the portfolio, which passes them out to the improving heuristics */
+class TspConstruction : public Heuristic{
+private:
+  std::shared_ptr<RoutingInstance> instance_;
+  HeuristicPortfolio *portfolio_;
+  std::atomic<bool> terminate_;
+  ConstructionAlgorithm algorithm_;
+  uint solution_count_;
+  /** Solutions built so far */
+  uint built_count_;
+  std::mt19937 gen_;
+
+public:
+  TspConstruction(const std::shared_ptr<RoutingInstance> &instance, ConstructionAlgorithm algorithm, uint solution_count);
+  void initialize(HeuristicPortfolio *portfolio) override;
+  bool startUnits() override;
+  /** Builds one starting solution */
+  bool runUnit() override;
+  void terminate() override;
+  /** Outside solutions are of no use to a construction */
+  void acceptSolution(std::shared_ptr<Solution> solution) override;
+};
@@ -9,7 +9,6 @@ class TspGeneticAlgorithm : public Heuristic{
 private:
   std::shared_ptr<Solution> best_solution_;
   std::shared_ptr<RoutingInstance> instance_;
-  const uint *matrix_;
   HeuristicPortfolio *portfolio_;
   std::atomic<bool> terminate_;
 
@@ -36,7 +35,8 @@ public:
     );
 
   void initialize(HeuristicPortfolio * portfolio) override;
-  void run() override;
+  bool startUnits() override;
+  bool runUnit() override;
   void terminate() override;
   void acceptSolution(std::shared_ptr<Solution> solution) override;
 
@@ -26,6 +26,8 @@ public:
   std::shared_ptr<Solution> convertSolution();
   void initialize() override;
   void smartInitialize() override;
+  /** Nearest-neighbor tour from a random node, checks should_terminate once per appended node */
+  bool smartInitialize(const std::function<bool()> &should_terminate) override;
   void resetEvaluated() override;
   bool betterThan(const std::shared_ptr<Individual> &other) override;
   double getFitness() override;
@@ -53,9 +55,16 @@ public:
 
   bool testRelocateMove(uint idx_from, uint idx_to);
 
+  /** Moves the segment between positions idx_to - 1 and idx_to (data size for the end of the tour), optionally reversed.
+   * Or-opt for short segments, segment insertion 3-opt for longer ones. idx_to must lie outside [start_idx, end_idx + 1] */
+  void performOrOptMove(const TspIndividualSegment &segment, uint idx_to, bool reversed);
+
+  bool testOrOptMove(const TspIndividualSegment &segment, uint idx_to, bool reversed);
+
   FitnessDiff get2optMoveCost(const TspIndividualSegment &segment);
   FitnessDiff getSwapMoveCost(uint idx1, uint idx2);
   FitnessDiff getRelocateMoveCost(uint idx_from, uint idx_to);
+  FitnessDiff getOrOptMoveCost(const TspIndividualSegment &segment, uint idx_to, bool reversed);
   FitnessDiff getFitnessDiff(const TspIndividualStructured &other);
 
   void performDoubleBridgeMove(const TspIndividualSegment &segment1, const TspIndividualSegment &segment2);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "TSP/tsp_tour.h"
+#include "TSP/tsp_individual_structured.h"
+#include "common/heuristic.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+
+/** Chained Lin-Kernighan: variable-depth chains of 2-opt flips over candidate lists driven by a queue of
+ * active nodes, local optima are perturbed by a segment double-bridge kick and kept if they improve */
+class TspLinKernighan : public Heuristic{
+private:
+  struct Flip{
+    uint t2;
+    uint t3;
+    uint t4;
+  };
+
+  std::shared_ptr<Solution> best_solution_;
+  std::shared_ptr<Solution> outside_solution_;
+  std::shared_ptr<RoutingInstance> instance_;
+  HeuristicPortfolio *portfolio_;
+  std::function<void()> poll_solution_;
+  std::atomic<bool> terminate_;
+  std::recursive_mutex solution_mutex_;
+  std::random_device rand_;
+  std::mt19937 gen_;
+  uint candidate_count_;
+  uint max_depth_;
+
+  std::shared_ptr<TspTour> tour_;
+  long tour_length_;
+  std::vector<uint> best_order_;
+  long best_length_;
+  std::deque<uint> active_nodes_;
+  std::vector<bool> is_active_;
+  std::vector<Flip> flips_;
+
+  void sendSolution(const std::shared_ptr<Solution> &solution);
+  bool checkBetterSolution(const std::shared_ptr<Solution> &solution);
+  /** Adopts a better solution received from other heuristics, returns true if it was adopted */
+  bool checkOutsideSolution();
+  void activate(uint node);
+  /** Runs LK chains from the active nodes until none is left or the heuristic is terminated */
+  void optimize();
+  /** Tries to find an improving chain of flips starting by removal of an edge at t1, applies the best one found */
+  bool improveNode(uint t1);
+  [[nodiscard]] bool isAdded(uint a, uint b) const;
+  /** Random double-bridge on two short adjacent segments, done by three flips */
+  void kick();
+  void loadOrder(const std::vector<uint> &order);
+  std::shared_ptr<Solution> convertSolution(const std::vector<uint> &order);
+
+public:
+  /** two_level_tour selects the two-level list tour (faster flips on large instances) instead of the array tour */
+  TspLinKernighan(const std::shared_ptr<RoutingInstance> &instance, uint candidate_count, uint max_depth, bool two_level_tour);
+  void initialize(HeuristicPortfolio *portfolio) override;
+  bool startUnits() override;
+  /** One LK optimization of the active nodes followed by a kick */
+  bool runUnit() override;
+  void terminate() override;
+  void acceptSolution(std::shared_ptr<Solution> solution) override;
+};
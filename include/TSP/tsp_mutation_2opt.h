@@ -1,4 +1,5 @@
 #pragma once
+#include "common/routing_instance.h"
 #include "heuristic_framework/mutation.h"
 #include <random>
 
@@ -6,11 +7,11 @@ class TspMutation2opt : public Mutation{
 private:
   std::random_device rand;
   std::mt19937 gen;
-  const uint * const matrix_;
+  const RoutingInstance * const instance_;
   double mutation_rate_;
 
 public:
-  TspMutation2opt(const uint * const matrix);
+  TspMutation2opt(const RoutingInstance * const instance);
   bool isInPlace() override;
   bool mutate(const std::shared_ptr<Individual> &individual) override;
   double getMutationRate() override;
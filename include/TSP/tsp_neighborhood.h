@@ -1,6 +1,7 @@
 #pragma once
 #include "heuristic_framework/neighborhood.h"
 #include "TSP/tsp_individual_structured.h"
+#include <deque>
 #include <random>
 
 class TspNeighborhood : public Neighborhood{
@@ -9,6 +10,8 @@ private:
     TWO_OPT,
     SWAP,
     RELOCATE,
+    OR_OPT,
+    THREE_OPT,
     SIZE
   };
   bool exhausted_[neighborhood_options::SIZE]{};
@@ -17,10 +20,37 @@ private:
   std::random_device rand_;
   std::mt19937 gen_;
   std::uniform_real_distribution<double> dist_;
+  /** Node-centered mode: moves connecting an active node to its partners (candidate_count_ nearest neighbors or all nodes) */
+  std::shared_ptr<RoutingInstance> instance_;
+  uint candidate_count_;
+  uint partner_count_;
+  std::vector<uint> all_nodes_;
+  std::vector<int> positions_; // tour position of each node, -1 for the depot
+  /** Don't-look bits: FIFO of nodes to examine and their membership flags, separate for each move type */
+  std::deque<uint> active_nodes_[neighborhood_options::SIZE];
+  std::vector<bool> is_active_[neighborhood_options::SIZE];
 
   bool perform2opt(const std::shared_ptr<TspIndividualStructured> &individual);
   bool performSwap(const std::shared_ptr<TspIndividualStructured> &individual);
   bool performRelocate(const std::shared_ptr<TspIndividualStructured> &individual);
+  bool performOrOpt(const std::shared_ptr<TspIndividualStructured> &individual);
+  bool perform3opt(const std::shared_ptr<TspIndividualStructured> &individual);
+
+  bool perform2optGranular(const std::shared_ptr<TspIndividualStructured> &individual);
+  bool performSwapGranular(const std::shared_ptr<TspIndividualStructured> &individual);
+  bool performRelocateGranular(const std::shared_ptr<TspIndividualStructured> &individual);
+  bool performOrOptGranular(const std::shared_ptr<TspIndividualStructured> &individual);
+  bool perform3optGranular(const std::shared_ptr<TspIndividualStructured> &individual);
+  /** Tests and performs 2-opt move of the segment [start, end] if it is valid and improving */
+  bool try2optMove(const std::shared_ptr<TspIndividualStructured> &individual, int start, int end);
+  /** Tests and performs Or-opt move of the segment [start, end] to idx_to if it is valid and improving */
+  bool tryOrOptMove(const std::shared_ptr<TspIndividualStructured> &individual, int start, int end, int idx_to, bool reversed);
+  /** Updates positions_ of nodes on tour positions from..to (inclusive) */
+  void updatePositions(const std::shared_ptr<TspIndividualStructured> &individual, uint from, uint to);
+  /** Clears don't-look bits of nodes on tour positions from..to (inclusive, clamped to the tour) */
+  void activatePositions(const std::shared_ptr<TspIndividualStructured> &individual, int from, int to);
+  bool popActiveNode(neighborhood_options option, uint &node);
+  [[nodiscard]] const uint *getPartners(uint node) const;
 
   neighborhood_options selectNeighborhoodOption();
   void success(neighborhood_options neighborhood);
@@ -28,6 +58,9 @@ private:
 
 public:
   TspNeighborhood();
+  /** Node-centered neighborhood with don't-look bits, using candidate lists of the instance
+   * (must be built with at least candidate_count) or all nodes if candidate_count is 0 */
+  TspNeighborhood(const std::shared_ptr<RoutingInstance> &instance, uint candidate_count);
   SearchResult search(const std::shared_ptr<Individual> &individual) override;
   void reset(const std::shared_ptr<Individual> &individual) override;
 };
\ No newline at end of file
@@ -14,15 +14,19 @@ private:
   std::recursive_mutex solution_mutex_;
   std::shared_ptr<SAStep> step_;
   std::shared_ptr<SASchedule> schedule_;
+  /** Annealing steps run by one unit, amortizes the unit overhead of the portfolio */
+  uint steps_per_unit_;
   std::shared_ptr<SimulatedAnnealing> simulated_annealing_;
 
   void sendSolution(const std::shared_ptr<Solution> &solution);
   bool checkBetterSolution(const std::shared_ptr<Solution> &solution);
 
 public:
-  TspSimulatedAnnealing(const std::shared_ptr<RoutingInstance> &instance, const std::shared_ptr<SAStep> &step, const std::shared_ptr<SASchedule> schedule);
+  TspSimulatedAnnealing(const std::shared_ptr<RoutingInstance> &instance, const std::shared_ptr<SAStep> &step, const std::shared_ptr<SASchedule> schedule, uint steps_per_unit);
   void initialize(HeuristicPortfolio *portfolio) override;
-  void run() override;
+  bool startUnits() override;
+  /** Runs steps_per_unit annealing steps */
+  bool runUnit() override;
   void terminate() override;
   void acceptSolution(std::shared_ptr<Solution> solution) override;
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+using uint = unsigned int;
+
+/** Cyclic tour over all nodes (depot included) with node-based 2-opt moves */
+class TspTour{
+public:
+  virtual void load(const std::vector<uint> &order) = 0;
+  /** Returns nodes in tour order */
+  virtual std::vector<uint> getOrder() const = 0;
+  [[nodiscard]] virtual uint size() const = 0;
+  [[nodiscard]] virtual uint next(uint node) const = 0;
+  [[nodiscard]] virtual uint prev(uint node) const = 0;
+  /** Removes edges (a, b) and (c, d) where b = next(a) and d = next(c), adds (a, c) and (b, d) */
+  virtual void make2optMove(uint a, uint b, uint c, uint d) = 0;
+
+  /** Removes edges (t1, t2) and (t3, t4) and adds (t2, t3) and (t1, t4), t4 must be the neighbor of t3
+   * on the side where t1 lies from t2 (t4 = prev(t3) if t2 = next(t1), otherwise t4 = next(t3)) */
+  void flip(uint t1, uint t2, uint t3, uint t4){
+    if(next(t1) == t2)
+      make2optMove(t1, t2, t4, t3);
+    else
+      make2optMove(t2, t1, t3, t4);
+  }
+
+  virtual ~TspTour() = default;
+};
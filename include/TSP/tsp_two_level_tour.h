@@ -0,0 +1,64 @@
+#pragma once
+
+#include "TSP/tsp_tour.h"
+
+/** Two-level doubly-linked list tour: nodes are split into segments of about sqrt(n) nodes with a reversal bit,
+ * 2-opt moves split at most two segments, reverse the order of whole segments and merge small neighbors,
+ * which makes them O(sqrt(n)) at the price of slightly slower next/prev */
+class TspTwoLevelTour : public TspTour{
+private:
+  struct Segment{
+    bool reversed;
+    uint first; // node with the lowest id
+    uint last; // node with the highest id
+    uint next; // following segment in tour order
+    uint prev;
+    uint rank; // order of the segment in the tour
+    uint size;
+  };
+
+  std::vector<Segment> segments_;
+  std::vector<uint> free_segments_;
+  uint segment_count_;
+  uint group_size_;
+  /** Segment of the node, ids of nodes in a segment are consecutive, tour order follows them unless reversed */
+  std::vector<uint> parent_;
+  std::vector<int> id_;
+  std::vector<uint> id_next_; // node with id + 1 in the same segment
+  std::vector<uint> id_prev_; // node with id - 1 in the same segment
+
+  [[nodiscard]] inline uint logicalFirst(const Segment &segment) const {return segment.reversed ? segment.last : segment.first;}
+  [[nodiscard]] inline uint logicalLast(const Segment &segment) const {return segment.reversed ? segment.first : segment.last;}
+  /** Number of nodes before the node in its segment in tour order */
+  [[nodiscard]] uint offset(uint node) const;
+  uint newSegment();
+  /** Splits the segment of the node so that the node starts a segment */
+  void splitBefore(uint node);
+  /** Reverses the tour path from..to (in tour order) */
+  void reversePath(uint from, uint to);
+  /** Merges segment with its successor if they are small enough together */
+  void tryMerge(uint segment_idx);
+  void updateRanks();
+
+public:
+  TspTwoLevelTour() : segment_count_(0), group_size_(0) {}
+  explicit TspTwoLevelTour(const std::vector<uint> &order);
+  void load(const std::vector<uint> &order) override;
+  [[nodiscard]] std::vector<uint> getOrder() const override;
+  [[nodiscard]] uint size() const override {return parent_.size();}
+
+  [[nodiscard]] uint next(uint node) const override {
+    const Segment &segment = segments_[parent_[node]];
+    if(node == logicalLast(segment))
+      return logicalFirst(segments_[segment.next]);
+    return segment.reversed ? id_prev_[node] : id_next_[node];
+  }
+  [[nodiscard]] uint prev(uint node) const override {
+    const Segment &segment = segments_[parent_[node]];
+    if(node == logicalFirst(segment))
+      return logicalLast(segments_[segment.prev]);
+    return segment.reversed ? id_next_[node] : id_prev_[node];
+  }
+
+  void make2optMove(uint a, uint b, uint c, uint d) override;
+};
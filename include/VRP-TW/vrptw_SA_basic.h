@@ -13,15 +13,19 @@ private:
   std::recursive_mutex solution_mutex_;
   std::shared_ptr<SABasicStep> step_;
   std::shared_ptr<SABasicSchedule> schedule_;
+  /** Annealing steps run by one unit, amortizes the unit overhead of the portfolio */
+  uint steps_per_unit_;
   std::shared_ptr<SimulatedAnnealingBasic> sa_basic_;
 
   void sendSolution(const std::shared_ptr<Solution> &solution);
   bool checkBetterSolution(const std::shared_ptr<Solution> &solution);
 
 public:
-  VrptwSABasic(const std::shared_ptr<RoutingInstance> &instance, const std::shared_ptr<SABasicStep> &step, const std::shared_ptr<SABasicSchedule> schedule);
+  VrptwSABasic(const std::shared_ptr<RoutingInstance> &instance, const std::shared_ptr<SABasicStep> &step, const std::shared_ptr<SABasicSchedule> schedule, uint steps_per_unit);
   void initialize(HeuristicPortfolio *portfolio) override;
-  void run() override;
+  bool startUnits() override;
+  /** Runs steps_per_unit annealing steps */
+  bool runUnit() override;
   void terminate() override;
   void acceptSolution(std::shared_ptr<Solution> solution) override;
 
@@ -0,0 +1,27 @@
+#pragma once
+#include "VRP-TW/vrptw_structured_individual.h"
+#include "common/heuristic.h"
+#include <atomic>
+
+/** Constructive heuristic run once at the start, builds the given number of starting solutions by the algorithm
+ * and hands them to the portfolio, which passes them out to the improving heuristics */
+class VrptwConstruction : public Heuristic{
+private:
+  std::shared_ptr<RoutingInstance> instance_;
+  HeuristicPortfolio *portfolio_;
+  std::atomic<bool> terminate_;
+  ConstructionAlgorithm algorithm_;
+  uint solution_count_;
+  /** Solutions built so far */
+  uint built_count_;
+
+public:
+  VrptwConstruction(const std::shared_ptr<RoutingInstance> &instance, ConstructionAlgorithm algorithm, uint solution_count);
+  void initialize(HeuristicPortfolio *portfolio) override;
+  bool startUnits() override;
+  /** Builds one starting solution */
+  bool runUnit() override;
+  void terminate() override;
+  /** Outside solutions are of no use to a construction */
+  void acceptSolution(std::shared_ptr<Solution> solution) override;
+};
@@ -22,7 +22,8 @@ public:
   VrptwExhaustiveLocalSearch(const std::shared_ptr<RoutingInstance> &instance,
                              const std::shared_ptr<Neighborhood> &neighborhood);
   void initialize(HeuristicPortfolio *portfolio) override;
-  void run() override;
+  bool startUnits() override;
+  bool runUnit() override;
   void terminate() override;
   void acceptSolution(std::shared_ptr<Solution> solution) override;
 };
\ No newline at end of file
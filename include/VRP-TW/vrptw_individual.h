@@ -9,7 +9,6 @@ using uint = unsigned int;
 class VrptwIndividual : public Individual{
 private:
   const RoutingInstance* const instance_;
-  const uint * const matrix_;
   std::vector<uint> data_;
   bool is_evaluated_;
   double fitness_;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "VRP-TW/vrptw_structured_individual.h"
+#include "common/heuristic.h"
+#include "common/routing_ruin_recreate_operators.h"
+#include "common/ruin_recreate_config.h"
+#include "heuristic_framework/ruin_recreate.h"
+#include <atomic>
+#include <mutex>
+
+/** Ruin and recreate operators of the VRP-TW individuals, the accepted cost is the travel time penalized by the used vehicles and the capacity and time window violations */
+class VrptwRuinRecreateOperators : public RoutingRuinRecreateOperators<VrptwIndividualStructured>{
+public:
+  VrptwRuinRecreateOperators(const RoutingInstance *instance, const RuinRecreateParameters &parameters);
+  double getCost(Individual &individual) override;
+};
+
+/** Ruin and recreate heuristic (RuinRecreate) of the VRP-TW portfolio */
+class VrptwRuinRecreate : public Heuristic{
+private:
+  std::shared_ptr<Solution> best_solution_;
+  std::shared_ptr<RoutingInstance> instance_;
+  HeuristicPortfolio *portfolio_;
+  std::atomic<bool> terminate_;
+  std::recursive_mutex solution_mutex_;
+  RuinRecreateParameters parameters_;
+  std::shared_ptr<RuinRecreate> ruin_recreate_;
+
+  void sendSolution(const std::shared_ptr<Solution> &solution);
+  bool checkBetterSolution(const std::shared_ptr<Solution> &solution);
+
+public:
+  VrptwRuinRecreate(const std::shared_ptr<RoutingInstance> &instance, const RuinRecreateConfig &config);
+  void initialize(HeuristicPortfolio *portfolio) override;
+  bool startUnits() override;
+  /** Runs the configured number of ruin and recreate iterations */
+  bool runUnit() override;
+  void terminate() override;
+  void acceptSolution(std::shared_ptr<Solution> solution) override;
+};
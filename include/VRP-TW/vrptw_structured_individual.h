@@ -4,6 +4,8 @@
 #include "common/routing_instance.h"
 #include "common/solution.h"
 #include "heuristic_framework/simulated_annealing_fitness_diff.h"
+#include <algorithm>
+#include <limits>
 
 using uint = unsigned int;
 
@@ -13,15 +15,52 @@ struct VrptwRouteSegment{
   uint segment_length;
 };
 
+/** Time window data of a sequence of visits (time warp of Vidal et al.): a vehicle arriving after a due date
+ * travels back in time to it and the lateness counts as time warp, so that the data of two sequences concatenate
+ * in O(1) */
+struct VrptwTimeWindowSegment{
+  /** Travel, service and waiting time, time warp not subtracted */
+  int duration;
+  int time_warp;
+  /** Earliest and latest start of the sequence without additional waiting or time warp */
+  int earliest_start;
+  int latest_start;
+
+  VrptwTimeWindowSegment() : duration(0), time_warp(0), earliest_start(0), latest_start(0) {}
+  VrptwTimeWindowSegment(int duration, int time_warp, int earliest_start, int latest_start) : duration(duration), time_warp(time_warp), earliest_start(earliest_start), latest_start(latest_start) {}
+  /** Visit of a single customer */
+  static inline VrptwTimeWindowSegment visit(int ready_time, int due_date, int service_time) {return {service_time, 0, ready_time, due_date};}
+
+  /** Route start, vehicles leave the depot at time 0 */
+  static inline VrptwTimeWindowSegment routeStart() {return {0, 0, 0, 0};}
+  /** Return to the depot, its due date is not checked */
+  static inline VrptwTimeWindowSegment routeEnd() {return {0, 0, 0, std::numeric_limits<int>::max() / 4};}
+
+  /** This sequence followed by next, travel_time is the distance between the last and the first visit */
+  [[nodiscard]] inline VrptwTimeWindowSegment concatenate(const VrptwTimeWindowSegment &next, int travel_time) const {
+    const int delta = duration - time_warp + travel_time;
+    const int delta_wait = std::max(next.earliest_start - delta - latest_start, 0);
+    const int delta_warp = std::max(earliest_start + delta - next.latest_start, 0);
+    return {duration + next.duration + travel_time + delta_wait, time_warp + next.time_warp + delta_warp,
+            std::max(next.earliest_start - delta, earliest_start) - delta_wait,
+            std::min(next.latest_start - delta, latest_start) + delta_warp};
+  }
+  /** Time the sequence ends when started at the earliest start */
+  [[nodiscard]] inline int endTime() const {return earliest_start + duration - time_warp;}
+};
+
 struct VrptwIndividualCustomer{
   uint idx;
   uint travel_time_up_to;
   uint time_up_to;
   uint demand_up_to;
+  /** Time windows of the route from its start up to this customer and from this customer to its end */
+  VrptwTimeWindowSegment time_windows_up_to;
+  VrptwTimeWindowSegment time_windows_from;
 
-  VrptwIndividualCustomer() : idx(0), travel_time_up_to(0), time_up_to(0), demand_up_to(0) {}
-  explicit VrptwIndividualCustomer(uint idx) : idx(idx), travel_time_up_to(0), time_up_to(0), demand_up_to(0) {}
-  VrptwIndividualCustomer(uint idx, uint travel_time_up_to, uint time_up_to, uint demand_up_to) : idx(idx), travel_time_up_to(travel_time_up_to), time_up_to(time_up_to), demand_up_to(demand_up_to) {}
+  VrptwIndividualCustomer() : idx(0), travel_time_up_to(0), time_up_to(0), demand_up_to(0), time_windows_up_to(), time_windows_from() {}
+  explicit VrptwIndividualCustomer(uint idx) : idx(idx), travel_time_up_to(0), time_up_to(0), demand_up_to(0), time_windows_up_to(), time_windows_from() {}
+  VrptwIndividualCustomer(uint idx, uint travel_time_up_to, uint time_up_to, uint demand_up_to) : idx(idx), travel_time_up_to(travel_time_up_to), time_up_to(time_up_to), demand_up_to(demand_up_to), time_windows_up_to(), time_windows_from() {}
 };
 
 struct VrptwIndividualRoute{
@@ -29,6 +68,7 @@ struct VrptwIndividualRoute{
   uint demand;
   uint time;
   uint travel_time;
+  /** Time warp of the route, the vehicle continues from the due date of a customer it is late for */
   uint time_violation;
 
   VrptwIndividualRoute(): customers(), demand(0), time(0), travel_time(0), time_violation(0) {}
@@ -62,10 +102,11 @@ private:
   std::vector<double> violations_; //0 - demand, 1 - time
   bool is_evaluated_;
 
-  /** Returns a new route where remove segment in to_route is replaced by insert_segment from from_route */
-  VrptwIndividualRoute insertSegment(const VrptwIndividualRoute &to_route, const VrptwIndividualRoute &from_route, const VrptwRouteSegment &remove_segment, const VrptwRouteSegment &insert_segment);
-  /** Exchanges route on the given index with the new route and performs necessary changes to fitness and demand violation */
-  void exchange_route(const uint &route_idx, const VrptwIndividualRoute &new_route);
+  /** Replaces remove segment by the nodes in place, reusing the route's capacity, re-evaluates the changed part of the
+   * route and updates fitness, vehicles and violations */
+  void replaceSegment(const VrptwRouteSegment &remove_segment, const std::vector<uint> &nodes);
+  /** Each of the segments takes the place of the other one, the segments must be in different routes */
+  void swapSegments(const VrptwRouteSegment &segment1, const VrptwRouteSegment &segment2);
   /** Returns travel time of the segment (excluding time to move from/to segment) */
   uint getSegmentTravelTime(const VrptwRouteSegment &segment);
   /** Returns demand of the route segment*/
@@ -73,6 +114,14 @@ private:
   /** Returns the time it takes to complete the route after replacing remove segment by insert segment */
   uint getExchangeTravelTime(const VrptwRouteSegment &remove_segment, const VrptwRouteSegment &insert_segment);
 
+  /** Time windows of the segment's customers in the route order or reversed, O(segment length) */
+  VrptwTimeWindowSegment getSegmentTimeWindows(const VrptwRouteSegment &segment, bool reversed);
+  /** Time windows of the route after replacing remove segment by insert segment, O(1) when the insert segment is
+   * empty, a single customer or the end of both routes (cross move), otherwise O(insert segment length) */
+  VrptwTimeWindowSegment getExchangeTimeWindows(const VrptwRouteSegment &remove_segment, const VrptwRouteSegment &insert_segment);
+  /** Time windows of the route after reversing the segment, O(segment length) */
+  VrptwTimeWindowSegment get2optTimeWindows(const VrptwRouteSegment &segment);
+
   bool exchangeViolatesTimeConstraints(const VrptwRouteSegment &remove_segment, const VrptwRouteSegment &insert_segment);
   int exchangeTimeViolationChange(const VrptwRouteSegment &remove_segment, const VrptwRouteSegment &insert_segment);
 
@@ -82,13 +131,9 @@ private:
   bool testExchangeMoveNoViolation(const VrptwRouteSegment &segment1, const VrptwRouteSegment &segment2);
   bool testExchangeMoveViolation(const VrptwRouteSegment &segment1, const VrptwRouteSegment &segment2);
 
-  uint getArrivalTime(const VrptwIndividualRoute &route, const uint &customer_idx);
-  uint getEndTime(const VrptwIndividualRoute &route, const int &customer_idx);
-
-  // Pairs are end_time, time_violation_sum
-  std::pair<uint, uint> andvanceSegmentTimeViolation(const VrptwRouteSegment &segment, const uint &prev_customer, const std::pair<uint, uint> &prev_time_violation, bool terminate_on_match = false);
-
-  void evaluateRoute(uint route_idx);
+  /** Recomputes the route's times, demands and the time window data of its customers; only customers from first_idx
+   * on changed their prefix data and only customers before changed_end their suffix data */
+  void evaluateRoute(VrptwIndividualRoute &route, uint first_idx = 0, uint changed_end = std::numeric_limits<uint>::max());
   inline double& capacityViolation() {return violations_[0];}
   inline double& timeViolation() {return violations_[1];}
 
@@ -102,6 +147,10 @@ public:
   std::shared_ptr<Solution> convertSolution();
   void initialize() override;
   void smartInitialize() override;
+  /** Routes grown from a random customer by the customer reachable soonest (travel and waiting time) without
+   * violating its due date or the capacity, the last route takes the rest; checks should_terminate once per added
+   * customer and gives up with false and initialize() when it returns true */
+  bool nearestNeighborInitialize(const std::function<bool()> &should_terminate);
   void resetEvaluated() override;
   bool betterThan(const std::shared_ptr<Individual> &other) override;
   double getFitness() override;
@@ -138,5 +187,14 @@ public:
   FitnessDiff getExchangeMoveCost(const VrptwRouteSegment &segment1, const VrptwRouteSegment &segment2);
   FitnessDiff getRelocateMoveCost(const VrptwRouteSegment &segment_moved, const VrptwRouteSegment &target_pos);
   FitnessDiff getCrossMoveCost(const VrptwRouteSegment &segment1, const VrptwRouteSegment &segment2);
+  /** Removes the given route segment */
+  void performRemoval(const VrptwRouteSegment &segment);
+  /** Inserts the node before start idx of the target position, customers.size() for insertion at the end */
+  void performInsertion(const VrptwRouteSegment &target_pos, uint node);
+  FitnessDiff getRemovalCost(const VrptwRouteSegment &segment);
+  /** Constant time, the node's visit is put between the time windows of the route parts before and after it */
+  FitnessDiff getInsertionCost(const VrptwRouteSegment &target_pos, uint node);
+
   FitnessDiff getFitnessDiff(const VrptwIndividualStructured &other);
+  [[nodiscard]] inline uint getVehiclesUsed() const {return vehicles_used_;}
 };
\ No newline at end of file
@@ -4,19 +4,59 @@ class HeuristicPortfolio;
 
 #include "portfolio.h"
 #include "solution.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+
+/** Algorithms of the constructive heuristics building the starting solutions ("algorithm" of "construction") */
+enum ConstructionAlgorithm{
+  NEAREST_NEIGHBOR_CONSTRUCTION,
+  RANDOM_CONSTRUCTION
+};
 
 /** Parent class for heuristics, heuristics need to implement these functions*/
 class Heuristic {
+private:
+  std::atomic<bool> paused_{false};
+  std::mutex pause_lock_;
+  std::condition_variable pause_condition_;
+  /** Wall-clock seconds and units the heuristic may run for, 0 is unlimited */
+  double time_budget_ = 0;
+  unsigned long unit_budget_ = 0;
+
 public:
-  /** Takes a new best-so-far solution and asynchronosly adds it to the heuristic population for refinement */
+  /** Takes a new best-so-far solution and adds it to the heuristic population for refinement, called on the heuristic's
+   * own thread through HeuristicPortfolio::solutionPoll (solution listeners are called by the publishing thread) */
   virtual void acceptSolution(std::shared_ptr<Solution>) = 0;
   /** Prepare data for run of the heuristic */
   virtual void initialize(HeuristicPortfolio *portfolio) = 0;
-  /** Start the heuristic */
-  virtual void run() = 0;
+  /** Start the heuristic, by default runs its units until it finishes, is terminated or runs out of its budget,
+   * waiting between the units while it is paused */
+  virtual void run();
+  /** Prepares the run (starting solution, population) for runUnit, returns false if the heuristic doesn't run in units
+   * and needs run() */
+  virtual bool startUnits() {return false;}
+  /** Runs a bounded unit of work (an SA step, a generation, a neighborhood pass) on the calling thread, returns false
+   * when the heuristic finished or was terminated; consecutive units may run on different threads, never at once */
+  virtual bool runUnit() {return false;}
   /** Asynchronously set termination condition so that the heuristic exits after the current iteration */
   virtual void terminate() = 0;
+  /** Waits after terminate until the heuristic delivered its last output (Optal communication writes the final
+   * best-so-far solution), false if that didn't happen within the timeout */
+  virtual bool flush(std::chrono::milliseconds) {return true;}
+
+  /** Cooperative pause, the heuristic stops between two units until resumed (heuristics without units aren't paused) */
+  void pause();
+  void resume();
+  [[nodiscard]] inline bool isPaused() const {return paused_;}
+  /** Waits at most timeout while the heuristic is paused, returns true if it isn't paused */
+  bool waitWhilePaused(std::chrono::milliseconds timeout);
+  /** Limits the run to the wall-clock seconds and the number of units, 0 is unlimited */
+  void setBudget(double seconds, unsigned long units);
+  /** The run started at start and ran the units, true when it used up a budget */
+  [[nodiscard]] bool budgetExhausted(std::chrono::steady_clock::time_point start, unsigned long units) const;
 
   virtual ~Heuristic() = default;
 };
@@ -0,0 +1,64 @@
+#pragma once
+#include "common/routing_instance.h"
+#include "common/mapped_file.h"
+
+/** Versioned binary image of a loaded instance: header, nodes, coordinates, distance storage and candidate lists.
+ * The cache is tied to the source file by a checksum of its contents, the distance matrix of a cached instance
+ * is used directly from the memory-mapped cache file */
+class RoutingInstance::InstanceCache{
+private:
+  enum Section{
+    NAME,
+    COMMENT,
+    NODES,
+    DEPOTS,
+    COORD_X,
+    COORD_Y,
+    MATRIX,
+    COMPACT_MATRIX,
+    ROW_OFFSETS,
+    CANDIDATES,
+    CANDIDATE_DISTANCES,
+    SECTION_COUNT
+  };
+
+  struct Header{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t source_checksum;
+    int32_t problem_type;
+    int32_t edge_weight_type;
+    int32_t edge_weight_format;
+    int32_t display_data_type;
+    int32_t vehicle_capacity;
+    int32_t vehicle_count;
+    int32_t node_count;
+    int32_t distance_storage;
+    int32_t compact_distances;
+    uint32_t candidate_count;
+    uint64_t stride;
+    uint64_t section_bytes[SECTION_COUNT];
+  };
+
+  static constexpr uint64_t magic_ = 0x31484341434e5452; // "RTNCACH1" in little-endian
+  /** Increase with any change of the layout or of the meaning of the stored data */
+  static constexpr uint32_t version_ = 1;
+  static constexpr size_t alignment_ = 64;
+
+  static size_t alignedSize(size_t bytes);
+
+public:
+  /** Loaders of the source formats, part of the checksum */
+  static constexpr uint64_t tsplib_format = 1;
+  static constexpr uint64_t solomon_format = 2;
+
+  /** Cache file of the instance file in the cache directory */
+  static std::string cacheFilename(const char *filename);
+  /** Checksum of the source file contents and the source format */
+  static uint64_t checksum(const MappedFile &source, uint64_t source_format);
+  /** Loads the instance from cache_filename_ if it exists and matches source_checksum_, returns false otherwise */
+  static bool load(RoutingInstance &instance);
+  /** Writes the cache of the instance (atomically by renaming a temporary file), failures are only reported */
+  static void save(const RoutingInstance &instance);
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <chrono>
 #include <fstream>
+#include <string>
 #include "common/solution.h"
 
 class ObjectiveValueLogger{
@@ -15,5 +16,7 @@ public:
   ~ObjectiveValueLogger();
   void startClock();
   void log(const Solution &solution);
+  /** Appends lines starting with # (e.g. heuristic statistics), the solution lines stay parseable */
+  void logComment(const std::string &lines);
   void closeFile();
 };
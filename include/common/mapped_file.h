@@ -0,0 +1,37 @@
+#pragma once
+#include <string_view>
+#include <vector>
+
+/** Read-only memory-mapped input file with a cursor for hand-rolled parsing of the instance files,
+ * numbers are parsed in place by std::from_chars */
+class MappedFile{
+private:
+  const char *data_;
+  size_t size_;
+  const char *pos_;
+  const char *end_;
+  /** Contents of the file when it cannot be mapped (e.g. a pipe) */
+  std::vector<char> buffer_;
+  bool is_mapped_;
+  bool is_open_;
+
+  void skipSpaces();
+
+public:
+  explicit MappedFile(const char *filename);
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  [[nodiscard]] inline bool isOpen() const {return is_open_;}
+  [[nodiscard]] inline const char *data() const {return data_;}
+  [[nodiscard]] inline size_t size() const {return size_;}
+  /** Returns the next line without the line break, false at the end of the file */
+  bool nextLine(std::string_view &line);
+  /** Skips the rest of the current line */
+  void skipLine();
+  /** Skip whitespace (including line breaks) and parse a number, false if there is no number */
+  bool nextInt(int &value);
+  bool nextUInt(unsigned int &value);
+  bool nextDouble(double &value);
+};
@@ -1,9 +1,13 @@
 #pragma once
 #include "heuristic.h"
 #include "serializer.h"
+#include "shared_memory_channel.h"
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
 
+/** Communication with Optal over stdin/stdout or a shared memory channel, solutions are written by a separate
+ * writer thread so that the heuristics publishing them never wait for serialization or pipe I/O */
 class OptalComms: public Heuristic{
 private:
   HeuristicPortfolio *portfolio_;
@@ -11,13 +15,38 @@ private:
   std::shared_ptr<Solution> best_solution_;
   std::shared_ptr<SolutionSerializer> serializer_;
   std::mutex solution_lock_;
+  /** Shared memory channel used instead of stdin/stdout when its name is set */
+  std::unique_ptr<SharedMemoryChannel> channel_;
+  static std::string channel_name_;
+
+  /** Single-slot mailbox of the writer thread, a newer solution replaces the one not written yet */
+  std::shared_ptr<Solution> pending_solution_;
+  std::condition_variable pending_condition_;
+  /** The writer thread wrote and flushed the last pending solution after termination */
+  bool written_all_;
+  std::condition_variable written_condition_;
+
+  /** Solutions written to stdout */
+  std::atomic<unsigned long> written_count_;
+  /** Solutions replaced in the mailbox before the writer thread got to them */
+  std::atomic<unsigned long> coalesced_count_;
+  /** Infeasible solutions and solutions not better than the last accepted one */
+  std::atomic<unsigned long> dropped_count_;
 
   void sendSolution(const std::shared_ptr<Solution>& solution);
+  /** Reads the next solution from Optal, returns false when Optal closed the communication */
+  bool readSolution(std::shared_ptr<Solution> &solution);
+  /** Writer thread loop, writes the pending solutions until termination and flushes whenever the mailbox is empty */
+  void writeSolutions();
 
 public:
   explicit OptalComms(const std::shared_ptr<SolutionSerializer> &serializer);
+  /** Selects the shared memory channel of the given name instead of stdin/stdout for all the communication */
+  static void setSharedMemoryChannel(const std::string &name);
   void initialize(HeuristicPortfolio *portfolio) override;
   void run() override;
   void acceptSolution(std::shared_ptr<Solution> solution) override;
   void terminate() override;
+  /** Waits until the writer thread wrote the final best-so-far solution, the reader may still be blocked on stdin */
+  bool flush(std::chrono::milliseconds timeout) override;
 };
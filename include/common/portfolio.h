@@ -3,10 +3,21 @@
 class Heuristic;
 
 #include "heuristic.h"
+#include "json.hpp"
 #include "logger.h"
+#include "portfolio_bandit.h"
+#include "routing_instance.h"
 #include "solution.h"
+#include "task_pool.h"
+#include "thread_scheduling.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class HeuristicPortfolio{
@@ -17,26 +28,110 @@ private:
   /** Used constructive heuristics ran once in the beggining of calculation*/
   std::vector<std::shared_ptr<Heuristic>> constructive_heuristics_;
 
+  /** Improving heuristics which get every new best-so-far solution pushed instead of polling for it */
+  std::vector<std::shared_ptr<Heuristic>> solution_listeners_;
+
+  /** Private instance copies of the heuristics, their distances are replicated on the heuristic's thread before
+   * its initialization */
+  std::unordered_map<const Heuristic *, std::shared_ptr<RoutingInstance>> instance_replicas_;
+
+  /** Config names of the heuristics and their arms in the bandit collecting the statistics */
+  std::unordered_map<const Heuristic *, std::string> heuristic_names_;
+  std::unordered_map<const Heuristic *, size_t> heuristic_arms_;
+  std::unique_ptr<PortfolioBandit> bandit_;
+
+  /** Wall-clock seconds from start after which the portfolio terminates itself, 0 is unlimited */
+  double time_limit_;
+  /** All heuristics returned, the deadline thread exits */
+  bool finished_;
+
+  std::shared_ptr<ThreadScheduling> scheduling_;
+  /** Heuristic threads running at once, limited by ThreadScheduling::getMaxThreads */
+  unsigned int running_threads_;
+  bool terminated_;
+  std::mutex thread_lock_;
+  std::condition_variable thread_condition_;
+  /** Workers running the heuristics in units when the scheduling config sets workers, nullptr otherwise */
+  std::unique_ptr<TaskPool> task_pool_;
+
   std::shared_ptr<ObjectiveValueLogger> logger_;
+  std::shared_ptr<Solution> logged_solution_;
+  std::mutex log_lock_;
+
+  /** Solutions built by the constructive heuristics, handed out to the improving heuristics in turn */
+  std::vector<std::shared_ptr<Solution>> starting_solutions_;
+  size_t next_starting_solution_;
+  /** Constructive heuristics whose run hasn't finished yet */
+  unsigned int running_constructions_;
+  std::mutex starting_solution_lock_;
+  std::condition_variable starting_solution_condition_;
 
-  /** Current best-so-far solution */
+  /** Current best-so-far solution, replaced only by atomic compare-exchange */
   std::shared_ptr<Solution> best_solution_;
-  std::mutex solution_lock_;
+  /** Incremented after every replacement of the best-so-far solution, polled by the heuristics */
+  std::atomic<unsigned long> solution_epoch_;
+
+  /** Sends the solution to the solution listeners (stdout) and to the log */
+  void sendSolution(const std::shared_ptr<Solution>& solution);
 
-  /** Sends current best-so-far solution to stdout and to the improving heuristics */
-  void sendSolution();
+  /** Sets the name and the run budget ("budget": {"seconds", "units"}) of the heuristic from its config */
+  void configureHeuristic(const std::shared_ptr<Heuristic> &heuristic, const nlohmann::json &config);
+  bool isListener(const std::shared_ptr<Heuristic> &heuristic) const;
 
   void initializeThreads();
   void runThreads();
+  /** Runs the listeners on threads of their own, the futures give their CPU seconds once they return */
+  std::vector<std::future<double>> startListeners();
+  /** Terminates the listeners after the heuristics have finished and waits until they delivered the final
+   * best-so-far solution; a listener blocked in reading its input is left running */
+  void stopListeners(std::vector<std::future<double>> &listeners);
+  /** Terminates the portfolio when the time limit passes before the heuristics finish */
+  void watchDeadline(std::chrono::steady_clock::time_point deadline);
+  /** Runs the task of every heuristic on its own thread placed by the scheduling config, at most max_threads
+   * of them at once, in the order constructive heuristics first; solution listeners run separately */
+  void runHeuristicThreads(const std::function<void(Heuristic &)> &task, bool replicate_distances);
+  /** Runs the heuristics in units on the task pool, constructive heuristics first */
+  void runHeuristicTasks();
+  /** Task running units of the heuristic for a time slice at a time until it finishes or uses up its budget,
+   * a paused heuristic keeps its task idle */
+  TaskPool::Task heuristicTask(const std::shared_ptr<Heuristic> &heuristic);
+  /** Adds the thread's CPU time since cpu_start to the heuristic's statistics */
+  void addCpuTime(const Heuristic &heuristic, double cpu_start, unsigned long units, bool slice);
+  /** Counts down the running constructions when the finished heuristic is constructive */
+  void finishHeuristic(const Heuristic &heuristic);
 
 public:
   HeuristicPortfolio();
-  void addImprovingHeuristic(const std::shared_ptr<Heuristic>& heuristic);
-  void addConstructiveHeuristic(const std::shared_ptr<Heuristic>& heuristic);
+  /** instance_replica is the heuristic's private copy of the instance when distances are replicated, config is
+   * the heuristic's config: its type labels the heuristic in the statistics, its budget limits the run */
+  void addImprovingHeuristic(const std::shared_ptr<Heuristic>& heuristic,
+                             const std::shared_ptr<RoutingInstance>& instance_replica = nullptr,
+                             const nlohmann::json &config = nlohmann::json::object());
+  void addConstructiveHeuristic(const std::shared_ptr<Heuristic>& heuristic,
+                                const std::shared_ptr<RoutingInstance>& instance_replica = nullptr,
+                                const nlohmann::json &config = nlohmann::json::object());
+  /** Adds an improving heuristic whose acceptSolution is called by the thread publishing a new best-so-far solution,
+   * it keeps running until the other heuristics finish and then delivers the final best-so-far solution */
+  void addSolutionListener(const std::shared_ptr<Heuristic>& heuristic, const nlohmann::json &config = nlohmann::json::object());
   void setLogger(const std::shared_ptr<ObjectiveValueLogger> &logger);
+  void setScheduling(const std::shared_ptr<ThreadScheduling> &scheduling);
+  /** Hard wall-clock limit of start in seconds, 0 is unlimited (Optal normally terminates the run by closing stdin) */
+  void setTimeLimit(double seconds);
   void start();
+  /** Terminates the heuristics (resuming the paused ones), the listeners are stopped once the heuristics return */
   void terminate();
 
-  /** Receives new solution, checks if it is BSF solution and sends it out if it is */
+  /** Receives new solution, checks if it is BSF solution and publishes it if it is, never waits for the other heuristics;
+   * the improvement is credited to the heuristic running on the calling thread */
   void acceptSolution(const std::shared_ptr<Solution>& solution);
+  /** Adds a solution built by a constructive heuristic to the starting solutions and publishes it */
+  void addStartingSolution(const std::shared_ptr<Solution>& solution);
+  /** Returns up to count different starting solutions for an improving heuristic, waits until the constructive
+   * heuristics finish; empty without constructive heuristics, the heuristic then builds its own starting point */
+  std::vector<std::shared_ptr<Solution>> takeStartingSolutions(size_t count);
+  /** Single starting solution, nullptr if there is none */
+  std::shared_ptr<Solution> takeStartingSolution();
+  /** Returns a function for the heuristic's own thread which passes the best-so-far solution to its acceptSolution
+   * when it changed since the previous call, otherwise it costs a single atomic load */
+  std::function<void()> solutionPoll(Heuristic *heuristic);
 };
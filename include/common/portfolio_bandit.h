@@ -0,0 +1,53 @@
+#pragma once
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** Credit assignment of the portfolio: every heuristic is an arm earning the relative improvements of the best-so-far
+ * solution it found, the CPU time of the arms running in slices is shared by a discounted UCB policy over the
+ * improvement per CPU second, so that stalled heuristics are throttled to short probing slices */
+class PortfolioBandit{
+private:
+  struct Arm{
+    std::string name;
+    /** Arm takes part in the slice allocation (a heuristic running in units, not finished yet) */
+    bool active = false;
+    double cpu_seconds = 0;
+    unsigned long units = 0;
+    unsigned long slices = 0;
+    unsigned long improvements = 0;
+    double credit = 0;
+    /** Credit earned since the last slice end, solutions may be published while the heuristic isn't running */
+    double pending_credit = 0;
+    double discounted_credit = 0;
+    double discounted_seconds = 0;
+    double discounted_slices = 0;
+    double share = 0;
+  };
+
+  std::vector<Arm> arms_;
+  bool adaptive_;
+  double exploration_;
+  double discount_;
+  std::mutex lock_;
+
+  /** Recomputes the shares of the active arms */
+  void allocate();
+
+public:
+  /** Without adaptive allocation the statistics are collected and every active arm keeps the same share */
+  PortfolioBandit(bool adaptive, double exploration, double discount);
+  size_t addArm(const std::string &name);
+  void activate(size_t arm);
+  /** The heuristic finished, its share goes to the others */
+  void deactivate(size_t arm);
+  /** Improvement of the best-so-far solution found by the arm, relative to the previous best */
+  void addImprovement(size_t arm, double improvement);
+  /** Adds CPU time of the arm, a finished slice updates its discounted reward rate and the allocation */
+  void addCpuTime(size_t arm, double cpu_seconds, unsigned long units, bool slice);
+  /** Length of the arm's next slice relative to the configured slice, share times the number of active arms */
+  double sliceScale(size_t arm);
+  /** One commented line per arm: index, name, CPU seconds and their share, units, slices, improvements and credit */
+  void writeStatistics(std::ostream &stream);
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include "common/routing_instance.h"
+#include <vector>
+
+/** Polar sectors of the routes around the depot for pruning of the inter-route neighborhoods: route pairs whose
+ * sectors don't overlap (routes on opposite sides of the depot) are skipped, the same filter as the route pairs of
+ * SWAP* in HGS. Angles are in 1/65536 of the full circle, a sector runs counterclockwise from its start to its end */
+class RouteSectors{
+private:
+  static constexpr int full_circle = 65536;
+  /** Polar angle of each node, empty when the pruning is disabled */
+  std::vector<int> angles_;
+  std::vector<int> starts_;
+  std::vector<int> ends_;
+  std::vector<bool> empty_;
+  /** Added to both sides of the sectors before the overlap test */
+  int tolerance_;
+
+  static inline int positiveMod(int angle) {return (angle % full_circle + full_circle) % full_circle;}
+  void extend(uint route, int angle);
+
+public:
+  RouteSectors();
+  /** Enables the pruning with the tolerance in degrees, stays disabled for instances without coordinates */
+  void initialize(const RoutingInstance &instance, double tolerance_degrees);
+  [[nodiscard]] inline bool isEnabled() const {return !angles_.empty();}
+  /** Recomputes the sector of the route from its customers (anything with an idx member) */
+  template<class Customers>
+  void update(uint route, const Customers &customers) {
+    if(!isEnabled())
+      return;
+    if(route >= empty_.size()){
+      starts_.resize(route + 1, 0);
+      ends_.resize(route + 1, 0);
+      empty_.resize(route + 1, true);
+    }
+    empty_[route] = true;
+    for(const auto &customer : customers)
+      extend(route, angles_[customer.idx]);
+  }
+  /** False if the routes can be skipped, empty routes overlap with every route */
+  [[nodiscard]] bool overlap(uint route1, uint route2) const;
+};
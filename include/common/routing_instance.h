@@ -1,6 +1,9 @@
 #pragma once
+#include <cstdint>
+#include <cstddef>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
 
 enum ProblemType{
@@ -22,6 +25,13 @@ enum EdgeWeightFormat{
   FULL_MATRIX
 };
 
+/** Layout of the distances, selected by RoutingInstance according to the instance size */
+enum DistanceStorage{
+  FULL_MATRIX_STORAGE, // node_count x node_count matrix
+  TRIANGULAR_STORAGE, // upper triangle with diagonal of a symmetric matrix
+  COORDINATE_STORAGE // no matrix, distances are computed from the node coordinates
+};
+
 enum DisplayDataType{
   COORD_DISPLAY,
   TWOD_DISPLAY,
@@ -55,6 +65,11 @@ struct Node{
 class RoutingInstance {
 private:
   std::vector<Node> nodes_;
+  /** Node attributes (structure of arrays) read by the demand and time window loops, filled from nodes_ */
+  std::vector<uint> demands_;
+  std::vector<int> ready_times_;
+  std::vector<int> due_dates_;
+  std::vector<int> service_times_;
   std::vector<uint> depots_;
   std::string instance_name_;
   std::string comment_;
@@ -65,24 +80,105 @@ private:
   int vehicle_capacity_;
   int vehicle_count_;
   int node_count_;
-  std::shared_ptr<unsigned int[]> matrix_;
+  DistanceStorage distance_storage_;
+  /** Matrix elements are stored in 16 bits, all distances fit into uint16_t */
+  bool compact_distances_;
+  /** Full 32-bit matrix with depot alias rows and columns appended (row length stride_), nullptr in other storages */
+  const uint *distance_rows_;
+  size_t stride_;
+  std::shared_ptr<uint[]> matrix_;
+  std::shared_ptr<uint16_t[]> compact_matrix_;
+  /** Number of elements of the matrix (either matrix_ or compact_matrix_) */
+  size_t matrix_size_;
+  /** EDGE_WEIGHT_SECTION as loaded, source of the explicit distances until the storage is built */
+  std::vector<uint> explicit_matrix_;
+  /** Triangular storage, distance (i, j) for i <= j is at row_offsets_[i] + j */
+  std::vector<size_t> row_offsets_;
+  /** Node coordinates (structure of arrays), geographical instances keep latitude and longitude in radians */
+  std::vector<double> coord_x_;
+  std::vector<double> coord_y_;
+  /** Flat node_count_ x candidate_count_ array of nearest neighbors of each node, sorted by distance */
+  std::vector<uint> candidates_;
+  /** Distances to the candidates, saves distance computations in the coordinate storage */
+  std::vector<uint> candidate_distances_;
+  uint candidate_count_;
+  /** Binary cache of this instance, empty when caching is disabled */
+  std::string cache_filename_;
+  uint64_t source_checksum_;
+  static std::string cache_directory_;
 
   class TSPlibLoader;
   class SolomonLoader;
+  class InstanceCache;
 
+  /** Vehicle count given by the name of the A-n<nodes>-k<vehicles>.vrp instances, 0 for other files */
+  static int parseVehicleCount(std::string_view filename);
+  /** Distance computed from the coordinates by the edge weight function */
+  [[nodiscard]] uint computeDistance(uint from, uint to) const;
+  /** Distance in the storages other than the padded full matrix */
+  [[nodiscard]] uint getStoredDistance(uint from, uint to) const;
+  /** Fills the node attribute arrays from the loaded nodes */
+  void buildNodeAttributes();
+  /** Selects the distance storage by the node count and the largest distance and fills it from the coordinates
+   * (or from the loaded explicit matrix) */
+  void buildDistances();
+  /** Distances from the node to nodes first..last-1 written to row[first..last-1] */
+  void computeDistanceRow(uint from, size_t first, size_t last, uint *row) const;
+  /** Fills blocks part, part + part_count, ... of rows of the matrix, called from parallel threads */
+  void fillDistanceRows(size_t part, size_t part_count);
+  [[nodiscard]] uint getMaxDistance() const;
+  [[nodiscard]] bool isSymmetric() const;
+  /** Nearest neighbors of all nodes by a uniform grid, avoids the quadratic scan in the coordinate storage */
+  void buildGridCandidateLists(uint candidate_count);
+  /** Nearest neighbors of all nodes by scanning all distances */
+  void buildScannedCandidateLists(uint candidate_count);
 
 public:
   RoutingInstance();
 
   void loadTSPlibInstance(const char *filename);
   void loadSolomonInstance(const char *filename);
+  /** Enables the binary instance cache: loaded instances (with the distances and candidate lists) are stored
+   * in the directory and memory-mapped by later runs instead of parsing the source file again */
+  static void setCacheDirectory(const std::string &directory);
 
+  [[nodiscard]] inline ProblemType getProblemType() const {return problem_type_;}
   [[nodiscard]] inline const std::vector<Node> &getNodes() const { return nodes_;}
   [[nodiscard]] inline const int &getNodesCount() const { return node_count_;}
-  [[nodiscard]] inline std::shared_ptr<unsigned int []> getMatrix() const {return matrix_;}
+  /** Demands, ready times, due dates and service times of the nodes indexed by the node */
+  [[nodiscard]] inline const uint *getDemands() const {return demands_.data();}
+  [[nodiscard]] inline const int *getReadyTimes() const {return ready_times_.data();}
+  [[nodiscard]] inline const int *getDueDates() const {return due_dates_.data();}
+  [[nodiscard]] inline const int *getServiceTimes() const {return service_times_.data();}
+  /** Node coordinates indexed by the node, nullptr for instances given only by an explicit matrix */
+  [[nodiscard]] inline const double *getCoordinatesX() const {return coord_x_.size() == (size_t)node_count_ ? coord_x_.data() : nullptr;}
+  [[nodiscard]] inline const double *getCoordinatesY() const {return coord_y_.size() == (size_t)node_count_ ? coord_y_.data() : nullptr;}
+  [[nodiscard]] inline DistanceStorage getDistanceStorage() const {return distance_storage_;}
   [[nodiscard]] inline const std::string &getInstanceName() const {return instance_name_;}
   [[nodiscard]] inline const int &getVehicleCapacity() const {return vehicle_capacity_;}
   [[nodiscard]] inline const int &getVehicleCount() const{ return vehicle_count_;}
-  [[nodiscard]] uint getDistance(uint from, uint to) const;
+  /** Distance between nodes, indices getNodesCount() .. getNodesCount() + getVehicleCount() - 1 are depot aliases */
+  [[nodiscard]] inline uint getDistance(uint from, uint to) const {
+    if(distance_rows_ != nullptr) [[likely]]
+      return distance_rows_[from * stride_ + to];
+    return getStoredDistance(from, to);
+  }
+  /** Distances from the node indexed by the target node (including depot aliases), hoists the row out of loops;
+   * nullptr unless the full 32-bit matrix is stored */
+  [[nodiscard]] inline const uint *getDistanceRow(uint from) const {
+    return distance_rows_ == nullptr ? nullptr : distance_rows_ + from * stride_;
+  }
+
+  /** Builds the k-nearest-neighbor candidate lists of all nodes (granular neighborhoods) */
+  void buildCandidateLists(uint candidate_count);
+  [[nodiscard]] inline uint getCandidateCount() const {return candidate_count_;}
+  /** Returns pointer to getCandidateCount() nearest nodes of the given node */
+  [[nodiscard]] inline const uint *getCandidates(uint node) const {return &candidates_[(size_t)node * candidate_count_];}
+  /** Returns pointer to distances of the node to its candidates (same order as getCandidates) */
+  [[nodiscard]] inline const uint *getCandidateDistances(uint node) const {return &candidate_distances_[(size_t)node * candidate_count_];}
+
+  /** Replaces the distances, node attributes and candidate lists shared with the copies of this instance by private copies
+   * allocated by the calling thread, so that they end up on the NUMA node the thread is bound to */
+  void replicateDistances();
 
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include "common/routing_instance.h"
+#include "heuristic_framework/ruin_recreate_operators.h"
+
+/** Ruin and recreate operators of the structured route individuals (CVRP and VRP-TW), which share the route layout and
+ * the segment operations; the problems define only the cost of their individuals */
+template<class IndividualType>
+class RoutingRuinRecreateOperators : public RuinRecreateOperators{
+protected:
+  const RoutingInstance *instance_;
+  double vehicle_cost_;
+  double violation_cost_;
+
+public:
+  RoutingRuinRecreateOperators(const RoutingInstance *instance, double vehicle_cost, double violation_cost) :
+    instance_(instance), vehicle_cost_(vehicle_cost), violation_cost_(violation_cost) {}
+
+  uint getNodesCount() override {return instance_->getNodesCount();}
+  const uint *getCandidates(uint node) override {return instance_->getCandidates(node);}
+  uint getCandidateCount() override {return instance_->getCandidateCount();}
+  uint getDemand(uint node) override {return instance_->getDemands()[node];}
+  uint getDepotDistance(uint node) override {return instance_->getDistance(0, node);}
+
+  uint getRouteCount(Individual &individual) override {
+    return static_cast<IndividualType &>(individual).getRoutes().size();
+  }
+  uint getRouteSize(Individual &individual, uint route_idx) override {
+    return static_cast<IndividualType &>(individual).getRoutes()[route_idx].customers.size();
+  }
+  uint getCustomer(Individual &individual, uint route_idx, uint customer_idx) override {
+    return static_cast<IndividualType &>(individual).getRoutes()[route_idx].customers[customer_idx].idx;
+  }
+  bool exceedsCapacity(Individual &individual, uint route_idx, uint node) override {
+    return static_cast<IndividualType &>(individual).getRoutes()[route_idx].demand + instance_->getDemands()[node] >
+           (uint)instance_->getVehicleCapacity();
+  }
+  FitnessDiff getRemovalCost(Individual &individual, uint route_idx, uint customer_idx) override {
+    return static_cast<IndividualType &>(individual).getRemovalCost({route_idx, customer_idx, 1});
+  }
+  FitnessDiff getInsertionCost(Individual &individual, uint route_idx, uint position, uint node) override {
+    return static_cast<IndividualType &>(individual).getInsertionCost({route_idx, position, 0}, node);
+  }
+  void performRemoval(Individual &individual, uint route_idx, uint start_idx, uint length) override {
+    static_cast<IndividualType &>(individual).performRemoval({route_idx, start_idx, length});
+  }
+  void performInsertion(Individual &individual, uint route_idx, uint position, uint node) override {
+    static_cast<IndividualType &>(individual).performInsertion({route_idx, position, 0}, node);
+  }
+};
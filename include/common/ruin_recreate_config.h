@@ -0,0 +1,32 @@
+#pragma once
+#include "common/routing_instance.h"
+#include "heuristic_framework/ruin_recreate.h"
+#include "nlohmann/json.hpp"
+#include <vector>
+
+/** Parameters of a CVRP / VRP-TW "ruin_recreate" heuristic config:
+ *  "removals": removal methods chosen at random in every iteration, any of "string", "random", "related" and
+ *  "worst" (default all),
+ *  "average_removed": average number of removed customers (default 10),
+ *  "max_string_length": longest removed string (default 10),
+ *  "split_rate": probability a string is split around a kept substring (default 0.5),
+ *  "split_depth": probability the kept substring stops growing (default 0.01),
+ *  "blink_rate": probability an insertion position is skipped in the recreate step (default 0.01),
+ *  "acceptance": "simulated_annealing" (default) or "record_to_record",
+ *  "initial_temperature", "final_temperature": annealing temperatures, by default derived from the average edge length,
+ *  "cooling_time": seconds the temperature takes to decrease to the final one (default 60), counting only the time
+ *  spent in the units of the heuristic, not the time the portfolio runs other heuristics or pauses this one,
+ *  "deviation": relative deviation from the best solution accepted by record-to-record travel (default 0.01),
+ *  "iterations_per_unit": ruin and recreate iterations in a unit of the heuristic (default 100),
+ *  "candidates": nearest customers searched by string and related removals (default 30). */
+class RuinRecreateConfig{
+private:
+  RuinRecreateParameters parameters_;
+
+public:
+  /** Exits with code 101 on an unknown removal or acceptance and with code 100 when the config is malformed */
+  RuinRecreateConfig(const nlohmann::json &config, const RoutingInstance &instance);
+
+  /** Vehicle and violation costs are equivalent to the punishments of the simulated annealing */
+  [[nodiscard]] inline const RuinRecreateParameters &getParameters() const {return parameters_;}
+};
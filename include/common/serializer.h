@@ -1,17 +1,50 @@
 #pragma once
+#include <istream>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include "nlohmann/json.hpp"
+#include "routing_instance.h"
 #include "solution.h"
 
+/** Converts solutions to and from the messages exchanged with Optal, either JSON lines or binary frames.
+ * A binary frame is a 4-byte little-endian payload length followed by the payload of LEB128 varints:
+ * zigzag-encoded objective, route count and for each route its customer count and customer indices.
+ * Depots and all the times are left out, they are recomputed from the instance when a frame is read. */
 class SolutionSerializer{
 private:
+  std::shared_ptr<RoutingInstance> instance_;
+  static bool binary_protocol_;
+
   nlohmann::json serializeNode(const SolutionNode &node);
-  nlohmann::json serializeRoute(const SolutionRoute &route);
+  nlohmann::json serializeRoute(const Solution &solution, const SolutionRoute &route);
 
   SolutionNode parseNode(const nlohmann::json &node_json);
-  SolutionRoute parseRoute(const nlohmann::json &route_json);
+  /** Appends the route and its nodes to the solution */
+  void parseRoute(const nlohmann::json &route_json, Solution &solution);
+
+  static void writeVarint(std::string &buffer, uint64_t value);
+  static bool readVarint(const char *&position, const char *end, uint64_t &value);
+  /** Appends a route visiting the customers to the solution, with the node times, demand and travel time */
+  void buildRoute(Solution &solution, const std::vector<int> &customers);
 
 public:
+  explicit SolutionSerializer(const std::shared_ptr<RoutingInstance> &instance);
+  /** Selects binary frames instead of JSON lines for all the serializers */
+  static void setBinaryProtocol(bool binary_protocol);
+
   std::string serializeSolution(std::shared_ptr<Solution> &solution);
   std::shared_ptr<Solution> parseSolution(std::string solution_string);
+  /** Upper bound of the binary frame payload size of a solution of the instance */
+  [[nodiscard]] size_t maxPayloadSize() const;
+  /** Binary frame payload of the solution */
+  std::string encodeSolution(const Solution &solution);
+  /** Solution from a binary frame payload, nullptr if the payload is invalid */
+  std::shared_ptr<Solution> decodeSolution(std::string_view payload);
+
+  /** Reads the next message, returns false when the input is closed (or a frame is corrupted),
+   * solution is nullptr if the message couldn't be parsed */
+  bool readSolution(std::istream &input, std::shared_ptr<Solution> &solution);
+  /** Writes the solution as a message without flushing the output */
+  void writeSolution(std::ostream &output, std::shared_ptr<Solution> &solution);
 };
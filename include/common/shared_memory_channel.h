@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/** Solution exchange with Optal through a POSIX shared memory segment instead of the stdio pipes.
+ * The segment holds a header and two single-slot mailboxes (to and from the solver), each protected by a seqlock
+ * whose sequence number is also the futex word for wakeups. Slots carry binary frame payloads of SolutionSerializer,
+ * a newer solution overwrites an older one which was not read yet.
+ *
+ * Layout (little-endian): 64-byte header {uint64 magic, uint32 version, uint32 capacity, uint32 closed}, then two
+ * slots of 64-byte {uint32 sequence, uint32 size} followed by capacity bytes of payload rounded up to 64 bytes. */
+class SharedMemoryChannel{
+private:
+  struct Header{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    std::atomic<uint32_t> closed;
+  };
+  struct Slot{
+    /** Odd while the slot is being written */
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> size;
+  };
+  enum SlotIndex{
+    TO_SOLVER_SLOT = 0,
+    FROM_SOLVER_SLOT = 1
+  };
+
+  static constexpr uint64_t magic_ = 0x4d48534f50544e52; // "RNTPOSHM"
+  static constexpr uint32_t version_ = 1;
+  static constexpr size_t alignment_ = 64;
+
+  std::string name_;
+  char *data_;
+  size_t size_;
+  uint32_t capacity_;
+  size_t slot_stride_;
+  uint32_t sent_sequence_;
+  uint32_t received_sequence_;
+
+  [[nodiscard]] Header *header() const;
+  [[nodiscard]] Slot *slot(SlotIndex index) const;
+  [[nodiscard]] char *payload(SlotIndex index) const;
+
+public:
+  /** Creates the segment /name with room for payloads of up to capacity bytes */
+  SharedMemoryChannel(const std::string &name, uint32_t capacity);
+  ~SharedMemoryChannel();
+  SharedMemoryChannel(const SharedMemoryChannel &) = delete;
+  SharedMemoryChannel &operator=(const SharedMemoryChannel &) = delete;
+
+  [[nodiscard]] inline bool isOpen() const {return data_ != nullptr;}
+  /** Publishes the payload to the solver, never blocks */
+  void send(std::string_view payload);
+  /** Waits up to timeout_ms for a payload from the solver, payload is left empty if there is none.
+   * Returns false when the solver closed the channel */
+  bool receive(std::string &payload, int timeout_ms);
+};
@@ -1,13 +1,13 @@
 #pragma once
 #include "common/routing_instance.h"
+#include "common/mapped_file.h"
 
 class RoutingInstance::SolomonLoader{
 private:
   static void error();
-  inline static uint dist(const std::pair<int, int> &n1, const std::pair<int, int> &n2);
-  static void buildTransitionMatrix(RoutingInstance &instance, const std::vector<std::pair<int, int>> &node_poses);
+  static void storeCoordinates(RoutingInstance &instance, const std::vector<std::pair<int, int>> &node_poses);
 public:
-  static void loadHeader(RoutingInstance &instance, std::ifstream &file);
-  static void loadNodes(RoutingInstance &instance, std::ifstream &file);
+  static void loadHeader(RoutingInstance &instance, MappedFile &file);
+  static void loadNodes(RoutingInstance &instance, MappedFile &file);
 
 };
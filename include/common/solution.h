@@ -1,5 +1,6 @@
 #pragma once
-#include <list>
+#include <cstddef>
+#include <vector>
 
 struct SolutionNode{
   int idx = -1;
@@ -14,22 +15,73 @@ struct SolutionNode{
   }
 };
 
+/** Route of a solution, its nodes (depots included) are the range [first_node, first_node + node_count) of Solution::nodes */
 struct SolutionRoute{
-  std::list<SolutionNode> route_nodes;
+  size_t first_node = 0;
+  size_t node_count = 0;
   int travel_time = -1;
   int demand = -1;
   int end_time = -1;
 
 };
 
+/** Contiguous read-only range of the nodes of one route */
+class SolutionNodeRange{
+private:
+  const SolutionNode *begin_;
+  const SolutionNode *end_;
+
+public:
+  SolutionNodeRange(const SolutionNode *begin, const SolutionNode *end) : begin_(begin), end_(end) {}
+  [[nodiscard]] inline const SolutionNode *begin() const {return begin_;}
+  [[nodiscard]] inline const SolutionNode *end() const {return end_;}
+  [[nodiscard]] inline size_t size() const {return end_ - begin_;}
+  [[nodiscard]] inline const SolutionNode &front() const {return *begin_;}
+  [[nodiscard]] inline const SolutionNode &back() const {return *(end_ - 1);}
+  [[nodiscard]] inline const SolutionNode &operator[](size_t i) const {return begin_[i];}
+};
+
+/** Flat solution: the nodes of all routes are stored one route after another in a single array,
+ * routes only keep their offsets, so a solution reserved up front is built without per-node allocations */
 struct Solution {
-  std::list<SolutionRoute> routes;
+  std::vector<SolutionNode> nodes;
+  std::vector<SolutionRoute> routes;
   int used_vehicles = 0;
   int travel_time_sum = -1;
   int end_time_sum = -1;
   int objective = -1;
   bool feasible = true;
 
+  /** Reserves space for the whole solution, route_count routes with node_count nodes in total */
+  inline void reserve(size_t route_count, size_t node_count){
+    routes.reserve(route_count);
+    nodes.reserve(node_count);
+  }
+
+  /** Starts a new route at the end of the solution, nodes added by addNode belong to it */
+  inline SolutionRoute &addRoute(){
+    routes.emplace_back();
+    routes.back().first_node = nodes.size();
+    routes.back().node_count = 0;
+    return routes.back();
+  }
+
+  /** Appends a node to the last route */
+  inline SolutionNode &addNode(int idx, int start_time, int end_time){
+    nodes.emplace_back(idx, start_time, end_time);
+    routes.back().node_count++;
+    return nodes.back();
+  }
+
+  inline SolutionNode &addNode(const SolutionNode &node){
+    return addNode(node.idx, node.start_time, node.end_time);
+  }
+
+  [[nodiscard]] inline SolutionNodeRange routeNodes(const SolutionRoute &route) const{
+    const SolutionNode *first = nodes.data() + route.first_node;
+    return {first, first + route.node_count};
+  }
+
   [[nodiscard]] bool betterThan(const Solution &other) const{
     if(!feasible && other.feasible)
       return false;
@@ -41,4 +93,4 @@ struct Solution {
       return true;
     return objective < other.objective;
   }
-};
\ No newline at end of file
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Fixed set of worker threads running tasks from per-worker deques; a worker takes tasks from the front of its own
+ * deque and puts rescheduled tasks to its back, an idle worker steals from the back of the other deques */
+class TaskPool{
+public:
+  enum TaskResult{
+    TASK_RESCHEDULE,
+    /** Rescheduled without doing any work (paused), a worker going through only idle tasks sleeps briefly */
+    TASK_IDLE,
+    TASK_FINISHED
+  };
+  /** Runs a bounded piece of work */
+  using Task = std::function<TaskResult()>;
+
+private:
+  struct Worker{
+    std::deque<Task> tasks;
+    std::mutex lock;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  /** Tasks waiting in the deques, idle workers sleep while there are none */
+  size_t queued_tasks_;
+  /** Submitted tasks which haven't finished yet */
+  size_t unfinished_tasks_;
+  size_t next_worker_;
+  bool stopped_;
+  std::mutex lock_;
+  std::condition_variable task_condition_;
+  std::condition_variable finished_condition_;
+
+  void push(unsigned int worker_idx, Task task);
+  /** Own task first, then a task stolen from the other workers, false if there is none */
+  bool pop(unsigned int worker_idx, Task &task);
+  void work(unsigned int worker_idx);
+
+public:
+  /** Starts worker_count workers, each calls setup with its index first (thread placement) */
+  TaskPool(unsigned int worker_count, const std::function<void(unsigned int)> &setup);
+  /** Stops the workers after their current tasks, queued tasks are dropped */
+  ~TaskPool();
+  TaskPool(const TaskPool &) = delete;
+  TaskPool &operator=(const TaskPool &) = delete;
+
+  /** Adds the task to the workers' deques in turn */
+  void submit(Task task);
+  /** Waits until all submitted tasks have finished */
+  void wait();
+  [[nodiscard]] inline unsigned int getWorkerCount() const {return (unsigned int)workers_.size();}
+};
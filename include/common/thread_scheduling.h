@@ -0,0 +1,52 @@
+#pragma once
+#include "nlohmann/json.hpp"
+#include <vector>
+
+/** Placement of the heuristic threads, read from "scheduling" next to "heuristics" in the config:
+ *  "cpus": CPU list ("0-3,8") for all heuristics, or an array of lists used by the heuristics in turn,
+ *  "numa_nodes": NUMA node (or an array of nodes used in turn), threads run on the node's CPUs and allocate there,
+ *  "nice": nice value of the heuristic threads (or an array of values used in turn),
+ *  "max_threads": cap on the heuristic threads running at once, the others start when a thread finishes,
+ *  "replicate_distances": every heuristic gets its own copy of the instance distances on its thread's node,
+ *  "workers": runs the heuristics in units on this many worker threads instead of a thread per heuristic,
+ *  "slice_ms": time a worker spends on one heuristic before switching to the next one (default 20),
+ *  "adaptive": with workers, slices are lengthened or shortened by a bandit policy over each heuristic's
+ *  improvements of the best-so-far solution per CPU second ("exploration" default 0.3, "discount" default 0.9).
+ * The i-th heuristic (constructions first, then the config order) uses the (i mod size)-th element of an array,
+ * with workers the placement applies to the i-th worker and max_threads is ignored. */
+class ThreadScheduling{
+private:
+  std::vector<std::vector<int>> cpu_sets_;
+  std::vector<int> numa_nodes_;
+  std::vector<int> nice_values_;
+  unsigned int max_threads_;
+  bool replicate_distances_;
+  unsigned int worker_count_;
+  unsigned int slice_ms_;
+  bool adaptive_;
+  double exploration_;
+  double discount_;
+
+  /** Parses "0-3,8" style lists as used by taskset and /sys/devices/system/node/node<N>/cpulist */
+  static bool parseCpuList(const std::string &list, std::vector<int> &cpus);
+  /** CPUs of the NUMA node, empty if the node doesn't exist */
+  static std::vector<int> numaNodeCpus(int node);
+
+public:
+  /** No placement: unpinned threads, default priority and no cap */
+  ThreadScheduling();
+  /** Exits with code 100 when the config is malformed */
+  explicit ThreadScheduling(const nlohmann::json &config);
+
+  [[nodiscard]] inline unsigned int getMaxThreads() const {return max_threads_;}
+  [[nodiscard]] inline bool replicateDistances() const {return replicate_distances_;}
+  /** Worker threads of the task pool, 0 runs every heuristic on its own thread */
+  [[nodiscard]] inline unsigned int getWorkerCount() const {return worker_count_;}
+  [[nodiscard]] inline unsigned int getSliceMs() const {return slice_ms_;}
+  [[nodiscard]] inline bool isAdaptive() const {return adaptive_;}
+  [[nodiscard]] inline double getExploration() const {return exploration_;}
+  [[nodiscard]] inline double getDiscount() const {return discount_;}
+  /** Pins the calling thread, binds its memory to the NUMA node and sets its nice value as configured for the
+   * heuristic (or the worker); failures (e.g. missing privileges for negative nice values) are reported and ignored */
+  void applyToCurrentThread(unsigned int heuristic_idx) const;
+};
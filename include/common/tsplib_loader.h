@@ -1,32 +1,36 @@
 #pragma once
 
 #include "routing_instance.h"
+#include "mapped_file.h"
 #include <cassert>
+#include <charconv>
 #include <cmath>
-#include <fstream>
 #include <iostream>
-#include <regex>
+#include <string_view>
 
 class RoutingInstance::TSPlibLoader{
 public:
-  static void loadHeader(RoutingInstance &instance, std::ifstream &file);
-  static std::string parseName(std::string &line);
-  static ProblemType parseType(std::string &line);
-  static std::string parseComment(std::string &line);
-  static EdgeWeightType parseEdgeWeightType(std::string &line);
-  static EdgeWeightFormat parseEdgeWeightFormat(std::string &line);
-  static DisplayDataType parseDisplayDataType(std::string &line);
+  static void loadHeader(RoutingInstance &instance, MappedFile &file);
+  static std::string parseName(std::string_view value);
+  static ProblemType parseType(std::string_view type);
+  static std::string parseComment(std::string_view value);
+  static EdgeWeightType parseEdgeWeightType(std::string_view type);
+  static EdgeWeightFormat parseEdgeWeightFormat(std::string_view format);
+  static DisplayDataType parseDisplayDataType(std::string_view type);
 
-  static void loadNodes(RoutingInstance &instance, std::ifstream  &file);
-  static void loadNodes_EUC_2D(RoutingInstance &instance, std::ifstream &file);
-  static void loadNodes_GEO(RoutingInstance &instance, std::ifstream  &file);
-  static void loadNodes_CEIL_2D(RoutingInstance &instance, std::ifstream &file);
-  static void loadNodes_FULL_MATRIX(RoutingInstance &instance, std::ifstream &file);
+  static void loadNodes(RoutingInstance &instance, MappedFile &file);
+  /** Reads the node coordinates to the instance coordinate arrays */
+  static void loadCoordinates(RoutingInstance &instance, MappedFile &file);
+  static void loadNodes_EUC_2D(RoutingInstance &instance, MappedFile &file);
+  static void loadNodes_GEO(RoutingInstance &instance, MappedFile &file);
+  static void loadNodes_CEIL_2D(RoutingInstance &instance, MappedFile &file);
+  static void loadNodes_FULL_MATRIX(RoutingInstance &instance, MappedFile &file);
 
   static void fillNodes(RoutingInstance &instance);
-  static void loadDemand(RoutingInstance &instance, std::ifstream &file);
-  static void loadDepos(RoutingInstance &instance, std::ifstream &file);
+  static void loadDemand(RoutingInstance &instance, MappedFile &file);
+  static void loadDepos(RoutingInstance &instance, MappedFile &file);
 
-  static inline std::string strip(const std::string& line);
+  static void numberError();
+  static inline std::string_view strip(std::string_view line);
   static inline std::pair<double, double> latitudeLongitude(double x, double y);
 };
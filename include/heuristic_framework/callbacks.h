@@ -8,11 +8,15 @@ class Callbacks{
 private:
   std::vector<std::function<void(const std::shared_ptr<Individual> &)>> new_best_solution_callbacks_;
   std::function<bool()> terminate_;
+  std::function<void()> poll_outside_solution_;
 public:
   Callbacks();
   void newBestSolution(const std::shared_ptr<Individual> &);
   bool shouldTerminate();
+  /** Lets the heuristic pick up a new outside solution, called by the algorithms once per iteration */
+  void pollOutsideSolution();
 
   void addNewBestSolutionCallback(const std::function<void(const std::shared_ptr<Individual> &)>& function);
   void setTerminationCondition(std::function<bool()>);
+  void setOutsideSolutionPoll(std::function<void()>);
 };
\ No newline at end of file
@@ -10,6 +10,7 @@ class ExhaustiveLocalSearch {
 private:
   std::shared_ptr<Neighborhood> neighborhood_;
   std::shared_ptr<Callbacks> callbacks_;
+  std::shared_ptr<Individual> solution_;
   std::shared_ptr<Individual> best_individual_;
   std::shared_ptr<Individual> outside_solution_;
   std::recursive_mutex outside_solution_mutex_;
@@ -20,5 +21,8 @@ private:
 public:
   ExhaustiveLocalSearch(const std::shared_ptr<Callbacks> &callbacks, const std::shared_ptr<Neighborhood> &neighborhood);
   void acceptOutsideSolution(const std::shared_ptr<Individual> &individual);
-  void run(const std::shared_ptr<Individual> &initialSolution);
+  /** Prepares the search from the initial solution, advanced by step */
+  void start(const std::shared_ptr<Individual> &initialSolution);
+  /** One iteration of the search, returns false once the search is terminated */
+  bool step();
 };
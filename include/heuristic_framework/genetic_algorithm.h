@@ -38,5 +38,8 @@ public:
       );
 
   void acceptOutsideSolution(const std::shared_ptr<Individual> &individual);
-  void run(const std::shared_ptr<Population> &initialPopulation);
+  /** Prepares the search from the initial population, advanced by step */
+  void start(const std::shared_ptr<Population> &initialPopulation);
+  /** One iteration of the search, returns false once the search is terminated */
+  bool step();
 };
\ No newline at end of file
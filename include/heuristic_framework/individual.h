@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <vector>
 #include <memory>
 
@@ -13,6 +14,12 @@ public:
   virtual void initialize() = 0;
   /** Smart randomized initialization with possible basic optimizations */
   virtual void smartInitialize() = 0;
+  /** smartInitialize giving up once should_terminate returns true, the individual is then basically initialized
+   * and the result is false; for the individuals whose smart initialization is expensive */
+  virtual bool smartInitialize(const std::function<bool()> &) {
+    smartInitialize();
+    return true;
+  }
   virtual double getFitness() = 0;
   virtual double getTotalConstraintViolation() = 0;
   virtual const std::vector<double> &getConstraintViolations() = 0;
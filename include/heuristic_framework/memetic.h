@@ -21,6 +21,8 @@ private:
   std::shared_ptr<Crossover> crossover_;
   std::shared_ptr<Replacement> replacement_;
 
+  uint stable_population_size_;
+
   std::shared_ptr<Individual> best_individual_;
   std::shared_ptr<Individual> outside_solution_;
   std::recursive_mutex outside_solution_mutex_;
@@ -32,6 +34,8 @@ private:
   bool checkBetterSolution(const std::shared_ptr<Individual> &individual);
   bool checkOutsideSolution();
   bool getRandomBool(const double &success_rate);
+  /** Improves the individual by the neighborhood until it is exhausted, false if the search was terminated meanwhile */
+  bool localSearch(const std::shared_ptr<Individual> &individual);
 
 public:
   MemeticAlgorithm(
@@ -44,5 +48,8 @@ public:
       );
 
   void acceptOutsideSolution(const std::shared_ptr<Individual> &individual);
-  void run(const std::shared_ptr<Population> &initialPopulation);
+  /** Prepares the search from the initial population, advanced by step */
+  void start(const std::shared_ptr<Population> &initialPopulation);
+  /** One iteration of the search, returns false once the search is terminated */
+  bool step();
 };
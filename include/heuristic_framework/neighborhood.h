@@ -13,5 +13,6 @@ public:
   };
 
   virtual SearchResult search(const std::shared_ptr<Individual> &individual) = 0;
+  /** Must be called before searching a different individual or one changed outside of the neighborhood */
   virtual void reset(const std::shared_ptr<Individual> &individual) = 0;
 };
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "callbacks.h"
+#include "individual.h"
+#include "ruin_recreate_operators.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+/** Removal methods of the ruin step of ruin and recreate */
+enum RuinMethod{
+  /** Strings of consecutive customers from routes near a seed customer (SISR), some split around a kept substring */
+  STRING_RUIN,
+  RANDOM_RUIN,
+  /** Seed customer and its nearest customers */
+  RELATED_RUIN,
+  /** Customers saving the most when removed, randomized */
+  WORST_RUIN
+};
+
+/** Acceptance criteria of the ruin and recreate iterations */
+enum RuinRecreateAcceptance{
+  /** Simulated annealing, the temperature decreases exponentially over the cooling time of the heuristic's run time */
+  ANNEALING_ACCEPTANCE,
+  /** Record-to-record travel, accepts solutions less than the deviation worse than the best one */
+  RECORD_TO_RECORD_ACCEPTANCE
+};
+
+/** Parameters of ruin and recreate, described in RuinRecreateConfig */
+struct RuinRecreateParameters{
+  std::vector<RuinMethod> removals;
+  uint average_removed;
+  uint max_string_length;
+  double split_rate;
+  double split_depth;
+  double blink_rate;
+  RuinRecreateAcceptance acceptance;
+  double initial_temperature;
+  double final_temperature;
+  double cooling_time;
+  double deviation;
+  uint iterations_per_unit;
+  uint candidate_count;
+  /** Costs of a used vehicle and of a unit of constraint violation in the accepted solution value */
+  double vehicle_cost;
+  double violation_cost;
+};
+
+/** Ruin and recreate (large neighborhood search): every iteration removes a few related customers from the current
+ * solution (SISR strings, random, related or worst removal) and reinserts them one by one at their cheapest position,
+ * skipping positions at the blink rate; the result replaces the current solution by simulated annealing or
+ * record-to-record travel over the cost of the operators */
+class RuinRecreate{
+private:
+  struct CustomerPosition{
+    uint route_idx;
+    uint customer_idx;
+  };
+
+  std::shared_ptr<Callbacks> callbacks_;
+  std::shared_ptr<RuinRecreateOperators> operators_;
+  RuinRecreateParameters parameters_;
+  std::random_device rand_;
+  std::mt19937 gen_;
+  uint candidate_count_;
+  std::shared_ptr<Individual> current_;
+  double current_cost_;
+  std::shared_ptr<Individual> best_;
+  double best_cost_;
+  std::shared_ptr<Individual> outside_solution_;
+  std::recursive_mutex outside_solution_mutex_;
+  /** Seconds spent in the units since start, the cooling progress */
+  double run_time_;
+  /** Annealing temperature of the current unit */
+  double temperature_;
+
+  std::vector<CustomerPosition> positions_;
+  std::vector<bool> is_removed_;
+  std::vector<bool> is_ruined_;
+  std::vector<uint> removed_;
+  std::vector<std::pair<double, uint>> removal_costs_;
+
+  /** Adopts a better outside solution, returns true if it was adopted */
+  bool checkOutsideSolution();
+  /** Ruins and recreates a copy of the current solution, which replaces it if accepted, returns true if it is the new
+   * best solution */
+  bool iterate();
+  /** Marks the customer as removed in the ruin step, false if it already was */
+  bool markRemoved(uint node);
+  /** Strings of customers from the routes nearest to a random seed customer (Christiaens and Vanden Berghe) */
+  void stringRuin(Individual &individual);
+  void randomRuin(uint count);
+  /** Random seed customer and its nearest customers */
+  void relatedRuin(uint count);
+  /** Customers with the highest removal savings in the ruined solution, the earlier ones more likely */
+  void worstRuin(Individual &individual, uint count);
+  /** Removes the marked customers from the individual, the consecutive ones as a single segment */
+  void removeMarked(Individual &individual);
+  /** Greedy insertion with blinks of the removed customers, sorted randomly, by demand or by the depot distance */
+  void recreate(Individual &individual);
+  /** Acceptance criterion of the candidate solution cost */
+  bool accept(double candidate_cost);
+
+public:
+  RuinRecreate(const std::shared_ptr<Callbacks> &callbacks, const std::shared_ptr<RuinRecreateOperators> &operators,
+               const RuinRecreateParameters &parameters);
+  void acceptOutsideSolution(const std::shared_ptr<Individual> &individual);
+  /** Prepares the search from the evaluated initial solution, advanced by step */
+  void start(const std::shared_ptr<Individual> &initial_solution);
+  /** Runs iterations_per_unit ruin and recreate iterations, returns false once the search is terminated */
+  bool step();
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "individual.h"
+#include "simulated_annealing_fitness_diff.h"
+
+using uint = unsigned int;
+
+/** Problem-specific part of ruin and recreate: the customers of a routing problem, the routes of its individuals and
+ * the costs of removing and inserting customers. Customers are the nodes 1 .. getNodesCount() - 1, 0 is the depot.
+ * The individuals are passed by reference, most hooks are called in the inner loops of the ruin and recreate steps */
+class RuinRecreateOperators{
+public:
+  virtual uint getNodesCount() = 0;
+  /** Nearest nodes of the node, getCandidateCount() of them */
+  virtual const uint *getCandidates(uint node) = 0;
+  virtual uint getCandidateCount() = 0;
+  virtual uint getDemand(uint node) = 0;
+  virtual uint getDepotDistance(uint node) = 0;
+
+  virtual uint getRouteCount(Individual &individual) = 0;
+  virtual uint getRouteSize(Individual &individual, uint route_idx) = 0;
+  virtual uint getCustomer(Individual &individual, uint route_idx, uint customer_idx) = 0;
+  /** True if inserting the node into the route violates the vehicle capacity */
+  virtual bool exceedsCapacity(Individual &individual, uint route_idx, uint node) = 0;
+  virtual FitnessDiff getRemovalCost(Individual &individual, uint route_idx, uint customer_idx) = 0;
+  /** Cost of inserting the node in front of the customer at the position, the route size inserts at the route end */
+  virtual FitnessDiff getInsertionCost(Individual &individual, uint route_idx, uint position, uint node) = 0;
+  virtual void performRemoval(Individual &individual, uint route_idx, uint start_idx, uint length) = 0;
+  virtual void performInsertion(Individual &individual, uint route_idx, uint position, uint node) = 0;
+  /** Value minimized by the acceptance criterion, the fitness penalized by the constraint violation */
+  virtual double getCost(Individual &individual) = 0;
+
+  virtual ~RuinRecreateOperators() = default;
+};
@@ -18,6 +18,7 @@ private:
   std::shared_ptr<SABasicStep> step_;
   std::shared_ptr<SABasicSchedule> schedule_;
   std::shared_ptr<Callbacks> callbacks_;
+  std::shared_ptr<Individual> solution_;
   std::shared_ptr<Individual> best_individual_;
   std::shared_ptr<Individual> outside_solution_;
   std::recursive_mutex outside_solution_mutex_;
@@ -28,5 +29,8 @@ private:
 public:
   SimulatedAnnealingBasic(const std::shared_ptr<Callbacks> &callbacks, const std::shared_ptr<SABasicStep> &step, const std::shared_ptr<SABasicSchedule> &schedule);
   void acceptOutsideSolution(const std::shared_ptr<Individual> &individual);
-  void run(const std::shared_ptr<Individual> &initialSolution);
+  /** Prepares the search from the initial solution, advanced by step */
+  void start(const std::shared_ptr<Individual> &initialSolution);
+  /** One iteration of the search, returns false once the search is terminated */
+  bool step();
 };
\ No newline at end of file
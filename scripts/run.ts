@@ -1,16 +1,22 @@
 import { defineModelCVRP, defineModelTSP, defineModelVRPTW } from "./modeller.js";
 import { parseTspLib, parseSolomon } from "./parser.js";
-import { parseSolutionCVRP, parseSolutionTSP, parseSolutionVRPTW, serializeSolutionCVRP, serializeSolutionTSP, serializeSolutionVRPTW } from "./solutionParser.js";
+import { parseSolutionCVRP, parseSolutionTSP, parseSolutionVRPTW, buildSolutionCVRP, buildSolutionTSP, buildSolutionVRPTW, SolutionObject, encodeSolutionFrame, encodeSolutionPayload, decodeSolutionFrame, SolutionFrameReader } from "./solutionParser.js";
+import { SharedMemoryChannel } from "./sharedMemoryChannel.js";
 import * as CP from '@scheduleopt/optalcp';
 import { spawn } from 'child_process';
 import { readConfig } from "./config_loader.js";
 import * as readline from 'node:readline';
 import { exit } from "node:process";
+import { getBoolOption } from "./utils.js";
 
 let params: CP.BenchmarkParameters = {
-    usage: "Usage: node tsp.js [OPTIONS] INPUT_FILE [INPUT_FILE2] .."
+    usage: "Usage: node tsp.js [OPTIONS] [--binary-protocol] [--shm-channel] INPUT_FILE [INPUT_FILE2] .."
 };
 let restArgs = CP.parseSomeBenchmarkParameters(params);
+// Solutions are exchanged with the heuristics as binary frames instead of JSON lines
+let binaryProtocol = getBoolOption("--binary-protocol", restArgs);
+// Solutions are exchanged through a shared memory segment instead of the stdio pipes
+let sharedMemory = getBoolOption("--shm-channel", restArgs);
 let configFilename = restArgs[0];
 let instanceFilename = restArgs[1];
 let logFilename = restArgs[2];
@@ -37,25 +43,63 @@ if (instance == undefined) {
     exit(100);
 }
 
-let heuristics = spawn('./build/Heuristic', [configFilename, instanceFilename, logFilename, `${seed}`], { windowsHide: true });
-process.on('exit', () => { heuristics.kill(); });
-let heuristicsPipe = readline.createInterface({ input: heuristics.stdout, terminal: false, crlfDelay: Infinity });
+let heuristicsArgs = [configFilename, instanceFilename, logFilename, `${seed}`];
+if (binaryProtocol)
+    heuristicsArgs.push("--binary-protocol");
+let channelName = `routing-heuristics-${process.pid}`;
+if (sharedMemory)
+    heuristicsArgs.push("--shm-channel", channelName);
+let heuristics = spawn('./build/Heuristic', heuristicsArgs, { windowsHide: true });
+let channel: Promise<SharedMemoryChannel> | undefined = sharedMemory ? SharedMemoryChannel.open(channelName) : undefined;
+let openChannel: SharedMemoryChannel | undefined;
+channel?.then(opened => { openChannel = opened; });
+process.on('exit', () => { openChannel?.close(); heuristics.kill(); });
 let heuristicsDebugPipe = readline.createInterface({ input: heuristics.stderr, terminal: false, crlfDelay: Infinity });
 heuristicsDebugPipe.on('line', async line => { console.log("strerr: " + line); });
 
+/** Calls the callback for every solution message received from the heuristics */
+function onHeuristicsSolution(callback: (message: string | SolutionObject) => void) {
+    if (channel != undefined) {
+        channel.then(opened => {
+            setInterval(() => {
+                const payload = opened.receive();
+                if (payload != undefined)
+                    callback(decodeSolutionFrame(payload, problemType, instance!));
+            }, 5).unref();
+        });
+    } else if (binaryProtocol) {
+        let frameReader = new SolutionFrameReader();
+        heuristics.stdout.on('data', (chunk: Buffer) => {
+            for (const payload of frameReader.push(chunk))
+                callback(decodeSolutionFrame(payload, problemType, instance!));
+        });
+    } else {
+        let heuristicsPipe = readline.createInterface({ input: heuristics.stdout, terminal: false, crlfDelay: Infinity });
+        heuristicsPipe.on('line', callback);
+    }
+}
+
+function sendToHeuristics(solution: SolutionObject) {
+    if (channel != undefined)
+        channel.then(opened => opened.send(encodeSolutionPayload(solution)));
+    else if (binaryProtocol)
+        heuristics.stdin.write(encodeSolutionFrame(solution));
+    else
+        heuristics.stdin.write(`${JSON.stringify(solution)}\n`);
+}
+
 let optimalSolution: Promise<CP.SolveResult>;
 
 if (problemType == "TSP") {
     let [model, vars] = defineModelTSP(instance, instanceFilename, 1);
 
-    heuristicsPipe.on('line', async line => {
-        let solution = parseSolutionTSP(line, vars, instance);
+    onHeuristicsSolution(async message => {
+        let solution = parseSolutionTSP(message, vars, instance);
         solver.sendSolution(solution);
     });
 
     solver.on('solution', async (msg: CP.SolutionEvent) => {
-        let solution_string = serializeSolutionTSP(msg.solution, vars, instance);
-        heuristics.stdin.write(`${solution_string}\n`);
+        sendToHeuristics(buildSolutionTSP(msg.solution, vars, instance));
     });
 
     if (params.nbWorkers != 0)
@@ -63,15 +107,14 @@ if (problemType == "TSP") {
 } else if (problemType == "CVRP") {
     let [model, vars] = defineModelCVRP(instance, instanceFilename, 1);
 
-    heuristicsPipe.on('line', async line => {
-        let solution = parseSolutionCVRP(line, vars, instance);
+    onHeuristicsSolution(async message => {
+        let solution = parseSolutionCVRP(message, vars, instance);
         //console.log(line);
         solver.sendSolution(solution);
     });
 
     solver.on('solution', async (msg: CP.SolutionEvent) => {
-        let solution_string = serializeSolutionCVRP(msg.solution, vars, instance);
-        heuristics.stdin.write(`${solution_string}\n`);
+        sendToHeuristics(buildSolutionCVRP(msg.solution, vars, instance));
     });
 
     if (params.nbWorkers != 0)
@@ -79,14 +122,13 @@ if (problemType == "TSP") {
 } else if (problemType == "VRP-TW") {
     let [model, vars] = defineModelVRPTW(instance, instanceFilename);
 
-    heuristicsPipe.on('line', async line => {
-        let solution = parseSolutionVRPTW(line, vars, instance);
+    onHeuristicsSolution(async message => {
+        let solution = parseSolutionVRPTW(message, vars, instance);
         solver.sendSolution(solution);
     });
 
     solver.on('solution', async (msg: CP.SolutionEvent) => {
-        let solution_string = serializeSolutionVRPTW(msg.solution, vars, instance);
-        heuristics.stdin.write(`${solution_string}\n`);
+        sendToHeuristics(buildSolutionVRPTW(msg.solution, vars, instance));
     });
 
     if (params.nbWorkers != 0)
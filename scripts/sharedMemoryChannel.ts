@@ -0,0 +1,114 @@
+import * as fs from 'fs';
+
+/*
+ * Solver side of the shared memory channel created by the heuristics (the --shm-channel option), see
+ * include/common/shared_memory_channel.h for the layout. Node has no mmap nor futex, so the segment is
+ * accessed by positioned reads and writes of /dev/shm/<name> and the solver side polls for new solutions.
+ */
+
+const MAGIC = 0x4d48534f50544e52n;
+const VERSION = 1;
+const ALIGNMENT = 64;
+const CLOSED_OFFSET = 16;
+const TO_SOLVER_SLOT = 0;
+const FROM_SOLVER_SLOT = 1;
+/** Payload reads racing with the writer are retried this many times before waiting for the next poll */
+const MAX_READ_ATTEMPTS = 16;
+
+export class SharedMemoryChannel {
+    private fd: number;
+    private path: string;
+    private capacity: number;
+    private slotStride: number;
+    private sentSequence = 0;
+    private receivedSequence = 0;
+    private word = Buffer.alloc(8);
+
+    private constructor(fd: number, path: string, capacity: number) {
+        this.fd = fd;
+        this.path = path;
+        this.capacity = capacity;
+        this.slotStride = ALIGNMENT + Math.ceil(capacity / ALIGNMENT) * ALIGNMENT;
+    }
+
+    /** Waits until the heuristics create the segment of the given name */
+    static async open(name: string, timeoutMs: number = 60000): Promise<SharedMemoryChannel> {
+        const path = `/dev/shm/${name}`;
+        const deadline = Date.now() + timeoutMs;
+        let header = Buffer.alloc(ALIGNMENT);
+        while (Date.now() < deadline) {
+            try {
+                const fd = fs.openSync(path, 'r+');
+                if (fs.readSync(fd, header, 0, ALIGNMENT, 0) == ALIGNMENT && header.readBigUInt64LE(0) == MAGIC) {
+                    if (header.readUInt32LE(8) != VERSION)
+                        throw new Error(`Unsupported shared memory channel version ${header.readUInt32LE(8)}`);
+                    return new SharedMemoryChannel(fd, path, header.readUInt32LE(12));
+                }
+                fs.closeSync(fd);
+            } catch (error: any) {
+                if (error.code != 'ENOENT')
+                    throw error;
+            }
+            await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        throw new Error(`Shared memory channel ${path} was not created in time`);
+    }
+
+    private slotOffset(slot: number): number {
+        return ALIGNMENT + slot * this.slotStride;
+    }
+
+    private readWord(offset: number): number {
+        fs.readSync(this.fd, this.word, 0, 4, offset);
+        return this.word.readUInt32LE(0);
+    }
+
+    private writeWord(offset: number, value: number) {
+        this.word.writeUInt32LE(value, 0);
+        fs.writeSync(this.fd, this.word, 0, 4, offset);
+    }
+
+    /** Publishes a frame payload to the heuristics, an unread older one is overwritten */
+    send(payload: Buffer) {
+        if (payload.length > this.capacity)
+            throw new Error(`Solution payload of ${payload.length} bytes doesn't fit the shared memory slot`);
+        const offset = this.slotOffset(FROM_SOLVER_SLOT);
+        this.sentSequence = (this.sentSequence + 1) >>> 0;
+        this.writeWord(offset, this.sentSequence);
+        fs.writeSync(this.fd, payload, 0, payload.length, offset + ALIGNMENT);
+        this.writeWord(offset + 4, payload.length);
+        this.sentSequence = (this.sentSequence + 1) >>> 0;
+        this.writeWord(offset, this.sentSequence);
+    }
+
+    /** Returns the payload published by the heuristics since the last call, undefined if there is none */
+    receive(): Buffer | undefined {
+        const offset = this.slotOffset(TO_SOLVER_SLOT);
+        for (let attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+            const sequence = this.readWord(offset);
+            if (sequence == this.receivedSequence)
+                return undefined;
+            if (sequence % 2 == 1)
+                continue;
+            const size = Math.min(this.readWord(offset + 4), this.capacity);
+            let payload = Buffer.alloc(size);
+            fs.readSync(this.fd, payload, 0, size, offset + ALIGNMENT);
+            if (this.readWord(offset) == sequence) {
+                this.receivedSequence = sequence;
+                return payload;
+            }
+        }
+        return undefined;
+    }
+
+    /** Tells the heuristics that the solver has finished and removes the segment */
+    close() {
+        this.writeWord(CLOSED_OFFSET, 1);
+        fs.closeSync(this.fd);
+        try {
+            fs.unlinkSync(this.path);
+        } catch (error) {
+            // already removed by the heuristics
+        }
+    }
+}
@@ -3,9 +3,18 @@ import { TspVars, CvrpVars, bigM } from "./modeller.js";
 import { ParseResult } from "./parser.js";
 import * as CP from '@scheduleopt/optalcp';
 
-export function parseSolutionTSP(solution_string: string, vars: TspVars, instance: ParseResult): CP.Solution {
+export type SolutionNode = { idx: number, start_time: number, end_time: number };
+export type SolutionRoute = { travel_time: number, demand: number, end_time: number, route_nodes: SolutionNode[] };
+export type SolutionObject = { travel_time_sum: number, end_time_sum: number, objective: number, routes: SolutionRoute[] };
+
+/** Solution message received from the heuristics, a JSON line or a decoded binary frame */
+function readSolutionMessage(message: string | SolutionObject): SolutionObject {
+    return typeof message == "string" ? JSON.parse(message) : message;
+}
+
+export function parseSolutionTSP(solution_message: string | SolutionObject, vars: TspVars, instance: ParseResult): CP.Solution {
     let solution = new CP.Solution;
-    let solution_json = JSON.parse(solution_string)
+    let solution_json = readSolutionMessage(solution_message);
     solution.setObjective(solution_json.objective);
     for (let node of solution_json.routes[0].route_nodes.slice(1)) {
         //console.log(`${node.idx} ${node.start_time} ${node.end_time} ${instance.transitionMatrix[prev_node][node.idx]}`);
@@ -16,7 +25,11 @@ export function parseSolutionTSP(solution_string: string, vars: TspVars, instanc
 }
 
 export function serializeSolutionTSP(solution: CP.Solution, vars: TspVars, instance: ParseResult): string {
-    let path: { idx: number, start_time: number, end_time: number }[] = [];
+    return JSON.stringify(buildSolutionTSP(solution, vars, instance));
+}
+
+export function buildSolutionTSP(solution: CP.Solution, vars: TspVars, instance: ParseResult): SolutionObject {
+    let path: SolutionNode[] = [];
     path.push({ idx: 0, start_time: 0, end_time: 0 });
     for (let i = 0; i < instance.nbNodes; i++) {
         const v = vars.visits[i];
@@ -51,12 +64,12 @@ export function serializeSolutionTSP(solution: CP.Solution, vars: TspVars, insta
             }
         ]
     };
-    return JSON.stringify(solution_object);
+    return solution_object as SolutionObject;
 }
 
-export function parseSolutionCVRP(solution_string: string, vars: CvrpVars, instance: ParseResult): CP.Solution {
+export function parseSolutionCVRP(solution_message: string | SolutionObject, vars: CvrpVars, instance: ParseResult): CP.Solution {
     let solution = new CP.Solution;
-    let solution_json = JSON.parse(solution_string);
+    let solution_json = readSolutionMessage(solution_message);
     assert(solution_json.routes.length == instance.nbVehicles, `Vehicles present: ${solution_json.routes.length}, expected ${instance.nbVehicles}`)
     solution.setObjective(solution_json.objective);
     for (let i = 0; i < instance.nbVehicles!; i++) {
@@ -72,11 +85,15 @@ export function parseSolutionCVRP(solution_string: string, vars: CvrpVars, insta
 }
 
 export function serializeSolutionCVRP(solution: CP.Solution, vars: CvrpVars, instance: ParseResult): string {
-    let routes = [];
+    return JSON.stringify(buildSolutionCVRP(solution, vars, instance));
+}
+
+export function buildSolutionCVRP(solution: CP.Solution, vars: CvrpVars, instance: ParseResult): SolutionObject {
+    let routes: SolutionRoute[] = [];
     let nbCustomers = instance.nbNodes - 1;
 
     for (let r = 0; r < instance.nbVehicles!; r++) {
-        let path: { idx: number, start_time: number, end_time: number }[] = [];
+        let path: SolutionNode[] = [];
         path.push({ idx: 0, start_time: 0, end_time: 0 });
         for (let i = 0; i < nbCustomers; i++) {
             const v = vars.visits[i][r];
@@ -124,12 +141,12 @@ export function serializeSolutionCVRP(solution: CP.Solution, vars: CvrpVars, ins
         routes: routes
     };
 
-    return JSON.stringify(solution_object);
+    return solution_object as SolutionObject;
 }
 
-export function parseSolutionVRPTW(solution_string: string, vars: CvrpVars, instance: ParseResult): CP.Solution {
+export function parseSolutionVRPTW(solution_message: string | SolutionObject, vars: CvrpVars, instance: ParseResult): CP.Solution {
     let solution = new CP.Solution;
-    let solution_json = JSON.parse(solution_string);
+    let solution_json = readSolutionMessage(solution_message);
     assert(solution_json.routes.length == instance.nbVehicles, `Vehicles present: ${solution_json.routes.length}, expected ${instance.nbVehicles}`);
     let used_vehicles = 0;
     for (let i = 0; i < instance.nbVehicles!; i++) {
@@ -155,11 +172,15 @@ export function parseSolutionVRPTW(solution_string: string, vars: CvrpVars, inst
 }
 
 export function serializeSolutionVRPTW(solution: CP.Solution, vars: CvrpVars, instance: ParseResult): string {
-    let routes = [];
+    return JSON.stringify(buildSolutionVRPTW(solution, vars, instance));
+}
+
+export function buildSolutionVRPTW(solution: CP.Solution, vars: CvrpVars, instance: ParseResult): SolutionObject {
+    let routes: SolutionRoute[] = [];
     let nbCustomers = instance.nbNodes - 1;
 
     for (let r = 0; r < instance.nbVehicles!; r++) {
-        let path: { idx: number, start_time: number, end_time: number }[] = [];
+        let path: SolutionNode[] = [];
         path.push({ idx: 0, start_time: 0, end_time: 0 });
         for (let i = 0; i < nbCustomers; i++) {
             const v = vars.visits[i][r];
@@ -206,5 +227,118 @@ export function serializeSolutionVRPTW(solution: CP.Solution, vars: CvrpVars, in
         routes: routes
     };
 
-    return JSON.stringify(solution_object);
+    return solution_object as SolutionObject;
+}
+
+/*
+ * Binary solution frames (the --binary-protocol option), the same format as SolutionSerializer in C++:
+ * a 4-byte little-endian payload length followed by the payload of LEB128 varints, i.e. zigzag-encoded
+ * objective, route count and for each route its customer count and customer indices. Depots and times
+ * are left out and recomputed from the instance on the receiving side.
+ */
+
+function writeVarint(bytes: number[], value: number) {
+    while (value >= 0x80) {
+        bytes.push((value % 0x80) | 0x80);
+        value = Math.floor(value / 0x80);
+    }
+    bytes.push(value);
+}
+
+function readVarint(payload: Buffer, position: { offset: number }): number {
+    let value = 0;
+    let multiplier = 1;
+    while (position.offset < payload.length) {
+        const byte = payload[position.offset++];
+        value += (byte & 0x7f) * multiplier;
+        if (byte < 0x80)
+            return value;
+        multiplier *= 0x80;
+    }
+    throw new Error("Truncated solution frame");
+}
+
+export function encodeSolutionFrame(solution: SolutionObject): Buffer {
+    const payload = encodeSolutionPayload(solution);
+    let frame = Buffer.alloc(4 + payload.length);
+    frame.writeUInt32LE(payload.length, 0);
+    payload.copy(frame, 4);
+    return frame;
+}
+
+/** Frame payload without the length, as stored in the shared memory channel */
+export function encodeSolutionPayload(solution: SolutionObject): Buffer {
+    let bytes: number[] = [];
+    const objective = Math.round(solution.objective);
+    writeVarint(bytes, objective >= 0 ? 2 * objective : -2 * objective - 1);
+    writeVarint(bytes, solution.routes.length);
+    for (const route of solution.routes) {
+        const customers = route.route_nodes.filter(node => node.idx != 0);
+        writeVarint(bytes, customers.length);
+        for (const node of customers)
+            writeVarint(bytes, node.idx);
+    }
+    return Buffer.from(bytes);
+}
+
+/** Recomputes the solution from a frame payload the same way as the individuals' convertSolution in C++ */
+export function decodeSolutionFrame(payload: Buffer, problemType: string, instance: ParseResult): SolutionObject {
+    const isTsp = problemType == "TSP";
+    const hasTimeWindows = problemType == "VRP-TW";
+    let position = { offset: 0 };
+    const zigzagObjective = readVarint(payload, position);
+    const objective = zigzagObjective % 2 == 0 ? zigzagObjective / 2 : -(zigzagObjective + 1) / 2;
+    const routeCount = readVarint(payload, position);
+    let routes: SolutionRoute[] = [];
+    let travel_time_sum = 0;
+    let end_time_sum = 0;
+    for (let r = 0; r < routeCount; r++) {
+        const customerCount = readVarint(payload, position);
+        let time = isTsp ? 1 : 0;
+        let travel_time = 0;
+        let demand = 0;
+        let path: SolutionNode[] = [{ idx: 0, start_time: 0, end_time: time }];
+        let prev = 0;
+        for (let c = 0; c < customerCount; c++) {
+            const idx = readVarint(payload, position);
+            const distance = instance.transitionMatrix[prev][idx];
+            travel_time += distance;
+            demand += instance.demands == undefined ? 0 : instance.demands[idx];
+            time += distance;
+            if (hasTimeWindows)
+                time = Math.max(time, instance.ready_times![idx]);
+            const start_time = time;
+            time += hasTimeWindows ? instance.service_times![idx] : 1;
+            path.push({ idx: idx, start_time: start_time, end_time: time });
+            prev = idx;
+        }
+        travel_time += instance.transitionMatrix[prev][0];
+        time += instance.transitionMatrix[prev][0];
+        path.push({ idx: 0, start_time: time, end_time: isTsp ? time + 1 : time });
+        routes.push({ travel_time: travel_time, demand: demand, end_time: time, route_nodes: path });
+        travel_time_sum += travel_time;
+        end_time_sum += time;
+    }
+    assert(position.offset == payload.length, "Unexpected data after the solution in a frame");
+    return { travel_time_sum: travel_time_sum, end_time_sum: end_time_sum, objective: objective, routes: routes };
+}
+
+/** Splits the byte stream from the heuristics into frame payloads */
+export class SolutionFrameReader {
+    private buffer: Buffer = Buffer.alloc(0);
+
+    push(chunk: Buffer): Buffer[] {
+        this.buffer = this.buffer.length == 0 ? chunk : Buffer.concat([this.buffer, chunk]);
+        let payloads: Buffer[] = [];
+        let offset = 0;
+        while (this.buffer.length - offset >= 4) {
+            const size = this.buffer.readUInt32LE(offset);
+            if (this.buffer.length - offset - 4 < size)
+                break;
+            payloads.push(this.buffer.subarray(offset + 4, offset + 4 + size));
+            offset += 4 + size;
+        }
+        this.buffer = this.buffer.subarray(offset);
+        return payloads;
+    }
 }
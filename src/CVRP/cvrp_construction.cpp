@@ -0,0 +1,41 @@
+#include "CVRP/cvrp_construction.h"
+
+CvrpConstruction::CvrpConstruction(
+    const std::shared_ptr<RoutingInstance> &instance, ConstructionAlgorithm algorithm, uint solution_count) {
+  instance_ = instance;
+  portfolio_ = nullptr;
+  terminate_ = false;
+  algorithm_ = algorithm;
+  solution_count_ = solution_count;
+  built_count_ = 0;
+}
+
+void CvrpConstruction::initialize(HeuristicPortfolio *portfolio) {
+  portfolio_ = portfolio;
+  terminate_ = false;
+}
+
+bool CvrpConstruction::startUnits() {
+  built_count_ = 0;
+  return true;
+}
+
+bool CvrpConstruction::runUnit() {
+  if(built_count_ >= solution_count_ || terminate_)
+    return false;
+  auto individual = std::make_shared<CvrpIndividualStructured>(instance_.get());
+  if(algorithm_ == RANDOM_CONSTRUCTION)
+    individual->initialize();
+  else if(!individual->nearestNeighborInitialize([this]() -> bool {return terminate_;}))
+    return false;
+  individual->evaluate();
+  portfolio_->addStartingSolution(individual->convertSolution());
+  built_count_++;
+  return built_count_ < solution_count_;
+}
+
+void CvrpConstruction::terminate() {
+  terminate_.store(true);
+}
+
+void CvrpConstruction::acceptSolution(std::shared_ptr<Solution>) {}
@@ -39,6 +39,7 @@ void CvrpExhaustiveLocalSearch::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<CvrpIndividualStructured>(individual);
     auto solution = individual_->convertSolution();
@@ -60,11 +61,20 @@ void CvrpExhaustiveLocalSearch::acceptSolution(
   }
 }
 
-void CvrpExhaustiveLocalSearch::run() {
-  auto initialSolution = std::make_shared<CvrpIndividualStructured>(instance_.get());
-  initialSolution->smartInitialize();
+bool CvrpExhaustiveLocalSearch::startUnits() {
+  auto starting_solution = portfolio_->takeStartingSolution();
+  auto initialSolution = starting_solution != nullptr ?
+      std::make_shared<CvrpIndividualStructured>(instance_.get(), starting_solution) :
+      std::make_shared<CvrpIndividualStructured>(instance_.get());
+  if(starting_solution == nullptr)
+    initialSolution->smartInitialize();
   initialSolution->evaluate();
   auto solution = initialSolution->convertSolution();
   portfolio_->acceptSolution(solution);
-  local_search_->run(initialSolution);
+  local_search_->start(initialSolution);
+  return true;
+}
+
+bool CvrpExhaustiveLocalSearch::runUnit() {
+  return local_search_->step();
 }
@@ -3,11 +3,11 @@
 #include <limits>
 
 CvrpIndividual::CvrpIndividual(const RoutingInstance *const instance) :
- instance_(instance), matrix_(instance->getMatrix().get()), data_(), is_evaluated_(false),
+ instance_(instance), data_(), is_evaluated_(false),
   fitness_(std::numeric_limits<double>::max()), capacity_constraint_violation_(0){}
 
 CvrpIndividual::CvrpIndividual(const CvrpIndividual &other) :
-instance_(other.instance_), matrix_(other.matrix_), data_(other.data_), is_evaluated_(other.is_evaluated_),
+instance_(other.instance_), data_(other.data_), is_evaluated_(other.is_evaluated_),
   fitness_(other.fitness_), capacity_constraint_violation_(other.capacity_constraint_violation_){}
 
 void CvrpIndividual::initialize() {
@@ -64,25 +64,27 @@ bool CvrpIndividual::isEvaluated() {
 }
 
 void CvrpIndividual::calculateConstraints() {
-  const auto &nodes = instance_->getNodes();
-  uint first_vehicle_start = data_.size();
-  uint i = 0;
+  const uint *demands = instance_->getDemands();
+  const uint nodes_count = instance_->getNodesCount();
+  const int capacity = instance_->getVehicleCapacity();
+  // customers in front of the first depot belong to the route wrapping around the end of data_
+  uint first_vehicle_start = 0;
+  uint wrapped_demand = 0;
+  while(first_vehicle_start < data_.size() && data_[first_vehicle_start] != 0 && data_[first_vehicle_start] < nodes_count)
+    wrapped_demand += demands[data_[first_vehicle_start++]];
   uint demand_running_sum = 0;
   uint demand_violation = 0;
-  while(i != first_vehicle_start){
-    const uint node = data_[i] >= (uint)instance_->getNodesCount() ? 0 : data_[i];
-    if(node == 0){
-      if(first_vehicle_start == data_.size()){
-        first_vehicle_start = i;
-        demand_running_sum = 0;
-      }
-      demand_violation += std::max((int)demand_running_sum - instance_->getVehicleCapacity(), 0);
+  for(uint i = first_vehicle_start + 1; i < data_.size(); i++){
+    const uint node = data_[i];
+    if(node == 0 || node >= nodes_count){
+      demand_violation += std::max((int)demand_running_sum - capacity, 0);
       demand_running_sum = 0;
     }
-    demand_running_sum += nodes[node].demand;
-    i = (i + 1) % data_.size();
+    else{
+      demand_running_sum += demands[node];
+    }
   }
-  demand_violation += std::max((int)demand_running_sum - instance_->getVehicleCapacity(), 0);
+  demand_violation += std::max((int)(demand_running_sum + wrapped_demand) - capacity, 0);
   capacity_constraint_violation_ = demand_violation;
 }
 const std::vector<double> &CvrpIndividual::getConstraintViolations() {
@@ -127,7 +129,7 @@ CvrpIndividual::CvrpIndividual(const RoutingInstance *const instance,
     data_[i] = depot_alias;
     i++;
     depot_alias++;
-    for(const auto &node: route.route_nodes){
+    for(const auto &node: solution->routeNodes(route)){
       if(node.idx == 0) //skip depots
         continue;
       data_[i] = node.idx;
@@ -155,13 +157,15 @@ std::shared_ptr<Solution> CvrpIndividual::convertSolution() {
   solution->end_time_sum = 0;
   solution->objective = 0;
 
+  solution->reserve(instance_->getVehicleCount(), data_.size() + instance_->getVehicleCount());
+
   //initialize first route
-  solution->routes.emplace_back();
+  solution->addRoute();
   SolutionNode first_node;
   first_node.idx = 0;
   first_node.start_time = 0;
   first_node.end_time = 0;
-  solution->routes.back().route_nodes.push_back(first_node);
+  solution->addNode(first_node);
 
   uint i = (zero_idx + 1) % data_.size();
   uint prev_node = 0;
@@ -182,7 +186,7 @@ std::shared_ptr<Solution> CvrpIndividual::convertSolution() {
     node.start_time = time;
     time++;
     node.end_time = time;
-    solution->routes.back().route_nodes.push_back(node);
+    solution->addNode(node);
 
     if(cur_node == 0){ // end of route
       time--;
@@ -190,15 +194,15 @@ std::shared_ptr<Solution> CvrpIndividual::convertSolution() {
       solution->routes.back().end_time = time;
       solution->routes.back().travel_time = travel_time;
       solution->routes.back().demand = demand;
-      solution->routes.back().route_nodes.back().end_time = time;
+      solution->nodes.back().end_time = time;
 
       // add costs to solution costs
       solution->end_time_sum += time;
       solution->travel_time_sum += travel_time;
 
       // initialize next route
-      solution->routes.emplace_back();
-      solution->routes.back().route_nodes.push_back(first_node);
+      solution->addRoute();
+      solution->addNode(first_node);
 
       //reset running sums
       time = 0;
@@ -220,7 +224,7 @@ std::shared_ptr<Solution> CvrpIndividual::convertSolution() {
   node.idx = 0;
   node.start_time = time;
   node.end_time = time;
-  solution->routes.back().route_nodes.push_back(node);
+  solution->addNode(node);
   // finish route
   solution->routes.back().travel_time = travel_time;
   solution->routes.back().demand = demand;
@@ -1,7 +1,8 @@
 #include "CVRP/cvrp_neighborhood.h"
+#include <algorithm>
 #include <cassert>
 
-CvrpNeighborhood::CvrpNeighborhood() : rand_(), gen_(rand_()), dist_(0.0, 1.0) {
+CvrpNeighborhood::CvrpNeighborhood() : rand_(), gen_(rand_()), dist_(0.0, 1.0), instance_(nullptr), candidate_count_(0), partner_count_(0) {
   for(int i = 0; i < neighborhood_options::SIZE; i++){
     exhausted_[i] = false;
     try_count[i] = 1;
@@ -9,6 +10,27 @@ CvrpNeighborhood::CvrpNeighborhood() : rand_(), gen_(rand_()), dist_(0.0, 1.0) {
   }
 }
 
+CvrpNeighborhood::CvrpNeighborhood(
+    const std::shared_ptr<RoutingInstance> &instance, uint candidate_count) : CvrpNeighborhood() {
+  instance_ = instance;
+  candidate_count_ = std::min(candidate_count, instance->getCandidateCount());
+  partner_count_ = candidate_count_;
+  if(candidate_count_ == 0){
+    all_nodes_ = std::vector<uint>(instance->getNodesCount());
+    for(uint i = 0; i < all_nodes_.size(); i++)
+      all_nodes_[i] = i;
+    partner_count_ = all_nodes_.size();
+  }
+  route_of_ = std::vector<int>(instance->getNodesCount(), -1);
+  position_of_ = std::vector<int>(instance->getNodesCount(), -1);
+  for(auto &is_active : is_active_)
+    is_active = std::vector<bool>(instance->getNodesCount(), false);
+}
+
+void CvrpNeighborhood::setRoutePruning(const RoutingInstance &instance, double tolerance_degrees) {
+  sectors_.initialize(instance, tolerance_degrees);
+}
+
 CvrpNeighborhood::neighborhood_options
 CvrpNeighborhood::selectNeighborhoodOption() {
   double max_val = 0;
@@ -80,10 +102,18 @@ void CvrpNeighborhood::failure(
 void CvrpNeighborhood::reset(const std::shared_ptr<Individual> &individual) {
   for(int i = 0; i < neighborhood_options::SIZE; i++)
     exhausted_[i] = false;
+
+  if(instance_ == nullptr)
+    return;
+  const auto &individual_ = std::static_pointer_cast<CvrpIndividualStructured>(individual);
+  for(uint r = 0; r < individual_->getRoutes().size(); r++)
+    updateRoute(individual_, r);
 }
 
 bool CvrpNeighborhood::perform2opt(
     const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  if(instance_ != nullptr)
+    return perform2optGranular(individual);
   bool performed = false;
 
   const auto &routes = individual->getRoutes();
@@ -108,16 +138,21 @@ bool CvrpNeighborhood::perform2opt(
 
 bool CvrpNeighborhood::performExchange(
     const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  if(instance_ != nullptr)
+    return performExchangeGranular(individual);
   bool performed = false;
   const auto &routes = individual->getRoutes();
   CvrpRouteSegment segment1{}, segment2{};
   segment1.segment_length = 1;
   segment2.segment_length = 1;
 
+  updateSectors(individual);
   // Each pair of routes
   for(uint r1 = 0; r1 < routes.size() - 1; r1++){
     segment1.route_idx = r1;
     for(uint r2 = r1+1; r2 < routes.size(); r2++){
+      if(!sectors_.overlap(r1, r2))
+        continue;
       segment2.route_idx = r2;
       //Each pair of customers
       for(uint c1 = 0; c1 < routes[r1].customers.size(); c1++){
@@ -127,6 +162,8 @@ bool CvrpNeighborhood::performExchange(
           //try the exchange
           if(individual->testExchangeMove(segment1, segment2)){
             individual->performExchangeMove(segment1, segment2);
+            sectors_.update(r1, routes[r1].customers);
+            sectors_.update(r2, routes[r2].customers);
             performed = true;
           }
         }
@@ -139,17 +176,22 @@ bool CvrpNeighborhood::performExchange(
 
 bool CvrpNeighborhood::performRelocate(
     const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  if(instance_ != nullptr)
+    return performRelocateGranular(individual);
   bool performed = false;
   const auto &routes = individual->getRoutes();
   CvrpRouteSegment segment_move{}, target_pos{};
   segment_move.segment_length = 1;
   target_pos.segment_length = 0;
 
+  updateSectors(individual);
   for(uint r_from = 0; r_from < routes.size(); r_from++){
     segment_move.route_idx = r_from;
     for(uint r_to = 0; r_to < routes.size(); r_to++){
       if(r_from == r_to) // Relocation within route is not possible with this operator
         continue;
+      if(!sectors_.overlap(r_from, r_to))
+        continue;
       target_pos.route_idx = r_to;
 
       for(uint c1 = 0; c1 < routes[r_from].customers.size(); c1++){
@@ -159,6 +201,8 @@ bool CvrpNeighborhood::performRelocate(
           target_pos.segment_start_idx = c2;
           if(individual->testRelocateMove(segment_move, target_pos)){
             individual->performRelocateMove(segment_move, target_pos);
+            sectors_.update(r_from, routes[r_from].customers);
+            sectors_.update(r_to, routes[r_to].customers);
             performed = true;
             performed_for_customer = true;
             break; //c1 customer will change
@@ -175,16 +219,21 @@ bool CvrpNeighborhood::performRelocate(
 
 bool CvrpNeighborhood::performCross(
     const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  if(instance_ != nullptr)
+    return performCrossGranular(individual);
   bool performed = false;
   const auto &routes = individual->getRoutes();
   CvrpRouteSegment segment1{}, segment2{};
   segment1.segment_length = 0;
   segment2.segment_length = 0;
 
+  updateSectors(individual);
   // Each pair of routes
   for(uint r1 = 0; r1 < routes.size() - 1; r1++){
     segment1.route_idx = r1;
     for(uint r2 = r1 + 1; r2 < routes.size(); r2++){
+      if(!sectors_.overlap(r1, r2))
+        continue;
       segment2.route_idx = r2;
       //Each pair of customers
       for(uint c1 = 0; c1 <= routes[r1].customers.size(); c1++){
@@ -195,6 +244,8 @@ bool CvrpNeighborhood::performCross(
           //try the exchange
           if(individual->testCrossMove(segment1, segment2)){
             individual->performCrossMove(segment1, segment2);
+            sectors_.update(r1, routes[r1].customers);
+            sectors_.update(r2, routes[r2].customers);
             performed = true;
             performed_for_customer = true;
             break; //c1 customer will change
@@ -208,3 +259,204 @@ bool CvrpNeighborhood::performCross(
 
   return performed;
 }
+
+void CvrpNeighborhood::updateRoute(
+    const std::shared_ptr<CvrpIndividualStructured> &individual,
+    uint route_idx) {
+  const auto &customers = individual->getRoutes()[route_idx].customers;
+  sectors_.update(route_idx, customers);
+  for(uint c = 0; c < customers.size(); c++){
+    const uint customer = customers[c].idx;
+    route_of_[customer] = (int)route_idx;
+    position_of_[customer] = (int)c;
+    for(int o = 0; o < neighborhood_options::SIZE; o++){
+      if(!is_active_[o][customer]){
+        is_active_[o][customer] = true;
+        active_nodes_[o].push_back(customer);
+      }
+    }
+  }
+}
+
+void CvrpNeighborhood::updateSectors(
+    const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  if(!sectors_.isEnabled())
+    return;
+  const auto &routes = individual->getRoutes();
+  for(uint r = 0; r < routes.size(); r++)
+    sectors_.update(r, routes[r].customers);
+}
+
+bool CvrpNeighborhood::popActiveNode(
+    CvrpNeighborhood::neighborhood_options option, uint &node) {
+  if(active_nodes_[option].empty())
+    return false;
+  node = active_nodes_[option].front();
+  active_nodes_[option].pop_front();
+  is_active_[option][node] = false;
+  return true;
+}
+
+const uint *CvrpNeighborhood::getPartners(uint node) const {
+  return candidate_count_ > 0 ? instance_->getCandidates(node) : all_nodes_.data();
+}
+
+bool CvrpNeighborhood::try2optMove(
+    const std::shared_ptr<CvrpIndividualStructured> &individual,
+    uint route_idx, int start, int end) {
+  if(start < 0 || start >= end || end >= (int)individual->getRoutes()[route_idx].customers.size())
+    return false;
+  CvrpRouteSegment segment{route_idx, (uint)start, (uint)(end - start + 1)};
+  if(!individual->test2optMove(segment))
+    return false;
+  individual->perform2optMove(segment);
+  updateRoute(individual, route_idx);
+  return true;
+}
+
+bool CvrpNeighborhood::perform2optGranular(
+    const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  bool performed = false;
+  const auto &routes = individual->getRoutes();
+  uint node;
+  // one sweep over the nodes active at the start, nodes activated meanwhile wait for the next call
+  for(size_t sweep = active_nodes_[neighborhood_options::TWO_OPT].size(); sweep > 0 && popActiveNode(neighborhood_options::TWO_OPT, node); sweep--){
+    const uint r = route_of_[node];
+    const int i = position_of_[node];
+    const int size = (int)routes[r].customers.size();
+    const uint *partners = getPartners(node);
+    for(uint k = 0; k < partner_count_; k++){
+      const uint partner = partners[k];
+      if(partner == node || (partner != 0 && route_of_[partner] != (int)r))
+        continue;
+      // new edge customer-partner replacing the edges to their successors
+      const int j_succ = partner == 0 ? -1 : position_of_[partner];
+      if(try2optMove(individual, r, std::min(i, j_succ) + 1, std::max(i, j_succ))){
+        performed = true;
+        break; // route of the customer changed, it was activated again
+      }
+      // new edge customer-partner replacing the edges to their predecessors
+      const int j_pred = partner == 0 ? size : position_of_[partner];
+      if(try2optMove(individual, r, std::min(i, j_pred), std::max(i, j_pred) - 1)){
+        performed = true;
+        break;
+      }
+    }
+  }
+  return performed;
+}
+
+bool CvrpNeighborhood::performExchangeGranular(
+    const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  bool performed = false;
+  const auto &routes = individual->getRoutes();
+  CvrpRouteSegment segment1{}, segment2{};
+  segment1.segment_length = 1;
+  segment2.segment_length = 1;
+  uint node;
+  for(size_t sweep = active_nodes_[neighborhood_options::EXCHANGE].size(); sweep > 0 && popActiveNode(neighborhood_options::EXCHANGE, node); sweep--){
+    const uint r1 = route_of_[node];
+    segment1.route_idx = r1;
+    segment1.segment_start_idx = position_of_[node];
+    const uint *partners = getPartners(node);
+    bool performed_for_customer = false;
+    for(uint k = 0; k < partner_count_ && !performed_for_customer; k++){
+      const uint partner = partners[k];
+      if(partner == 0 || route_of_[partner] == (int)r1 || !sectors_.overlap(r1, route_of_[partner]))
+        continue;
+      // exchange customer with a route neighbor of the partner
+      const uint r2 = route_of_[partner];
+      segment2.route_idx = r2;
+      const int targets[2] = {position_of_[partner] - 1, position_of_[partner] + 1};
+      for(const int target : targets){
+        if(target < 0 || target >= (int)routes[r2].customers.size())
+          continue;
+        segment2.segment_start_idx = target;
+        if(individual->testExchangeMove(segment1, segment2)){
+          individual->performExchangeMove(segment1, segment2);
+          updateRoute(individual, r1);
+          updateRoute(individual, r2);
+          performed = true;
+          performed_for_customer = true;
+          break;
+        }
+      }
+    }
+  }
+  return performed;
+}
+
+bool CvrpNeighborhood::performRelocateGranular(
+    const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  bool performed = false;
+  CvrpRouteSegment segment_move{}, target_pos{};
+  segment_move.segment_length = 1;
+  target_pos.segment_length = 0;
+  uint node;
+  for(size_t sweep = active_nodes_[neighborhood_options::RELOCATE].size(); sweep > 0 && popActiveNode(neighborhood_options::RELOCATE, node); sweep--){
+    const uint r_from = route_of_[node];
+    segment_move.route_idx = r_from;
+    segment_move.segment_start_idx = position_of_[node];
+    const uint *partners = getPartners(node);
+    bool performed_for_customer = false;
+    for(uint k = 0; k < partner_count_ && !performed_for_customer; k++){
+      const uint partner = partners[k];
+      if(partner == 0 || route_of_[partner] == (int)r_from || !sectors_.overlap(r_from, route_of_[partner]))
+        continue;
+      // insert customer directly before or directly after the partner
+      target_pos.route_idx = route_of_[partner];
+      const int targets[2] = {position_of_[partner], position_of_[partner] + 1};
+      for(const int target : targets){
+        target_pos.segment_start_idx = target;
+        if(individual->testRelocateMove(segment_move, target_pos)){
+          individual->performRelocateMove(segment_move, target_pos);
+          updateRoute(individual, r_from);
+          updateRoute(individual, target_pos.route_idx);
+          performed = true;
+          performed_for_customer = true;
+          break;
+        }
+      }
+    }
+  }
+  return performed;
+}
+
+bool CvrpNeighborhood::performCrossGranular(
+    const std::shared_ptr<CvrpIndividualStructured> &individual) {
+  bool performed = false;
+  CvrpRouteSegment segment1{}, segment2{};
+  segment1.segment_length = 0;
+  segment2.segment_length = 0;
+  uint node;
+  for(size_t sweep = active_nodes_[neighborhood_options::CROSS].size(); sweep > 0 && popActiveNode(neighborhood_options::CROSS, node); sweep--){
+    const uint r1 = route_of_[node];
+    const uint c1 = position_of_[node];
+    segment1.route_idx = r1;
+    const uint *partners = getPartners(node);
+    bool performed_for_customer = false;
+    for(uint k = 0; k < partner_count_ && !performed_for_customer; k++){
+      const uint partner = partners[k];
+      if(partner == 0 || route_of_[partner] == (int)r1 || !sectors_.overlap(r1, route_of_[partner]))
+        continue;
+      // exchange route ends so that the customer is followed by the partner or the other way round
+      const uint r2 = route_of_[partner];
+      segment2.route_idx = r2;
+      const uint c2 = position_of_[partner];
+      const std::pair<uint, uint> starts[2] = {{c1 + 1, c2}, {c1, c2 + 1}};
+      for(const auto &start : starts){
+        segment1.segment_start_idx = start.first;
+        segment2.segment_start_idx = start.second;
+        if(individual->testCrossMove(segment1, segment2)){
+          individual->performCrossMove(segment1, segment2);
+          updateRoute(individual, r1);
+          updateRoute(individual, r2);
+          performed = true;
+          performed_for_customer = true;
+          break;
+        }
+      }
+    }
+  }
+  return performed;
+}
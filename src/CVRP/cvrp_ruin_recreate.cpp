@@ -0,0 +1,82 @@
+#include "CVRP/cvrp_ruin_recreate.h"
+#include <iostream>
+
+CvrpRuinRecreateOperators::CvrpRuinRecreateOperators(
+    const RoutingInstance *instance, const RuinRecreateParameters &parameters) :
+  RoutingRuinRecreateOperators(instance, parameters.vehicle_cost, parameters.violation_cost) {}
+
+double CvrpRuinRecreateOperators::getCost(Individual &individual) {
+  auto &individual_ = static_cast<CvrpIndividualStructured &>(individual);
+  return individual_.getFitness() + violation_cost_ * individual_.getTotalConstraintViolation();
+}
+
+CvrpRuinRecreate::CvrpRuinRecreate(
+    const std::shared_ptr<RoutingInstance> &instance, const RuinRecreateConfig &config) : parameters_(config.getParameters()) {
+  instance_ = instance;
+  best_solution_ = nullptr;
+  portfolio_ = nullptr;
+  terminate_ = false;
+}
+
+void CvrpRuinRecreate::sendSolution(const std::shared_ptr<Solution> &solution) {
+  if(solution == nullptr || portfolio_ == nullptr)
+    return;
+  portfolio_->acceptSolution(solution);
+}
+
+bool CvrpRuinRecreate::checkBetterSolution(
+    const std::shared_ptr<Solution> &solution) {
+  if(solution->objective < 0) { // integer overflow
+    std::cerr << "Integer overflow encountered in CVRP ruin and recreate solution value" << std::endl;
+    return false;
+  }
+  std::lock_guard<std::recursive_mutex> lock(solution_mutex_);
+  if(best_solution_ == nullptr || solution->betterThan(*best_solution_)){
+    best_solution_ = solution;
+    return true;
+  }
+  return false;
+}
+
+void CvrpRuinRecreate::initialize(HeuristicPortfolio *portfolio) {
+  portfolio_ = portfolio;
+  terminate_ = false;
+  std::shared_ptr<Callbacks> callbacks = std::make_shared<Callbacks>();
+  callbacks->setTerminationCondition([this]() -> bool {
+    return terminate_;
+  });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
+  callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
+    sendSolution(std::static_pointer_cast<CvrpIndividualStructured>(individual)->convertSolution());
+  });
+  auto operators = std::make_shared<CvrpRuinRecreateOperators>(instance_.get(), parameters_);
+  ruin_recreate_ = std::make_shared<RuinRecreate>(callbacks, operators, parameters_);
+}
+
+bool CvrpRuinRecreate::startUnits() {
+  auto starting_solution = portfolio_->takeStartingSolution();
+  auto initial_solution = starting_solution != nullptr ?
+      std::make_shared<CvrpIndividualStructured>(instance_.get(), starting_solution) :
+      std::make_shared<CvrpIndividualStructured>(instance_.get());
+  if(starting_solution == nullptr)
+    initial_solution->smartInitialize();
+  initial_solution->evaluate();
+  portfolio_->acceptSolution(initial_solution->convertSolution());
+  ruin_recreate_->start(initial_solution);
+  return true;
+}
+
+bool CvrpRuinRecreate::runUnit() {
+  return ruin_recreate_->step();
+}
+
+void CvrpRuinRecreate::terminate() {
+  terminate_.store(true);
+}
+
+void CvrpRuinRecreate::acceptSolution(std::shared_ptr<Solution> solution) {
+  if(checkBetterSolution(solution)){
+    auto individual = std::make_shared<CvrpIndividualStructured>(instance_.get(), solution);
+    ruin_recreate_->acceptOutsideSolution(individual);
+  }
+}
@@ -5,15 +5,17 @@
 CvrpSimulatedAnnealing::CvrpSimulatedAnnealing(
     const std::shared_ptr<RoutingInstance> &instance,
     const std::shared_ptr<SAStep> &step,
-    const std::shared_ptr<SASchedule> schedule) {
+    const std::shared_ptr<SASchedule> schedule,
+    uint steps_per_unit) {
   instance_ = instance;
   step_ = step;
   schedule_ = schedule;
+  steps_per_unit_ = steps_per_unit;
   best_solution_ = nullptr;
   terminate_ = false;
   simulated_annealing_ = nullptr;
   portfolio_ = nullptr;
-  assert(instance != nullptr && step != nullptr && schedule != nullptr);
+  assert(instance != nullptr && step != nullptr && schedule != nullptr && steps_per_unit > 0);
 }
 
 void CvrpSimulatedAnnealing::sendSolution(
@@ -23,7 +25,7 @@ void CvrpSimulatedAnnealing::sendSolution(
 
   uint count = 0;
   for(const auto &r: solution->routes){
-    if(r.route_nodes.size() > 2)
+    if(r.node_count > 2)
       count++;
   }
 
@@ -51,6 +53,7 @@ void CvrpSimulatedAnnealing::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<CvrpIndividualStructured>(individual);
     auto solution = individual_->convertSolution();
@@ -60,13 +63,26 @@ void CvrpSimulatedAnnealing::initialize(HeuristicPortfolio *portfolio) {
   simulated_annealing_ = std::make_shared<SimulatedAnnealing>(callbacks, step_, schedule_);
 }
 
-void CvrpSimulatedAnnealing::run() {
-  auto initialSolution = std::make_shared<CvrpIndividualStructured>(instance_.get());
-  initialSolution->smartInitialize();
+bool CvrpSimulatedAnnealing::startUnits() {
+  auto starting_solution = portfolio_->takeStartingSolution();
+  auto initialSolution = starting_solution != nullptr ?
+      std::make_shared<CvrpIndividualStructured>(instance_.get(), starting_solution) :
+      std::make_shared<CvrpIndividualStructured>(instance_.get());
+  if(starting_solution == nullptr)
+    initialSolution->smartInitialize();
   initialSolution->evaluate();
   auto solution = initialSolution->convertSolution();
   portfolio_->acceptSolution(solution);
-  simulated_annealing_->run(initialSolution);
+  simulated_annealing_->start(initialSolution);
+  return true;
+}
+
+bool CvrpSimulatedAnnealing::runUnit() {
+  for(uint i = 0; i < steps_per_unit_; i++){
+    if(!simulated_annealing_->step())
+      return false;
+  }
+  return true;
 }
 
 void CvrpSimulatedAnnealing::terminate() {
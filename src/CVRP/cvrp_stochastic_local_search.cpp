@@ -9,7 +9,6 @@ CvrpStochasticLocalSearch::CvrpStochasticLocalSearch(
   instance_ = instance;
   best_solution_ = nullptr;
   terminate_ = false;
-  matrix_ = instance->getMatrix().get();
   local_search_ = nullptr;
   mutation_ = mutation;
 }
@@ -28,6 +27,7 @@ void CvrpStochasticLocalSearch::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<CvrpIndividual>(individual);
     auto solution = individual_->convertSolution();
@@ -62,7 +62,7 @@ bool CvrpStochasticLocalSearch::checkBetterSolution(
   return false;
 }
 
-void CvrpStochasticLocalSearch::run(){
+bool CvrpStochasticLocalSearch::startUnits() {
   std::random_device rand;
   std::mt19937 gen(rand());
   auto initialSolution = std::make_shared<CvrpIndividual>(instance_.get());
@@ -72,5 +72,10 @@ void CvrpStochasticLocalSearch::run(){
   initialSolution->evaluate();
   auto solution = initialSolution->convertSolution();
   portfolio_->acceptSolution(solution);
-  local_search_->run(initialSolution);
+  local_search_->start(initialSolution);
+  return true;
+}
+
+bool CvrpStochasticLocalSearch::runUnit() {
+  return local_search_->step();
 }
\ No newline at end of file
@@ -9,7 +9,6 @@ CvrpStochasticRanking::CvrpStochasticRanking(
   instance_ = instance;
   best_solution_ = nullptr;
   terminate_ = false;
-  matrix_ = instance->getMatrix().get();
   stochastic_ranking_ = nullptr;
   mutation_ = mutation;
   crossover_ = crossover;
@@ -18,7 +17,7 @@ CvrpStochasticRanking::CvrpStochasticRanking(
   fitness_comp_prob_ = fitness_comp_prob;
 }
 
-void CvrpStochasticRanking::run() {
+bool CvrpStochasticRanking::startUnits() {
   std::random_device rand;
   std::mt19937 gen(rand());
 
@@ -40,7 +39,12 @@ void CvrpStochasticRanking::run() {
   }
 
   assert(stochastic_ranking_ != nullptr);
-  stochastic_ranking_->run(initial_population);
+  stochastic_ranking_->start(initial_population);
+  return true;
+}
+
+bool CvrpStochasticRanking::runUnit() {
+  return stochastic_ranking_->step();
 }
 
 void CvrpStochasticRanking::initialize(HeuristicPortfolio *portfolio) {
@@ -50,6 +54,7 @@ void CvrpStochasticRanking::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<CvrpIndividual>(individual);
     auto solution = individual_->convertSolution();
@@ -1,5 +1,6 @@
 #include "CVRP/cvrp_structured_individual.h"
 #include <cassert>
+#include <limits>
 #include <random>
 #include <algorithm>
 
@@ -8,22 +9,22 @@ CvrpIndividualStructured::CvrpIndividualStructured(
 CvrpIndividualStructured::CvrpIndividualStructured(
     const RoutingInstance *const instance,
     const std::shared_ptr<Solution> &solution) : instance_(instance), routes_(instance->getVehicleCount()), total_time_(0), demand_violation_(1, 0), is_evaluated_(false) {
-  const auto &nodes = instance->getNodes();
+  const uint *demands = instance->getDemands();
   uint r = 0;
   for(const auto &route: solution->routes){
     routes_[r].time = route.travel_time;
     routes_[r].demand = route.demand;
-    routes_[r].customers.reserve(route.route_nodes.size() - 2);
+    routes_[r].customers.reserve(route.node_count - 2);
 
     uint time = 0;
     uint demand = 0;
     uint prev_node = 0;
-    for(const auto customer: route.route_nodes){
+    for(const auto customer: solution->routeNodes(route)){
       if(customer.idx == 0){
         continue;
       }
       time += instance->getDistance(prev_node, customer.idx);
-      demand += nodes[customer.idx].demand;
+      demand += demands[customer.idx];
       routes_[r].customers.emplace_back(customer.idx, time, demand);
       prev_node = customer.idx;
     }
@@ -46,7 +47,7 @@ CvrpIndividualStructured::CvrpIndividualStructured(
     const CvrpIndividualStructured &cpy, const std::vector<uint> &flat_data) : instance_(cpy.instance_), routes_(instance_->getVehicleCount()), total_time_(0), demand_violation_(1, 0), is_evaluated_(false) {
   uint i = 0;
   total_time_ = 0;
-  const auto &nodes = instance_->getNodes();
+  const uint *demands = instance_->getDemands();
   for(auto & route : routes_){
     route.demand = 0;
     route.time = 0;
@@ -54,7 +55,7 @@ CvrpIndividualStructured::CvrpIndividualStructured(
     route.customers = std::vector<CvrpIndividualCustomer>();
     while(flat_data[i] < instance_->getNodesCount()){
       uint cur_node = flat_data[i];
-      route.demand += nodes[cur_node].demand;
+      route.demand += demands[cur_node];
       route.time += instance_->getDistance(prev_node, cur_node);
       route.customers.emplace_back(cur_node, route.time, route.demand);
       prev_node = cur_node;
@@ -71,7 +72,7 @@ CvrpIndividualStructured::CvrpIndividualStructured(
 
 void CvrpIndividualStructured::initialize() {
   routes_ = std::vector<CvrpIndividualRoute>(instance_->getVehicleCount());
-  const auto &nodes = instance_->getNodes();
+  const uint *demands = instance_->getDemands();
 
   // randomly shuffle customers
   std::random_device rand;
@@ -89,9 +90,9 @@ void CvrpIndividualStructured::initialize() {
     for(uint c = first_unassigned_customer; c < customers.size(); c++){
       if(customers[c] == 0)
         continue; //already assigned
-      if(routes_[r].demand + nodes[customers[c]].demand > (uint)instance_->getVehicleCapacity() && (uint)r != routes_.size() - 1)
+      if(routes_[r].demand + demands[customers[c]] > (uint)instance_->getVehicleCapacity() && (uint)r != routes_.size() - 1)
         continue; //violates constraints and is not the last vehicle
-      routes_[r].demand += nodes[customers[c]].demand;
+      routes_[r].demand += demands[customers[c]];
       uint prev_node = routes_[r].customers.empty() ? 0 : routes_[r].customers.back().idx;
       routes_[r].time += instance_->getDistance(prev_node, customers[c]);
       routes_[r].customers.emplace_back(customers[c], routes_[r].time, routes_[r].demand);
@@ -113,6 +114,65 @@ void CvrpIndividualStructured::initialize() {
   is_evaluated_ = true;
 }
 
+bool CvrpIndividualStructured::nearestNeighborInitialize(const std::function<bool()> &should_terminate) {
+  routes_ = std::vector<CvrpIndividualRoute>(instance_->getVehicleCount());
+  const uint *demands = instance_->getDemands();
+  const uint nodes_count = instance_->getNodesCount();
+  const uint capacity = instance_->getVehicleCapacity();
+
+  std::random_device rand;
+  std::mt19937 gen(rand());
+  std::uniform_int_distribution<uint> dist(1, nodes_count - 1);
+  std::vector<bool> served(nodes_count, false);
+  served[0] = true;
+  uint unserved_count = nodes_count - 1;
+
+  for(uint r = 0; r < routes_.size() && unserved_count > 0; r++){
+    auto &route = routes_[r];
+    const bool last_route = r == routes_.size() - 1;
+    // a random first customer diversifies the constructed solutions
+    uint next_node = dist(gen);
+    while(served[next_node])
+      next_node = next_node % (nodes_count - 1) + 1;
+    uint prev_node = 0;
+    while(next_node != 0){
+      if(should_terminate()){
+        initialize();
+        return false;
+      }
+      served[next_node] = true;
+      unserved_count--;
+      route.demand += demands[next_node];
+      route.time += instance_->getDistance(prev_node, next_node);
+      route.customers.emplace_back(next_node, route.time, route.demand);
+      prev_node = next_node;
+
+      next_node = 0;
+      uint best_distance = std::numeric_limits<uint>::max();
+      const uint *row = instance_->getDistanceRow(prev_node);
+      for(uint c = 1; c < nodes_count && unserved_count > 0; c++){
+        if(served[c] || (!last_route && route.demand + demands[c] > capacity))
+          continue;
+        const uint distance = row != nullptr ? row[c] : instance_->getDistance(prev_node, c);
+        if(distance < best_distance){
+          best_distance = distance;
+          next_node = c;
+        }
+      }
+    }
+    route.time += instance_->getDistance(prev_node, 0);
+  }
+
+  demand_violation_[0] = 0;
+  total_time_ = 0;
+  for(auto & route : routes_){
+    total_time_ += route.time;
+    demand_violation_[0] += std::max(0, (int)route.demand - instance_->getVehicleCapacity());
+  }
+  is_evaluated_ = true;
+  return true;
+}
+
 void CvrpIndividualStructured::resetEvaluated() {
   is_evaluated_ = false;
 }
@@ -155,7 +215,7 @@ void CvrpIndividualStructured::evaluate() {
   if(is_evaluated_)
     return;
 
-  const auto &nodes = instance_->getNodes();
+  const uint *demands = instance_->getDemands();
   total_time_ = 0;
   demand_violation_[0] = 0;
   for(uint r = 0; r < routes_.size(); r++){
@@ -163,10 +223,10 @@ void CvrpIndividualStructured::evaluate() {
     route.demand = 0;
     route.time = 0;
     uint prev_node = 0;
-    auto customers = route.customers;
+    auto &customers = route.customers;
     for(uint c = 0; c < customers.size(); c++){
       uint cur_node = customers[c].idx;
-      route.demand += nodes[cur_node].demand;
+      route.demand += demands[cur_node];
       route.time += instance_->getDistance(prev_node, cur_node);
       customers[c].time_up_to = route.time;
       customers[c].demand_up_to = route.demand;
@@ -199,28 +259,32 @@ void CvrpIndividualStructured::perform2optMove(
     right--;
   }
 
+  total_time_ -= route.time;
+  evaluateRouteFrom(route, segment.segment_start_idx);
+  total_time_ += route.time;
+}
+
+void CvrpIndividualStructured::evaluateRouteFrom(CvrpIndividualRoute &route, uint first_idx) {
   uint prev_node = 0;
   uint time = 0;
   uint demand = 0;
-  if(segment.segment_start_idx > 0){
-    const auto &prev_customer = route.customers[segment.segment_start_idx - 1];
+  if(first_idx > 0){
+    const auto &prev_customer = route.customers[first_idx - 1];
     prev_node = prev_customer.idx;
     time = prev_customer.time_up_to;
     demand = prev_customer.demand_up_to;
   }
-  const auto &nodes = instance_->getNodes();
-  for(uint i = segment.segment_start_idx; i < route.customers.size(); i++){
+  const uint *demands = instance_->getDemands();
+  for(uint i = first_idx; i < route.customers.size(); i++){
     const uint cur_node = route.customers[i].idx;
     time += instance_->getDistance(prev_node, cur_node);
-    demand += nodes[cur_node].demand;
+    demand += demands[cur_node];
     route.customers[i].time_up_to = time;
     route.customers[i].demand_up_to = demand;
     prev_node = cur_node;
   }
-  time += instance_->getDistance(prev_node, 0);
-  total_time_ -= route.time;
-  total_time_ += time;
-  route.time = time;
+  route.time = time + instance_->getDistance(prev_node, 0);
+  route.demand = demand;
 }
 
 void CvrpIndividualStructured::performExchangeMove(
@@ -232,57 +296,46 @@ void CvrpIndividualStructured::performExchangeMove(
   assert(segment1.segment_start_idx < route1.customers.size() && segment1.segment_start_idx + segment1.segment_length <= route1.customers.size());
   assert(segment2.segment_start_idx < route2.customers.size() && segment2.segment_start_idx + segment2.segment_length <= route2.customers.size());
 
-  auto new_route1 = insertSegment(route1, route2, segment1, segment2);
-  auto new_route2 = insertSegment(route2, route1, segment2, segment1);
-
-  exchange_route(segment1.route_idx, new_route1);
-  exchange_route(segment2.route_idx, new_route2);
+  swapSegments(segment1, segment2);
 }
 
-CvrpIndividualRoute CvrpIndividualStructured::insertSegment(
-    const CvrpIndividualRoute &to_route, const CvrpIndividualRoute &from_route,
-    const CvrpRouteSegment &remove_segment,
-    const CvrpRouteSegment &insert_segment) {
-  const auto &nodes = instance_->getNodes();
-
-  CvrpIndividualRoute new_route;
-  new_route.customers.reserve(to_route.customers.size() -
-                              remove_segment.segment_length +
-                              insert_segment.segment_length);
-  new_route.time = 0;
-  new_route.demand = 0;
-  uint prev_node = 0;
-  // insert nodes before removed segment
-  for(int i = 0; i < remove_segment.segment_start_idx; i++){
-    new_route.customers.push_back(to_route.customers[i]);
-  }
-  if(!new_route.customers.empty()){
-    const auto &prev_customer = new_route.customers.back();
-    new_route.time = prev_customer.time_up_to;
-    new_route.demand = prev_customer.demand_up_to;
-    prev_node = prev_customer.idx;
-  }
+/** Nodes of the swapped or inserted segments, kept between the moves so that their capacity is reused */
+static thread_local std::vector<uint> segment_nodes[2];
 
-  // insert nodes from inserted segment
-  for(int i = insert_segment.segment_start_idx; i < insert_segment.segment_start_idx + insert_segment.segment_length; i++){
-    const uint cur_node = from_route.customers[i].idx;
-    new_route.time += instance_->getDistance(prev_node, cur_node);
-    new_route.demand += nodes[cur_node].demand;
-    new_route.customers.emplace_back(cur_node, new_route.time,
-                                     new_route.demand);
-    prev_node = cur_node;
+void CvrpIndividualStructured::swapSegments(
+    const CvrpRouteSegment &segment1, const CvrpRouteSegment &segment2) {
+  assert(segment1.route_idx != segment2.route_idx);
+  const CvrpRouteSegment *segments[2] = {&segment1, &segment2};
+  for(int s = 0; s < 2; s++){
+    const auto &customers = routes_[segments[s]->route_idx].customers;
+    segment_nodes[s].clear();
+    for(uint i = segments[s]->segment_start_idx; i < segments[s]->segment_start_idx + segments[s]->segment_length; i++)
+      segment_nodes[s].push_back(customers[i].idx);
   }
+  replaceSegment(segment1, segment_nodes[1]);
+  replaceSegment(segment2, segment_nodes[0]);
+}
 
-  // insert nodes after removed segment
-  for(int i = remove_segment.segment_start_idx + remove_segment.segment_length; i < to_route.customers.size(); i++){
-    const uint cur_node = to_route.customers[i].idx;
-    new_route.time += instance_->getDistance(prev_node, cur_node);
-    new_route.demand += nodes[cur_node].demand;
-    new_route.customers.emplace_back(cur_node, new_route.time, new_route.demand);
-    prev_node = cur_node;
-  }
-  new_route.time += instance_->getDistance(prev_node, 0);
-  return new_route;
+void CvrpIndividualStructured::replaceSegment(
+    const CvrpRouteSegment &remove_segment, const std::vector<uint> &nodes) {
+  auto &route = routes_[remove_segment.route_idx];
+  auto &customers = route.customers;
+  const auto &capacity = instance_->getVehicleCapacity();
+  total_time_ -= route.time;
+  demand_violation_[0] -= std::max(0, (int)route.demand - capacity);
+
+  // shift the rest of the route by the length difference, the customers then get the new nodes
+  const auto segment_end = customers.begin() + remove_segment.segment_start_idx + remove_segment.segment_length;
+  if(nodes.size() > remove_segment.segment_length)
+    customers.insert(segment_end, nodes.size() - remove_segment.segment_length, CvrpIndividualCustomer());
+  else if(nodes.size() < remove_segment.segment_length)
+    customers.erase(segment_end - (remove_segment.segment_length - nodes.size()), segment_end);
+  for(uint i = 0; i < nodes.size(); i++)
+    customers[remove_segment.segment_start_idx + i].idx = nodes[i];
+  evaluateRouteFrom(route, remove_segment.segment_start_idx);
+
+  total_time_ += route.time;
+  demand_violation_[0] += std::max(0, (int)route.demand - capacity);
 }
 
 void CvrpIndividualStructured::performRelocateMove(
@@ -295,11 +348,7 @@ void CvrpIndividualStructured::performRelocateMove(
   assert(target_pos.segment_start_idx <= route_to.customers.size());
   assert(target_pos.segment_length == 0);
 
-  auto new_route_from = insertSegment(route_from, route_to, segment_moved, target_pos);
-  auto new_route_to = insertSegment(route_to, route_from, target_pos, segment_moved);
-
-  exchange_route(segment_moved.route_idx, new_route_from);
-  exchange_route(target_pos.route_idx, new_route_to);
+  swapSegments(segment_moved, target_pos);
 }
 
 void CvrpIndividualStructured::performCrossMove(
@@ -315,24 +364,21 @@ void CvrpIndividualStructured::performCrossMove(
   CvrpRouteSegment segment2_ = segment2;
   segment1_.segment_length = route1.customers.size() - segment1.segment_start_idx;
   segment2_.segment_length = route2.customers.size() - segment2.segment_start_idx;
-  auto new_route1 = insertSegment(route1, route2, segment1_, segment2_);
-  auto new_route2 = insertSegment(route2, route1, segment2_, segment1_);
-
-  exchange_route(segment1.route_idx, new_route1);
-  exchange_route(segment2.route_idx, new_route2);
-
+  swapSegments(segment1_, segment2_);
 }
 
-void CvrpIndividualStructured::exchange_route(
-    const uint &route_idx, const CvrpIndividualRoute &new_route) {
-  const auto &old_route = routes_[route_idx];
+void CvrpIndividualStructured::performRemoval(const CvrpRouteSegment &segment) {
+  assert(segment.route_idx < routes_.size());
+  assert(segment.segment_start_idx + segment.segment_length <= routes_[segment.route_idx].customers.size());
+  segment_nodes[0].clear();
+  replaceSegment(segment, segment_nodes[0]);
+}
 
-  total_time_ -= old_route.time;
-  total_time_ += new_route.time;
-  const auto &capacity = instance_->getVehicleCapacity();
-  demand_violation_[0] -= std::max(0, (int)old_route.demand - capacity);
-  demand_violation_[0] += std::max(0, (int)new_route.demand - capacity);
-  routes_[route_idx] = std::move(new_route);
+void CvrpIndividualStructured::performInsertion(const CvrpRouteSegment &target_pos, uint node) {
+  assert(target_pos.route_idx < routes_.size());
+  assert(target_pos.segment_start_idx <= routes_[target_pos.route_idx].customers.size() && target_pos.segment_length == 0);
+  segment_nodes[0].assign(1, node);
+  replaceSegment(target_pos, segment_nodes[0]);
 }
 
 uint CvrpIndividualStructured::getSegmentTime(const CvrpRouteSegment &segment) {
@@ -466,22 +512,20 @@ std::shared_ptr<Solution> CvrpIndividualStructured::convertSolution() {
   solution->travel_time_sum = total_time_;
   solution->end_time_sum = total_time_ + (instance_->getNodesCount() - 1) * 1;
   solution->objective = solution->travel_time_sum;
-
-  SolutionNode first_node(0, 0, 0);
+  solution->reserve(routes_.size(), instance_->getNodesCount() - 1 + 2 * routes_.size());
 
   for(const auto &route: routes_){
-    solution->routes.emplace_back();
-    auto &sol_route = solution->routes.back();
+    auto &sol_route = solution->addRoute();
     sol_route.demand = route.demand;
     sol_route.travel_time = route.time;
     sol_route.end_time = route.time + route.customers.size() * 1;
-    sol_route.route_nodes.push_back(first_node);
+    solution->addNode(0, 0, 0);
 
     for(uint i = 0; i < route.customers.size(); i++){
       const auto &customer = route.customers[i];
-      sol_route.route_nodes.emplace_back(customer.idx, customer.time_up_to + i, customer.time_up_to + i + 1);
+      solution->addNode(customer.idx, customer.time_up_to + i, customer.time_up_to + i + 1);
     }
-    sol_route.route_nodes.emplace_back(0, sol_route.end_time, sol_route.end_time);
+    solution->addNode(0, sol_route.end_time, sol_route.end_time);
   }
 
   solution->used_vehicles = (int)routes_.size();
@@ -606,6 +650,33 @@ CvrpIndividualStructured::getCrossMoveCost(const CvrpRouteSegment &segment1,
   return getExchangeMoveCost(segment1_, segment2_);
 }
 
+FitnessDiff CvrpIndividualStructured::getRemovalCost(const CvrpRouteSegment &segment) {
+  assert(segment.route_idx < routes_.size());
+  const auto &route = routes_[segment.route_idx];
+  assert(segment.segment_start_idx + segment.segment_length <= route.customers.size());
+  const auto &capacity = instance_->getVehicleCapacity();
+  const int demand_violation_old = std::max(0, (int)route.demand - capacity);
+  const int demand_violation_new = std::max(0, (int)route.demand - (int)getSegmentDemand(segment) - capacity);
+  const CvrpRouteSegment empty_segment = {segment.route_idx, 0, 0};
+  return {(int)getExchangeTime(segment, empty_segment) - (int)route.time, demand_violation_new - demand_violation_old, 0};
+}
+
+FitnessDiff CvrpIndividualStructured::getInsertionCost(const CvrpRouteSegment &target_pos, uint node) {
+  assert(target_pos.route_idx < routes_.size());
+  const auto &route = routes_[target_pos.route_idx];
+  const auto &customers = route.customers;
+  assert(target_pos.segment_start_idx <= customers.size() && target_pos.segment_length == 0);
+  const uint prev_node = target_pos.segment_start_idx == 0 ? 0 : customers[target_pos.segment_start_idx - 1].idx;
+  const uint next_node = target_pos.segment_start_idx == customers.size() ? 0 : customers[target_pos.segment_start_idx].idx;
+  const int time_change = (int)instance_->getDistance(prev_node, node) + (int)instance_->getDistance(node, next_node) -
+                          (int)instance_->getDistance(prev_node, next_node);
+
+  const auto &capacity = instance_->getVehicleCapacity();
+  const int demand_violation_old = std::max(0, (int)route.demand - capacity);
+  const int demand_violation_new = std::max(0, (int)(route.demand + instance_->getDemands()[node]) - capacity);
+  return {time_change, demand_violation_new - demand_violation_old, 0};
+}
+
 FitnessDiff CvrpIndividualStructured::getFitnessDiff(
     const CvrpIndividualStructured &other) {
   return {(int)total_time_ - (int)other.total_time_, (int)(demand_violation_[0] - other.demand_violation_[0]), 0};
@@ -1,7 +1,9 @@
 #include "CVRP//setup.h"
+#include <algorithm>
 #include <iostream>
 
 #include "CVRP/cvrp_SA_step.h"
+#include "CVRP/cvrp_construction.h"
 #include "CVRP/cvrp_exhaustive_local_search.h"
 #include "CVRP/cvrp_memetic.h"
 #include "CVRP/cvrp_mutation_random.h"
@@ -9,6 +11,7 @@
 #include "CVRP/cvrp_neighborhood.h"
 #include "CVRP/cvrp_pmx_crossover.h"
 #include "CVRP/cvrp_pmx_crossover_structured.h"
+#include "CVRP/cvrp_ruin_recreate.h"
 #include "CVRP/cvrp_simulated_annealing.h"
 #include "CVRP/cvrp_stochastic_local_search.h"
 #include "CVRP/cvrp_stochastic_ranking.h"
@@ -17,29 +20,50 @@
 #include "common/routing_instance.h"
 
 std::shared_ptr<HeuristicPortfolio>
-SetupCVRP::preparePortfolio(const JSON &config, const char *instance_filename) {
+SetupCVRP::preparePortfolio(const JSON &config, const char *instance_filename,
+                            const std::shared_ptr<ThreadScheduling> &scheduling) {
   auto portfolio = std::make_shared<HeuristicPortfolio>();
-  auto instance = std::make_shared<RoutingInstance>();
-  instance->loadTSPlibInstance(instance_filename);
+  portfolio->setScheduling(scheduling);
+  auto shared_instance = std::make_shared<RoutingInstance>();
+  shared_instance->loadTSPlibInstance(instance_filename);
+
+  // Candidate lists for granular neighborhoods and ruin and recreate ("candidates" in heuristic config),
+  // "dont_look_bits" alone enables node-centered search over all nodes
+  uint candidate_count = 0;
+  for(const auto &heur_config : config){
+    if(heur_config.contains("candidates"))
+      candidate_count = std::max(candidate_count, heur_config["candidates"].get<uint>());
+    else if(heur_config["type"] == "ruin_recreate")
+      candidate_count = std::max(candidate_count, 30u);
+  }
+  if(candidate_count > 0)
+    shared_instance->buildCandidateLists(candidate_count);
 
   //Optal communication thread (it has heuristic interface / optal is basically one of the heuristics)
-  auto serializer = std::make_shared<SolutionSerializer>();
+  auto serializer = std::make_shared<SolutionSerializer>(shared_instance);
   auto optalComms = std::make_shared<OptalComms>(serializer);
-  portfolio->addImprovingHeuristic(optalComms);
+  portfolio->addSolutionListener(optalComms, {{"type", "optal"}});
 
   for(uint h = 0; h < config.size(); h++){
     auto heur_config = config[h];
+    // with replicated distances every heuristic works on its own copy of the instance
+    const auto replica = scheduling->replicateDistances() ? std::make_shared<RoutingInstance>(*shared_instance) : nullptr;
+    const auto &instance = replica != nullptr ? replica : shared_instance;
     if(!heur_config.contains("type"))
       std::cerr << "Heuristic config doesn't contain type." << std::endl;
     if(heur_config["type"] == "stochastic_local_search"){
       auto mutation = std::make_shared<CvrpMutationRandom>(instance);
       auto localSearch = std::make_shared<CvrpStochasticLocalSearch>(instance, mutation);
-      portfolio->addImprovingHeuristic(localSearch);
+      portfolio->addImprovingHeuristic(localSearch, replica, heur_config);
     }
     else if(heur_config["type"] == "exhaustive_local_search"){
-      auto neighborhood = std::make_shared<CvrpNeighborhood>();
+      auto neighborhood = heur_config.contains("candidates") || heur_config.value("dont_look_bits", false) ?
+          std::make_shared<CvrpNeighborhood>(instance, heur_config.value("candidates", 0u)) :
+          std::make_shared<CvrpNeighborhood>();
+      if(heur_config.contains("route_pruning"))
+        neighborhood->setRoutePruning(*instance, heur_config["route_pruning"].get<double>());
       auto localSearch = std::make_shared<CvrpExhaustiveLocalSearch>(instance, neighborhood);
-      portfolio->addImprovingHeuristic(localSearch);
+      portfolio->addImprovingHeuristic(localSearch, replica, heur_config);
     }
     else if(heur_config["type"] == "stochastic_ranking"){
       auto mutation = std::make_shared<CvrpMutationRandom>(instance);
@@ -54,7 +78,7 @@ SetupCVRP::preparePortfolio(const JSON &config, const char *instance_filename) {
           3, // tournament size
           0.55 // fitness compare probability
           );
-      portfolio->addImprovingHeuristic(stochasticRanking);
+      portfolio->addImprovingHeuristic(stochasticRanking, replica, heur_config);
     }
     else if(heur_config["type"] == "memetic_algorithm"){
       auto mutation = std::make_shared<CvrpMutationReinsert>();
@@ -62,7 +86,11 @@ SetupCVRP::preparePortfolio(const JSON &config, const char *instance_filename) {
       auto selection = std::make_shared<TournamentSelection>(3);
       auto crossover = std::make_shared<CvrpPmxCrossoverStructured>();
       crossover->setCrossoverRate(0.8);
-      auto neighborhood = std::make_shared<CvrpNeighborhood>();
+      auto neighborhood = heur_config.contains("candidates") || heur_config.value("dont_look_bits", false) ?
+          std::make_shared<CvrpNeighborhood>(instance, heur_config.value("candidates", 0u)) :
+          std::make_shared<CvrpNeighborhood>();
+      if(heur_config.contains("route_pruning"))
+        neighborhood->setRoutePruning(*instance, heur_config["route_pruning"].get<double>());
       auto replacement = std::make_shared<TruncationReplacement>();
       auto memetic_algorithm = std::make_shared<CvrpMemetic>(
           instance,
@@ -73,7 +101,7 @@ SetupCVRP::preparePortfolio(const JSON &config, const char *instance_filename) {
           replacement,
           10
       );
-      portfolio->addImprovingHeuristic(memetic_algorithm);
+      portfolio->addImprovingHeuristic(memetic_algorithm, replica, heur_config);
     }
     else if(heur_config["type"] == "simulated_annealing"){
       auto step = std::make_shared<CvrpSAStep>();
@@ -88,8 +116,32 @@ SetupCVRP::preparePortfolio(const JSON &config, const char *instance_filename) {
           getEquivalentPunishmentFunction(average_length, 15.0) //constraint
       );
       //auto schedule = std::make_shared<SASchedule>([](double t){return 0.01;});
-      auto sa = std::make_shared<CvrpSimulatedAnnealing>(instance, step, schedule);
-      portfolio->addImprovingHeuristic(sa);
+      // "steps_per_unit": annealing steps in a unit of the heuristic
+      const uint steps_per_unit = heur_config.value("steps_per_unit", 100u);
+      if(steps_per_unit == 0){
+        std::cerr << "Invalid steps_per_unit of heuristic " << heur_config["type"] << std::endl;
+        exit(100);
+      }
+      auto sa = std::make_shared<CvrpSimulatedAnnealing>(instance, step, schedule, steps_per_unit);
+      portfolio->addImprovingHeuristic(sa, replica, heur_config);
+    }
+    else if(heur_config["type"] == "ruin_recreate"){
+      auto ruinRecreate = std::make_shared<CvrpRuinRecreate>(instance, RuinRecreateConfig(heur_config, *instance));
+      portfolio->addImprovingHeuristic(ruinRecreate, replica, heur_config);
+    }
+    else if(heur_config["type"] == "construction"){
+      // starting solutions built once, in parallel with the other constructions, for the improving heuristics
+      const std::string algorithm = heur_config.value("algorithm", "nearest_neighbor");
+      if(algorithm != "nearest_neighbor" && algorithm != "random"){
+        std::cerr << "Unknown construction algorithm: " << algorithm << std::endl;
+        exit(101);
+      }
+      auto construction = std::make_shared<CvrpConstruction>(
+          instance,
+          algorithm == "random" ? RANDOM_CONSTRUCTION : NEAREST_NEIGHBOR_CONSTRUCTION,
+          heur_config.value("solutions", 1u)
+      );
+      portfolio->addConstructiveHeuristic(construction, replica, heur_config);
     }
     else{
       std::cerr << "Unknown heuristic type: " << heur_config["type"] << std::endl;
@@ -97,7 +149,7 @@ SetupCVRP::preparePortfolio(const JSON &config, const char *instance_filename) {
     }
   }
 
-  std::cerr << "Heuristic vehicle count " << instance->getVehicleCount() << std::endl;
+  std::cerr << "Heuristic vehicle count " << shared_instance->getVehicleCount() << std::endl;
 
   return portfolio;
 }
@@ -1,9 +1,12 @@
 #include "TSP/setup.h"
+#include <algorithm>
 #include <iostream>
 
 #include "TSP/tsp_SA_step.h"
+#include "TSP/tsp_construction.h"
 #include "TSP/tsp_exhaustive_local_search.h"
 #include "TSP/tsp_genetic_algorithm.h"
+#include "TSP/tsp_lin_kernighan.h"
 #include "TSP/tsp_local_search.h"
 #include "TSP/tsp_memetic.h"
 #include "TSP/tsp_mutation_2opt.h"
@@ -19,29 +22,51 @@
 #include "heuristic_framework/truncation_replacement.h"
 
 std::shared_ptr<HeuristicPortfolio>
-SetupTSP::preparePortfolio(const JSON &config, const char *instance_filename) {
+SetupTSP::preparePortfolio(const JSON &config, const char *instance_filename,
+                            const std::shared_ptr<ThreadScheduling> &scheduling) {
   auto portfolio = std::make_shared<HeuristicPortfolio>();
-  auto instance = std::make_shared<RoutingInstance>();
-  instance->loadTSPlibInstance(instance_filename);
+  portfolio->setScheduling(scheduling);
+  auto shared_instance = std::make_shared<RoutingInstance>();
+  shared_instance->loadTSPlibInstance(instance_filename);
+
+  // Candidate lists for granular neighborhoods ("candidates" in heuristic config),
+  // "dont_look_bits" alone enables node-centered search over all nodes
+  uint candidate_count = 0;
+  for(const auto &heur_config : config){
+    if(heur_config.contains("candidates"))
+      candidate_count = std::max(candidate_count, heur_config["candidates"].get<uint>());
+    else if(heur_config["type"] == "lin_kernighan")
+      candidate_count = std::max(candidate_count, 8u);
+  }
+  if(candidate_count > 0)
+    shared_instance->buildCandidateLists(candidate_count);
 
   //Optal communication thread (it has heuristic interface / optal is basically one of the heuristics)
-  auto serializer = std::make_shared<SolutionSerializer>();
+  auto serializer = std::make_shared<SolutionSerializer>(shared_instance);
   auto optalComms = std::make_shared<OptalComms>(serializer);
-  portfolio->addImprovingHeuristic(optalComms);
+  portfolio->addSolutionListener(optalComms, {{"type", "optal"}});
 
   for(uint h = 0; h < config.size(); h++){
     auto heur_config = config[h];
+    // with replicated distances every heuristic works on its own copy of the instance
+    const auto replica = scheduling->replicateDistances() ? std::make_shared<RoutingInstance>(*shared_instance) : nullptr;
+    const auto &instance = replica != nullptr ? replica : shared_instance;
     if(!heur_config.contains("type"))
         std::cerr << "Heuristic config doesn't contain type." << std::endl;
+    // the other heuristics address the tour by position and always keep it in a vector
+    if(heur_config.contains("tour") && heur_config["type"] != "lin_kernighan"){
+      std::cerr << "Tour representation is supported by lin_kernighan only: " << heur_config << std::endl;
+      exit(100);
+    }
     // Local-search initialization
     if(heur_config["type"] == "local_search"){
-      auto mutation = std::make_shared<TspMutation2opt>(instance->getMatrix().get());
+      auto mutation = std::make_shared<TspMutation2opt>(instance.get());
       auto localSearch = std::make_shared<TspLocalSearch>(instance, mutation);
-      portfolio->addImprovingHeuristic(localSearch);
+      portfolio->addImprovingHeuristic(localSearch, replica, heur_config);
     }
     // Genetic-algorithm initialization
     else if(heur_config["type"] == "genetic_algorithm"){
-      auto mutation = std::make_shared<TspMutation2opt>(instance->getMatrix().get());
+      auto mutation = std::make_shared<TspMutation2opt>(instance.get());
       mutation->setMutationRate(1.0);
       auto selection = std::make_shared<TournamentSelection>(3);
       auto crossover = std::make_shared<TspPmxCrossover>();
@@ -55,7 +80,7 @@ SetupTSP::preparePortfolio(const JSON &config, const char *instance_filename) {
           replacement,
           10
           );
-      portfolio->addImprovingHeuristic(geneticAlgorithm);
+      portfolio->addImprovingHeuristic(geneticAlgorithm, replica, heur_config);
     }
     else if(heur_config["type"] == "memetic_algorithm"){
       auto mutation = std::make_shared<TspMutationDoubleBridge>();
@@ -63,7 +88,9 @@ SetupTSP::preparePortfolio(const JSON &config, const char *instance_filename) {
       auto selection = std::make_shared<TournamentSelection>(3);
       auto crossover = std::make_shared<TspPmxCrossoverStructured>();
       crossover->setCrossoverRate(0.8);
-      auto neighborhood = std::make_shared<TspNeighborhood>();
+      auto neighborhood = heur_config.contains("candidates") || heur_config.value("dont_look_bits", false) ?
+          std::make_shared<TspNeighborhood>(instance, heur_config.value("candidates", 0u)) :
+          std::make_shared<TspNeighborhood>();
       auto replacement = std::make_shared<TruncationReplacement>();
       auto memetic_algorithm = std::make_shared<TspMemetic>(
           instance,
@@ -74,12 +101,14 @@ SetupTSP::preparePortfolio(const JSON &config, const char *instance_filename) {
           replacement,
           10
       );
-      portfolio->addImprovingHeuristic(memetic_algorithm);
+      portfolio->addImprovingHeuristic(memetic_algorithm, replica, heur_config);
     }
     else if(heur_config["type"] == "exhaustive_local_search"){
-      auto neighborhood = std::make_shared<TspNeighborhood>();
+      auto neighborhood = heur_config.contains("candidates") || heur_config.value("dont_look_bits", false) ?
+          std::make_shared<TspNeighborhood>(instance, heur_config.value("candidates", 0u)) :
+          std::make_shared<TspNeighborhood>();
       auto localSearch = std::make_shared<TspExhaustiveLocalSearch>(instance, neighborhood);
-      portfolio->addImprovingHeuristic(localSearch);
+      portfolio->addImprovingHeuristic(localSearch, replica, heur_config);
     }
     else if(heur_config["type"] == "simulated_annealing"){
       auto step = std::make_shared<TspSAStep>();
@@ -94,8 +123,43 @@ SetupTSP::preparePortfolio(const JSON &config, const char *instance_filename) {
           [](double t){return 0;}
           );
       //auto schedule = std::make_shared<SASchedule>([](double t){return 0.01;});
-      auto sa = std::make_shared<TspSimulatedAnnealing>(instance, step, schedule);
-      portfolio->addImprovingHeuristic(sa);
+      // "steps_per_unit": annealing steps in a unit of the heuristic
+      const uint steps_per_unit = heur_config.value("steps_per_unit", 100u);
+      if(steps_per_unit == 0){
+        std::cerr << "Invalid steps_per_unit of heuristic " << heur_config["type"] << std::endl;
+        exit(100);
+      }
+      auto sa = std::make_shared<TspSimulatedAnnealing>(instance, step, schedule, steps_per_unit);
+      portfolio->addImprovingHeuristic(sa, replica, heur_config);
+    }
+    else if(heur_config["type"] == "lin_kernighan"){
+      // "tour": "array" or "two_level", by default two-level list on large instances
+      const std::string tour = heur_config.value("tour", instance->getNodesCount() >= 50000 ? "two_level" : "array");
+      if(tour != "array" && tour != "two_level"){
+        std::cerr << "Unknown tour representation: " << tour << std::endl;
+        exit(101);
+      }
+      auto linKernighan = std::make_shared<TspLinKernighan>(
+          instance,
+          heur_config.value("candidates", 8u),
+          heur_config.value("max_depth", 50u),
+          tour == "two_level"
+          );
+      portfolio->addImprovingHeuristic(linKernighan, replica, heur_config);
+    }
+    else if(heur_config["type"] == "construction"){
+      // starting solutions built once, in parallel with the other constructions, for the improving heuristics
+      const std::string algorithm = heur_config.value("algorithm", "nearest_neighbor");
+      if(algorithm != "nearest_neighbor" && algorithm != "random"){
+        std::cerr << "Unknown construction algorithm: " << algorithm << std::endl;
+        exit(101);
+      }
+      auto construction = std::make_shared<TspConstruction>(
+          instance,
+          algorithm == "random" ? RANDOM_CONSTRUCTION : NEAREST_NEIGHBOR_CONSTRUCTION,
+          heur_config.value("solutions", 1u)
+      );
+      portfolio->addConstructiveHeuristic(construction, replica, heur_config);
     }
     else{
       std::cerr << "Unknown heuristic type: " << heur_config["type"] << std::endl;
@@ -59,6 +59,10 @@ StepResult TspSAStep::step(const std::shared_ptr<Individual> &individual,
     result = performSwap(individual_, schedule, best_individual_);
   else if(selected == neighborhood_options::RELOCATE)
     result = performRelocate(individual_, schedule, best_individual_);
+  else if(selected == neighborhood_options::OR_OPT)
+    result = performOrOpt(individual_, schedule, best_individual_);
+  else if(selected == neighborhood_options::THREE_OPT)
+    result = perform3opt(individual_, schedule, best_individual_);
 
   if(result == StepResult::IMPROVED){
     success(selected);
@@ -152,3 +156,56 @@ StepResult TspSAStep::performRelocate(
   }
   return StepResult::UNACCEPTED;
 }
+
+StepResult TspSAStep::performOrOpt(
+    const std::shared_ptr<TspIndividualStructured> &individual,
+    const std::shared_ptr<SASchedule> &schedule,
+    const std::shared_ptr<TspIndividualStructured> &best_individual) {
+  const uint size = individual->getData().size();
+  std::uniform_int_distribution<uint> length_dist(1, std::min(3u, size - 1));
+  const uint length = length_dist(gen_);
+  std::uniform_int_distribution<uint> start_dist(0, size - length);
+  const uint start = start_dist(gen_);
+
+  return trySegmentInsertion(individual, schedule, best_individual, {start, start + length - 1});
+}
+
+StepResult TspSAStep::perform3opt(
+    const std::shared_ptr<TspIndividualStructured> &individual,
+    const std::shared_ptr<SASchedule> &schedule,
+    const std::shared_ptr<TspIndividualStructured> &best_individual) {
+  const uint size = individual->getData().size();
+  std::uniform_int_distribution<uint> start_dist(0, size-1);
+  uint first = start_dist(gen_);
+  uint second = start_dist(gen_);
+  while(std::min(first, second) == 0 && std::max(first, second) == size - 1)
+    second = start_dist(gen_);
+
+  return trySegmentInsertion(individual, schedule, best_individual, {std::min(first, second), std::max(first, second)});
+}
+
+StepResult TspSAStep::trySegmentInsertion(
+    const std::shared_ptr<TspIndividualStructured> &individual,
+    const std::shared_ptr<SASchedule> &schedule,
+    const std::shared_ptr<TspIndividualStructured> &best_individual,
+    const TspIndividualSegment &segment) {
+  // positions outside of [start_idx, end_idx + 1], counted from end_idx + 2 and wrapping around
+  const uint size = individual->getData().size();
+  const uint length = segment.end_idx - segment.start_idx + 1;
+  std::uniform_int_distribution<uint> target_dist(0, size - length - 1);
+  const uint idx_to = (segment.end_idx + 2 + target_dist(gen_)) % (size + 1);
+  const bool reversed = dist_(gen_) < 0.5;
+
+  const auto diff = individual->getOrOptMoveCost(segment, idx_to, reversed);
+  const auto total_diff = diff + individual->getFitnessDiff(*best_individual);
+
+  if(diff.fitness <= 0){
+    individual->performOrOptMove(segment, idx_to, reversed);
+    return stepResult::IMPROVED;
+  }
+  else if(schedule->shouldAcceptSolution(total_diff)){
+    individual->performOrOptMove(segment, idx_to, reversed);
+    return stepResult::ACCEPTED;
+  }
+  return StepResult::UNACCEPTED;
+}
@@ -0,0 +1,40 @@
+#include "TSP/tsp_array_tour.h"
+#include <cassert>
+
+TspArrayTour::TspArrayTour(const std::vector<uint> &order) {
+  load(order);
+}
+
+void TspArrayTour::load(const std::vector<uint> &order) {
+  order_ = order;
+  positions_.resize(order_.size());
+  for(uint i = 0; i < order_.size(); i++){
+    positions_[order_[i]] = i;
+  }
+}
+
+void TspArrayTour::reverse(uint from, uint to) {
+  const uint size = order_.size();
+  uint swaps = ((to + size - from) % size + 1) / 2;
+  while(swaps-- > 0){
+    const uint node_from = order_[from];
+    const uint node_to = order_[to];
+    order_[from] = node_to;
+    positions_[node_to] = from;
+    order_[to] = node_from;
+    positions_[node_from] = to;
+    from = from + 1 == size ? 0 : from + 1;
+    to = to == 0 ? size - 1 : to - 1;
+  }
+}
+
+void TspArrayTour::make2optMove(uint a, uint b, uint c, uint d) {
+  assert(next(a) == b && next(c) == d);
+  const uint size = order_.size();
+  const uint inner_length = (positions_[c] + size - positions_[b]) % size + 1;
+  // reversing b..c or d..a gives the same cyclic tour
+  if(2 * inner_length <= size)
+    reverse(positions_[b], positions_[c]);
+  else
+    reverse(positions_[d], positions_[a]);
+}
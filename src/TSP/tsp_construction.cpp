@@ -0,0 +1,51 @@
+#include "TSP/tsp_construction.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+TspConstruction::TspConstruction(
+    const std::shared_ptr<RoutingInstance> &instance, ConstructionAlgorithm algorithm, uint solution_count) {
+  instance_ = instance;
+  portfolio_ = nullptr;
+  terminate_ = false;
+  algorithm_ = algorithm;
+  solution_count_ = solution_count;
+  built_count_ = 0;
+  std::random_device rand;
+  gen_ = std::mt19937(rand());
+}
+
+void TspConstruction::initialize(HeuristicPortfolio *portfolio) {
+  portfolio_ = portfolio;
+  terminate_ = false;
+}
+
+bool TspConstruction::startUnits() {
+  built_count_ = 0;
+  return true;
+}
+
+bool TspConstruction::runUnit() {
+  if(built_count_ >= solution_count_ || terminate_)
+    return false;
+  auto individual = std::make_shared<TspIndividualStructured>(instance_.get());
+  if(algorithm_ == RANDOM_CONSTRUCTION){
+    std::vector<uint> order(instance_->getNodesCount() - 1);
+    std::iota(order.begin(), order.end(), 1);
+    std::shuffle(order.begin(), order.end(), gen_);
+    individual = std::make_shared<TspIndividualStructured>(*individual, order);
+  }
+  else if(!individual->smartInitialize([this]() -> bool {return terminate_;})){
+    return false;
+  }
+  individual->evaluate();
+  portfolio_->addStartingSolution(individual->convertSolution());
+  built_count_++;
+  return built_count_ < solution_count_;
+}
+
+void TspConstruction::terminate() {
+  terminate_.store(true);
+}
+
+void TspConstruction::acceptSolution(std::shared_ptr<Solution>) {}
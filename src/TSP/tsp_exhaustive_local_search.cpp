@@ -42,6 +42,7 @@ void TspExhaustiveLocalSearch::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<TspIndividualStructured>(individual);
     auto solution = individual_->convertSolution();
@@ -51,13 +52,22 @@ void TspExhaustiveLocalSearch::initialize(HeuristicPortfolio *portfolio) {
   local_search_ = std::make_shared<ExhaustiveLocalSearch>(callbacks, neighborhood_);
 }
 
-void TspExhaustiveLocalSearch::run() {
-  auto initialSolution = std::make_shared<TspIndividualStructured>(instance_.get());
-  initialSolution->smartInitialize();
+bool TspExhaustiveLocalSearch::startUnits() {
+  auto starting_solution = portfolio_->takeStartingSolution();
+  auto initialSolution = starting_solution != nullptr ?
+      std::make_shared<TspIndividualStructured>(instance_.get(), starting_solution) :
+      std::make_shared<TspIndividualStructured>(instance_.get());
+  if(starting_solution == nullptr)
+    initialSolution->smartInitialize([this]() -> bool {return terminate_;});
   initialSolution->evaluate();
   auto solution = initialSolution->convertSolution();
   portfolio_->acceptSolution(solution);
-  local_search_->run(initialSolution);
+  local_search_->start(initialSolution);
+  return true;
+}
+
+bool TspExhaustiveLocalSearch::runUnit() {
+  return local_search_->step();
 }
 
 void TspExhaustiveLocalSearch::terminate() {
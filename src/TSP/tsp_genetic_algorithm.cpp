@@ -12,7 +12,6 @@ TspGeneticAlgorithm::TspGeneticAlgorithm(
   instance_ = instance;
   best_solution_ = nullptr;
   terminate_ = false;
-  matrix_ = instance->getMatrix().get();
   genetic_algorithm_ = nullptr;
   mutation_ = mutation;
   selection_ = selection;
@@ -21,11 +20,15 @@ TspGeneticAlgorithm::TspGeneticAlgorithm(
   population_size_ = population_size;
 }
 
-void TspGeneticAlgorithm::run() {
+bool TspGeneticAlgorithm::startUnits() {
   std::random_device rand;
   std::mt19937 gen(rand());
-  std::shared_ptr<TspIndividual> initial_individual = std::make_shared<TspIndividual>(instance_.get());
-  initial_individual->initializeNearestNeighbor();
+  auto starting_solution = portfolio_->takeStartingSolution();
+  std::shared_ptr<TspIndividual> initial_individual = starting_solution != nullptr ?
+      std::make_shared<TspIndividual>(instance_.get(), starting_solution) :
+      std::make_shared<TspIndividual>(instance_.get());
+  if(starting_solution == nullptr)
+    initial_individual->initializeNearestNeighbor();
   initial_individual->evaluate();
   auto solution = initial_individual->convertSolution();
   if(checkBetterSolution(solution))
@@ -43,7 +46,12 @@ void TspGeneticAlgorithm::run() {
   }
 
   assert(genetic_algorithm_ != nullptr);
-  genetic_algorithm_->run(initial_population);
+  genetic_algorithm_->start(initial_population);
+  return true;
+}
+
+bool TspGeneticAlgorithm::runUnit() {
+  return genetic_algorithm_->step();
 }
 
 void TspGeneticAlgorithm::initialize(HeuristicPortfolio *portfolio) {
@@ -53,6 +61,7 @@ void TspGeneticAlgorithm::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<TspIndividual>(individual);
     auto solution = individual_->convertSolution();
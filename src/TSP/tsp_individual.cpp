@@ -4,11 +4,11 @@
 #include <iostream>
 #include <limits>
 
-TspIndividual::TspIndividual(const RoutingInstance *const instance) : instance_(instance), matrix_(instance->getMatrix().get()), data_(), is_evaluated_(false), fitness_(std::numeric_limits<double>::max()) {
+TspIndividual::TspIndividual(const RoutingInstance *const instance) : instance_(instance), data_(), is_evaluated_(false), fitness_(std::numeric_limits<double>::max()) {
 
 }
 
-TspIndividual::TspIndividual(const TspIndividual &other) : instance_(other.instance_), matrix_(other.matrix_), data_(other.data_),  is_evaluated_(other.is_evaluated_), fitness_(other.fitness_){
+TspIndividual::TspIndividual(const TspIndividual &other) : instance_(other.instance_), data_(other.data_),  is_evaluated_(other.is_evaluated_), fitness_(other.fitness_){
 
 }
 
@@ -79,12 +79,10 @@ void TspIndividual::evaluate() {
 
 void TspIndividual::calculateFitness() {
   fitness_ = 0;
-  const auto matrix_size = instance_->getNodesCount();
-
   for(uint i = 0 ; i < data_.size() - 1; i++){
-    fitness_ += matrix_[data_[i] * matrix_size + data_[i+1]];
+    fitness_ += instance_->getDistance(data_[i], data_[i+1]);
   }
-  fitness_ += matrix_[data_[matrix_size - 1] * matrix_size + data_[0]];
+  fitness_ += instance_->getDistance(data_.back(), data_[0]);
 }
 
 std::shared_ptr<Individual> TspIndividual::deepcopy() {
@@ -114,37 +112,27 @@ std::shared_ptr<Solution> TspIndividual::convertSolution() {
     if(data_[zero_idx] == 0)
       break;
   }
+  auto solution = std::make_shared<Solution>();
+  solution->reserve(1, data_.size() + 1);
+  auto &route = solution->addRoute();
+
   // Fill out nodes
-  auto nodes = std::list<SolutionNode>();
   int start_time = 0;
   for(uint i = 0; i < data_.size(); i++){
-    auto node = SolutionNode();
-    node.idx = (int)data_[(zero_idx + i) % data_.size()];
-    node.start_time = start_time;
-    node.end_time = start_time + 1;
+    const auto &node = solution->addNode((int)data_[(zero_idx + i) % data_.size()], start_time, start_time + 1);
     const uint next_node = data_[(zero_idx + i + 1) % data_.size()];
-    start_time += 1 + matrix_[node.idx * data_.size() + next_node];
-    nodes.push_back(node);
+    start_time += 1 + instance_->getDistance(node.idx, next_node);
   }
-  auto last_node = SolutionNode();
-  last_node.idx = 0;
-  last_node.start_time = start_time;
-  last_node.end_time = start_time + 1;
-  nodes.push_back(last_node);
+  const auto &last_node = solution->addNode(0, start_time, start_time + 1);
 
   // Fill out objectives
-  auto solution = std::make_shared<Solution>();
   const auto objective = fitness_;
   solution->objective = objective;
   solution->travel_time_sum = objective;
   solution->end_time_sum = last_node.end_time;
-  solution->routes = std::list<SolutionRoute>();
-  auto route = SolutionRoute();
   route.demand = -1;
   route.end_time = solution->end_time_sum;
   route.travel_time = objective;
-  route.route_nodes = nodes;
-  solution->routes.push_back(route);
   solution->feasible = true;
   solution->used_vehicles = 1;
 
@@ -155,7 +143,7 @@ TspIndividual::TspIndividual(const RoutingInstance *const instance,
                              const std::shared_ptr<Solution> &solution) : TspIndividual(instance) {
   data_.reserve(instance_->getNodesCount());
   uint i = 0;
-  for(const auto &node: solution->routes.front().route_nodes){
+  for(const auto &node: solution->routeNodes(solution->routes.front())){
     data_.push_back(node.idx);
     i++;
     if(i >= (uint)instance_->getNodesCount())
@@ -1,4 +1,5 @@
 #include "TSP/tsp_individual_structured.h"
+#include <algorithm>
 #include <cassert>
 #include <limits>
 #include <random>
@@ -13,7 +14,7 @@ TspIndividualStructured::TspIndividualStructured(
     const std::shared_ptr<Solution> &solution) : TspIndividualStructured(instance){
   data_.clear();
   data_.reserve(instance->getNodesCount() - 1);
-  for(const auto &node : solution->routes.begin()->route_nodes){
+  for(const auto &node : solution->routeNodes(solution->routes.front())){
     if(node.idx == 0)
       continue;
     data_.push_back(node.idx);
@@ -35,18 +36,18 @@ std::shared_ptr<Solution> TspIndividualStructured::convertSolution() {
   solution->travel_time_sum = total_time_;
 
   uint time = 1;
-  solution->routes.emplace_back();
-  auto &route = solution->routes.back();
-  route.route_nodes.emplace_back(0, 0, 1);
+  solution->reserve(1, data_.size() + 2);
+  auto &route = solution->addRoute();
+  solution->addNode(0, 0, 1);
   uint prev_node = 0;
   for(const auto &node : data_){
     time += instance_->getDistance(prev_node, node);
-    route.route_nodes.emplace_back(node, time, time + 1);
+    solution->addNode(node, time, time + 1);
     time++;
     prev_node = node;
   }
   time += instance_->getDistance(prev_node, 0);
-  route.route_nodes.emplace_back(0, time, time + 1);
+  solution->addNode(0, time, time + 1);
   route.demand = 0;
   route.travel_time = solution->travel_time_sum;
   route.end_time = time;
@@ -64,6 +65,10 @@ void TspIndividualStructured::initialize() {
 }
 
 void TspIndividualStructured::smartInitialize() {
+  smartInitialize([]() -> bool {return false;});
+}
+
+bool TspIndividualStructured::smartInitialize(const std::function<bool()> &should_terminate) {
   data_.clear();
   data_.reserve(instance_->getNodesCount() - 1);
   std::vector<bool> used(instance_->getNodesCount(), false);
@@ -78,22 +83,41 @@ void TspIndividualStructured::smartInitialize() {
   nodes.push_back(prev_node);
   used[prev_node] = true;
   uint zero_idx = 0;
+  const uint candidate_count = instance_->getCandidateCount();
 
   for(int i = 1; i < instance_->getNodesCount(); i++){
-    uint best_distance = std::numeric_limits<uint>::max();
+    // a row scan takes O(n), the whole construction seconds on large instances
+    if(should_terminate()){
+      initialize();
+      evaluate();
+      return false;
+    }
     uint nearest_neighbor = 0;
-    for(int j = 0; j < instance_->getNodesCount(); j++){
-      if(used[j])
-        continue;
-      const uint distance = instance_->getDistance(prev_node, j);
-      if(distance < best_distance){
-        best_distance = distance;
-        nearest_neighbor = j;
+    // candidates are sorted by distance, the first unused one is the nearest neighbor without a row scan
+    uint k = 0;
+    const uint *candidates = candidate_count > 0 ? instance_->getCandidates(prev_node) : nullptr;
+    while(k < candidate_count && used[candidates[k]])
+      k++;
+    if(k < candidate_count){
+      nearest_neighbor = candidates[k];
+    }
+    else{
+      uint best_distance = std::numeric_limits<uint>::max();
+      const uint *row = instance_->getDistanceRow(prev_node);
+      for(int j = 0; j < instance_->getNodesCount(); j++){
+        if(used[j])
+          continue;
+        const uint distance = row != nullptr ? row[j] : instance_->getDistance(prev_node, j);
+        if(distance < best_distance){
+          best_distance = distance;
+          nearest_neighbor = j;
+        }
       }
     }
     assert(used[nearest_neighbor] == false);
     used[nearest_neighbor] = true;
     nodes.push_back(nearest_neighbor);
+    prev_node = nearest_neighbor;
     if(nearest_neighbor == 0){
       zero_idx = i;
     }
@@ -103,6 +127,7 @@ void TspIndividualStructured::smartInitialize() {
     data_.push_back(nodes[(zero_idx + i) % nodes.size()]);
   }
   evaluate();
+  return true;
 }
 void TspIndividualStructured::resetEvaluated() {
   is_evaluated_ = false;
@@ -189,25 +214,16 @@ void TspIndividualStructured::performDoubleBridgeMove(
   assert(segment2.start_idx < data_.size());
   assert(segment2.end_idx < data_.size());
 
-  std::vector<uint> nodes(data_);
-  uint idx = 0;
-  for(int i = 0; i < segment1.start_idx; i++){
-    data_[idx++] = nodes[i];
-  }
-  for(int i = segment2.start_idx; i <= segment2.end_idx; i++){
-    data_[idx++] = nodes[i];
-  }
-  for(int i = segment1.start_idx; i <= segment1.end_idx; i++){
-    data_[idx++] = nodes[i];
-  }
-  for(int i = segment1.end_idx + 1; i < segment2.start_idx; i++){
-    data_[idx++] = nodes[i];
-  }
-  for(int i = segment2.end_idx + 1; i < nodes.size(); i++){
-    data_[idx++] = nodes[i];
-  }
-  resetEvaluated();
-  evaluate();
+  // segment1 middle segment2 -> segment2 segment1 middle, middle may be empty
+  const uint prev_node = segment1.start_idx > 0 ? data_[segment1.start_idx - 1] : 0;
+  const uint next_node = segment2.end_idx < data_.size() - 1 ? data_[segment2.end_idx + 1] : 0;
+  const uint middle_last = data_[segment2.start_idx - 1];
+  const uint first1 = data_[segment1.start_idx];
+  const uint first2 = data_[segment2.start_idx], last2 = data_[segment2.end_idx];
+  total_time_ += instance_->getDistance(prev_node, first2) + instance_->getDistance(last2, first1) + instance_->getDistance(middle_last, next_node);
+  total_time_ -= instance_->getDistance(prev_node, first1) + instance_->getDistance(middle_last, first2) + instance_->getDistance(last2, next_node);
+
+  std::rotate(data_.begin() + segment1.start_idx, data_.begin() + segment2.start_idx, data_.begin() + segment2.end_idx + 1);
 }
 
 TspIndividualStructured::TspIndividualStructured(
@@ -373,6 +389,48 @@ FitnessDiff TspIndividualStructured::getRelocateMoveCost(uint idx_from,
   return {.fitness = diff, .constraints = 0, .vehicles = 0};
 }
 
+FitnessDiff TspIndividualStructured::getOrOptMoveCost(
+    const TspIndividualSegment &segment, uint idx_to, bool reversed) {
+  assert(segment.start_idx <= segment.end_idx);
+  assert(segment.end_idx < data_.size());
+  assert(idx_to <= data_.size());
+  assert(idx_to < segment.start_idx || idx_to > segment.end_idx + 1);
+  const uint prev_start = segment.start_idx > 0 ? data_[segment.start_idx - 1] : 0;
+  const uint next_end = segment.end_idx < data_.size() - 1 ? data_[segment.end_idx + 1] : 0;
+  const uint prev_to = idx_to > 0 ? data_[idx_to - 1] : 0;
+  const uint cur_to = idx_to < data_.size() ? data_[idx_to] : 0;
+  const uint first = reversed ? data_[segment.end_idx] : data_[segment.start_idx];
+  const uint last = reversed ? data_[segment.start_idx] : data_[segment.end_idx];
+
+  int diff = (int)(instance_->getDistance(prev_start, next_end) + instance_->getDistance(prev_to, first) + instance_->getDistance(last, cur_to));
+  diff -= (int)(instance_->getDistance(prev_start, data_[segment.start_idx]) + instance_->getDistance(data_[segment.end_idx], next_end) + instance_->getDistance(prev_to, cur_to));
+
+  return {.fitness = diff, .constraints = 0, .vehicles = 0};
+}
+
+bool TspIndividualStructured::testOrOptMove(const TspIndividualSegment &segment,
+                                            uint idx_to, bool reversed) {
+  return getOrOptMoveCost(segment, idx_to, reversed).fitness < 0;
+}
+
+void TspIndividualStructured::performOrOptMove(
+    const TspIndividualSegment &segment, uint idx_to, bool reversed) {
+  const int diff = getOrOptMoveCost(segment, idx_to, reversed).fitness;
+  total_time_ = (uint)((int)total_time_ + diff);
+
+  const uint length = segment.end_idx - segment.start_idx + 1;
+  uint new_start;
+  if(idx_to < segment.start_idx){
+    std::rotate(data_.begin() + idx_to, data_.begin() + segment.start_idx, data_.begin() + segment.end_idx + 1);
+    new_start = idx_to;
+  }else{
+    std::rotate(data_.begin() + segment.start_idx, data_.begin() + segment.end_idx + 1, data_.begin() + idx_to);
+    new_start = idx_to - length;
+  }
+  if(reversed)
+    std::reverse(data_.begin() + new_start, data_.begin() + new_start + length);
+}
+
 FitnessDiff
 TspIndividualStructured::getFitnessDiff(const TspIndividualStructured &other) {
   return {.fitness = (int)total_time_ - (int)other.total_time_, .constraints = 0, .vehicles = 0};
@@ -0,0 +1,269 @@
+#include "TSP/tsp_lin_kernighan.h"
+#include "TSP/tsp_array_tour.h"
+#include "TSP/tsp_two_level_tour.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <limits>
+
+TspLinKernighan::TspLinKernighan(
+    const std::shared_ptr<RoutingInstance> &instance, uint candidate_count,
+    uint max_depth, bool two_level_tour) : rand_(), gen_(rand_()) {
+  instance_ = instance;
+  best_solution_ = nullptr;
+  outside_solution_ = nullptr;
+  portfolio_ = nullptr;
+  terminate_ = false;
+  candidate_count_ = std::min(candidate_count, instance->getCandidateCount());
+  max_depth_ = max_depth;
+  if(two_level_tour)
+    tour_ = std::make_shared<TspTwoLevelTour>();
+  else
+    tour_ = std::make_shared<TspArrayTour>();
+  tour_length_ = 0;
+  best_length_ = 0;
+  assert(candidate_count_ > 0 && max_depth_ > 0);
+}
+
+void TspLinKernighan::sendSolution(const std::shared_ptr<Solution> &solution) {
+  if(solution == nullptr || portfolio_ == nullptr)
+    return;
+  portfolio_->acceptSolution(solution);
+}
+
+bool TspLinKernighan::checkBetterSolution(
+    const std::shared_ptr<Solution> &solution) {
+  if(solution->objective < 0) { // integer overflow
+    std::cerr << "Integer overflow encountered in TSP Lin-Kernighan solution value" << std::endl;
+    return false;
+  }
+  std::lock_guard<std::recursive_mutex> lock(solution_mutex_);
+  if(best_solution_ == nullptr || solution->betterThan(*best_solution_)){
+    best_solution_ = solution;
+    return true;
+  }
+  return false;
+}
+
+bool TspLinKernighan::checkOutsideSolution() {
+  std::shared_ptr<Solution> solution;
+  {
+    std::lock_guard<std::recursive_mutex> lock(solution_mutex_);
+    solution = outside_solution_;
+    outside_solution_ = nullptr;
+  }
+  if(solution == nullptr || solution->objective >= best_length_)
+    return false;
+
+  std::vector<uint> order;
+  order.reserve(instance_->getNodesCount());
+  for(const auto &node : solution->routeNodes(solution->routes.front())){
+    if(node.idx == 0 && !order.empty())
+      break; // closing depot
+    order.push_back(node.idx);
+  }
+  assert(order.size() == (size_t)instance_->getNodesCount());
+  loadOrder(order);
+  best_order_ = tour_->getOrder();
+  best_length_ = tour_length_;
+  return true;
+}
+
+void TspLinKernighan::loadOrder(const std::vector<uint> &order) {
+  tour_->load(order);
+  tour_length_ = 0;
+  for(uint i = 0; i < order.size(); i++){
+    tour_length_ += instance_->getDistance(order[i], order[(i + 1) % order.size()]);
+  }
+  active_nodes_.clear();
+  is_active_.assign(order.size(), false);
+  for(const uint node : order){
+    activate(node);
+  }
+}
+
+std::shared_ptr<Solution>
+TspLinKernighan::convertSolution(const std::vector<uint> &order) {
+  TspIndividualStructured empty(instance_.get());
+  return TspIndividualStructured(empty, order).convertSolution();
+}
+
+void TspLinKernighan::activate(uint node) {
+  if(!is_active_[node]){
+    is_active_[node] = true;
+    active_nodes_.push_back(node);
+  }
+}
+
+void TspLinKernighan::initialize(HeuristicPortfolio *portfolio) {
+  portfolio_ = portfolio;
+  poll_solution_ = portfolio->solutionPoll(this);
+  terminate_ = false;
+}
+
+bool TspLinKernighan::startUnits() {
+  auto starting_solution = portfolio_->takeStartingSolution();
+  auto initialSolution = starting_solution != nullptr ?
+      std::make_shared<TspIndividualStructured>(instance_.get(), starting_solution) :
+      std::make_shared<TspIndividualStructured>(instance_.get());
+  if(starting_solution == nullptr)
+    initialSolution->smartInitialize([this]() -> bool {return terminate_;});
+  initialSolution->evaluate();
+  auto solution = initialSolution->convertSolution();
+  portfolio_->acceptSolution(solution);
+
+  loadOrder(initialSolution->flatten());
+  best_order_ = tour_->getOrder();
+  best_length_ = tour_length_;
+  return true;
+}
+
+bool TspLinKernighan::runUnit() {
+  if(terminate_)
+    return false;
+  poll_solution_();
+  checkOutsideSolution();
+  optimize();
+
+  if(tour_length_ < best_length_){
+    best_order_ = tour_->getOrder();
+    best_length_ = tour_length_;
+    sendSolution(convertSolution(best_order_));
+  }
+  else if(tour_length_ > best_length_){
+    // revert to the best local optimum
+    tour_->load(best_order_);
+    tour_length_ = best_length_;
+  }
+  kick();
+  return true;
+}
+
+void TspLinKernighan::optimize() {
+  while(!active_nodes_.empty() && !terminate_){
+    const uint node = active_nodes_.front();
+    active_nodes_.pop_front();
+    is_active_[node] = false;
+    improveNode(node);
+  }
+}
+
+bool TspLinKernighan::isAdded(uint a, uint b) const {
+  for(const auto &flip : flips_){
+    if((flip.t2 == a && flip.t3 == b) || (flip.t2 == b && flip.t3 == a))
+      return true;
+  }
+  return false;
+}
+
+bool TspLinKernighan::improveNode(uint t1) {
+  for(int side = 0; side < 2; side++){
+    uint t2 = side == 0 ? tour_->next(t1) : tour_->prev(t1);
+    // gain of the chain without the closing edge (t1, t2)
+    long gain = instance_->getDistance(t1, t2);
+    long best_gain = 0;
+    size_t best_depth = 0;
+    flips_.clear();
+
+    while(flips_.size() < max_depth_){
+      const bool forward = tour_->next(t1) == t2;
+      const uint *candidates = instance_->getCandidates(t2);
+      const uint *candidate_distances = instance_->getCandidateDistances(t2);
+      long best_value = std::numeric_limits<long>::min();
+      uint best_t3 = 0, best_t4 = 0;
+      for(uint k = 0; k < candidate_count_; k++){
+        const uint t3 = candidates[k];
+        const long partial_gain = gain - candidate_distances[k];
+        if(partial_gain <= 0)
+          break; // candidates are sorted by distance
+        if(t3 == t1)
+          continue;
+        const uint t4 = forward ? tour_->prev(t3) : tour_->next(t3);
+        if(t4 == t2 || isAdded(t3, t4))
+          continue;
+        // choose the flip with the best gain after removing (t3, t4)
+        const long value = partial_gain + instance_->getDistance(t3, t4);
+        if(value > best_value){
+          best_value = value;
+          best_t3 = t3;
+          best_t4 = t4;
+        }
+      }
+      if(best_value == std::numeric_limits<long>::min())
+        break;
+
+      tour_->flip(t1, t2, best_t3, best_t4);
+      flips_.push_back({t2, best_t3, best_t4});
+      gain = best_value;
+      const long closed_gain = gain - instance_->getDistance(best_t4, t1);
+      if(closed_gain > best_gain){
+        best_gain = closed_gain;
+        best_depth = flips_.size();
+      }
+      t2 = best_t4;
+    }
+
+    // undo flips after the best closed tour
+    while(flips_.size() > best_depth){
+      const auto &flip = flips_.back();
+      tour_->flip(t1, flip.t4, flip.t3, flip.t2);
+      flips_.pop_back();
+    }
+    if(best_gain > 0){
+      tour_length_ -= best_gain;
+      activate(t1);
+      for(const auto &flip : flips_){
+        activate(flip.t2);
+        activate(flip.t3);
+        activate(flip.t4);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+void TspLinKernighan::kick() {
+  const uint size = tour_->size();
+  if(size < 8)
+    return;
+  const uint max_length = std::min(50u, size / 4);
+  std::uniform_int_distribution<uint> length_dist(1, max_length);
+  std::uniform_int_distribution<uint> node_dist(0, size - 1);
+  const uint length1 = length_dist(gen_);
+  const uint length2 = length_dist(gen_);
+
+  // before [first1..last1] [first2..last2] after
+  const uint before = node_dist(gen_);
+  const uint first1 = tour_->next(before);
+  uint last1 = first1;
+  for(uint i = 1; i < length1; i++)
+    last1 = tour_->next(last1);
+  const uint first2 = tour_->next(last1);
+  uint last2 = first2;
+  for(uint i = 1; i < length2; i++)
+    last2 = tour_->next(last2);
+  const uint after = tour_->next(last2);
+
+  tour_length_ += (long)instance_->getDistance(before, first2) + instance_->getDistance(last2, first1) + instance_->getDistance(last1, after);
+  tour_length_ -= (long)instance_->getDistance(before, first1) + instance_->getDistance(last1, first2) + instance_->getDistance(last2, after);
+  // reverse both segments together and then each of them back
+  tour_->flip(before, first1, after, last2);
+  tour_->flip(before, last2, last1, first2);
+  tour_->flip(after, first1, last2, last1);
+
+  for(const uint node : {before, first1, last1, first2, last2, after}){
+    activate(node);
+  }
+}
+
+void TspLinKernighan::terminate() {
+  terminate_.store(true);
+}
+
+void TspLinKernighan::acceptSolution(std::shared_ptr<Solution> solution) {
+  if(checkBetterSolution(solution)){
+    std::lock_guard<std::recursive_mutex> lock(solution_mutex_);
+    outside_solution_ = solution;
+  }
+}
@@ -8,7 +8,6 @@ TspLocalSearch::TspLocalSearch(
   instance_ = instance;
   best_solution_ = nullptr;
   terminate_ = false;
-  matrix_ = instance->getMatrix().get();
   local_search_ = nullptr;
   mutation_ = mutation;
 }
@@ -27,6 +26,7 @@ void TspLocalSearch::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<TspIndividual>(individual);
     auto solution = individual_->convertSolution();
@@ -61,15 +61,24 @@ bool TspLocalSearch::checkBetterSolution(
   return false;
 }
 
-void TspLocalSearch::run(){
+bool TspLocalSearch::startUnits() {
   std::random_device rand;
   std::mt19937 gen(rand());
-  std::shared_ptr<TspIndividual> initialSolution = std::make_shared<TspIndividual>(instance_.get());
-  initialSolution->initializeNearestNeighbor();
+  auto starting_solution = portfolio_->takeStartingSolution();
+  std::shared_ptr<TspIndividual> initialSolution = starting_solution != nullptr ?
+      std::make_shared<TspIndividual>(instance_.get(), starting_solution) :
+      std::make_shared<TspIndividual>(instance_.get());
+  if(starting_solution == nullptr)
+    initialSolution->initializeNearestNeighbor();
   //std::shuffle(initialSolution->data().begin(), initialSolution->data().end(), gen);
   initialSolution->evaluate();
   auto solution = initialSolution->convertSolution();
   if(checkBetterSolution(solution))
     portfolio_->acceptSolution(solution);
-  local_search_->run(initialSolution);
+  local_search_->start(initialSolution);
+  return true;
+}
+
+bool TspLocalSearch::runUnit() {
+  return local_search_->step();
 }
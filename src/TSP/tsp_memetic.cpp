@@ -49,6 +49,7 @@ void TspMemetic::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<TspIndividualStructured>(individual);
     auto solution = individual_->convertSolution();
@@ -57,18 +58,26 @@ void TspMemetic::initialize(HeuristicPortfolio *portfolio) {
   memetic_algorithm_ = std::make_shared<MemeticAlgorithm>(callbacks, neighborhood_, mutation_, selection_, crossover_, replacement_);
 }
 
-void TspMemetic::run() {
+bool TspMemetic::startUnits() {
   auto initialPopulation = std::make_shared<Population>();
-  for(uint i = 0; i < population_size_; i++){
+  const auto starting_solutions = portfolio_->takeStartingSolutions(population_size_);
+  for(const auto &starting_solution : starting_solutions)
+    initialPopulation->addIndividual(std::make_shared<TspIndividualStructured>(instance_.get(), starting_solution));
+  for(uint i = starting_solutions.size(); i < population_size_; i++){
     auto solution = std::make_shared<TspIndividualStructured>(instance_.get());
-    solution->smartInitialize();
+    solution->smartInitialize([this]() -> bool {return terminate_;});
     initialPopulation->addIndividual(solution);
   }
   initialPopulation->evaluate();
   const auto &best_individual = std::static_pointer_cast<TspIndividualStructured>(initialPopulation->getBestIndividual());
   best_solution_ = best_individual->convertSolution();
   portfolio_->acceptSolution(best_solution_);
-  memetic_algorithm_->run(initialPopulation);
+  memetic_algorithm_->start(initialPopulation);
+  return true;
+}
+
+bool TspMemetic::runUnit() {
+  return memetic_algorithm_->step();
 }
 
 void TspMemetic::terminate() {
@@ -23,8 +23,8 @@ bool TspMutation2opt::mutate(const std::shared_ptr<Individual> &individual) {
   const uint next_node = data[(end + 1) % data.size()];
   const uint matrix_size = data.size();
 
-  const uint prev_cost = matrix_[prev_node * matrix_size + start_node] + matrix_[end_node * matrix_size + next_node];
-  const uint new_cost = matrix_[prev_node * matrix_size + end_node] + matrix_[start_node * matrix_size + next_node];
+  const uint prev_cost = instance_->getDistance(prev_node, start_node) + instance_->getDistance(end_node, next_node);
+  const uint new_cost = instance_->getDistance(prev_node, end_node) + instance_->getDistance(start_node, next_node);
   if(new_cost >= prev_cost){
     return true;
   }
@@ -41,7 +41,7 @@ bool TspMutation2opt::mutate(const std::shared_ptr<Individual> &individual) {
   return true;
 }
 
-TspMutation2opt::TspMutation2opt(const uint * const matrix) : matrix_(matrix) {
+TspMutation2opt::TspMutation2opt(const RoutingInstance * const instance) : instance_(instance) {
   gen = std::mt19937(rand());
   mutation_rate_ = 1.0;
 }
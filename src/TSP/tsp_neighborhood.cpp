@@ -1,7 +1,8 @@
 #include "TSP/tsp_neighborhood.h"
+#include <algorithm>
 #include <cassert>
 
-TspNeighborhood::TspNeighborhood() : rand_(), gen_(rand_()), dist_(0.0, 1.0) {
+TspNeighborhood::TspNeighborhood() : rand_(), gen_(rand_()), dist_(0.0, 1.0), instance_(nullptr), candidate_count_(0), partner_count_(0) {
   for(int i = 0; i < neighborhood_options::SIZE; i++){
     exhausted_[i] = false;
     try_count[i] = 1;
@@ -9,6 +10,22 @@ TspNeighborhood::TspNeighborhood() : rand_(), gen_(rand_()), dist_(0.0, 1.0) {
   }
 }
 
+TspNeighborhood::TspNeighborhood(
+    const std::shared_ptr<RoutingInstance> &instance, uint candidate_count) : TspNeighborhood() {
+  instance_ = instance;
+  candidate_count_ = std::min(candidate_count, instance->getCandidateCount());
+  partner_count_ = candidate_count_;
+  if(candidate_count_ == 0){
+    all_nodes_ = std::vector<uint>(instance->getNodesCount());
+    for(uint i = 0; i < all_nodes_.size(); i++)
+      all_nodes_[i] = i;
+    partner_count_ = all_nodes_.size();
+  }
+  positions_ = std::vector<int>(instance->getNodesCount(), -1);
+  for(auto &is_active : is_active_)
+    is_active = std::vector<bool>(instance->getNodesCount(), false);
+}
+
 Neighborhood::SearchResult
 TspNeighborhood::search(const std::shared_ptr<Individual> &individual) {
   const auto &individual_ = std::static_pointer_cast<TspIndividualStructured>(individual);
@@ -23,6 +40,10 @@ TspNeighborhood::search(const std::shared_ptr<Individual> &individual) {
     result = performSwap(individual_);
   else if(selected == neighborhood_options::RELOCATE)
     result = performRelocate(individual_);
+  else if(selected == neighborhood_options::OR_OPT)
+    result = performOrOpt(individual_);
+  else if(selected == neighborhood_options::THREE_OPT)
+    result = perform3opt(individual_);
 
   if(result){
     success(selected);
@@ -37,6 +58,13 @@ TspNeighborhood::search(const std::shared_ptr<Individual> &individual) {
 void TspNeighborhood::reset(const std::shared_ptr<Individual> &individual) {
   for(int i = 0; i < neighborhood_options::SIZE; i++)
     exhausted_[i] = false;
+
+  if(instance_ == nullptr)
+    return;
+  const auto &individual_ = std::static_pointer_cast<TspIndividualStructured>(individual);
+  const int size = (int)individual_->getData().size();
+  updatePositions(individual_, 0, size - 1);
+  activatePositions(individual_, 0, size - 1);
 }
 TspNeighborhood::neighborhood_options
 TspNeighborhood::selectNeighborhoodOption() {
@@ -81,6 +109,8 @@ void TspNeighborhood::failure(
 
 bool TspNeighborhood::perform2opt(
     const std::shared_ptr<TspIndividualStructured> &individual) {
+  if(instance_ != nullptr)
+    return perform2optGranular(individual);
   const uint size = individual->getData().size();
   bool performed = false;
   for(uint i = 0; i < size - 1; i++){
@@ -96,6 +126,8 @@ bool TspNeighborhood::perform2opt(
 }
 bool TspNeighborhood::performSwap(
     const std::shared_ptr<TspIndividualStructured> &individual) {
+  if(instance_ != nullptr)
+    return performSwapGranular(individual);
   const uint size = individual->getData().size();
   bool performed = false;
   for(uint i = 0; i < size - 2; i++){
@@ -111,6 +143,8 @@ bool TspNeighborhood::performSwap(
 
 bool TspNeighborhood::performRelocate(
     const std::shared_ptr<TspIndividualStructured> &individual) {
+  if(instance_ != nullptr)
+    return performRelocateGranular(individual);
   const uint size = individual->getData().size();
   bool performed = false;
   for(uint i = 0; i < size; i++){
@@ -125,3 +159,303 @@ bool TspNeighborhood::performRelocate(
   }
   return performed;
 }
+
+bool TspNeighborhood::performOrOpt(
+    const std::shared_ptr<TspIndividualStructured> &individual) {
+  if(instance_ != nullptr)
+    return performOrOptGranular(individual);
+  const uint size = individual->getData().size();
+  bool performed = false;
+  // single nodes are covered by relocate
+  for(uint length = 2; length <= 3 && length < size; length++){
+    for(uint i = 0; i + length <= size; i++){
+      TspIndividualSegment segment{i, i + length - 1};
+      for(uint j = 0; j <= size; j++){
+        if(j >= segment.start_idx && j <= segment.end_idx + 1)
+          continue;
+        for(int reversed = 0; reversed < 2; reversed++){
+          if(individual->testOrOptMove(segment, j, reversed)){
+            individual->performOrOptMove(segment, j, reversed);
+            performed = true;
+          }
+        }
+      }
+    }
+  }
+  return performed;
+}
+
+bool TspNeighborhood::perform3opt(
+    const std::shared_ptr<TspIndividualStructured> &individual) {
+  // segment insertion of any length is cubic without candidate lists
+  if(candidate_count_ == 0)
+    return false;
+  return perform3optGranular(individual);
+}
+
+void TspNeighborhood::updatePositions(
+    const std::shared_ptr<TspIndividualStructured> &individual, uint from,
+    uint to) {
+  const auto &data = individual->getData();
+  for(uint i = from; i <= to; i++){
+    positions_[data[i]] = (int)i;
+  }
+  positions_[0] = -1;
+}
+
+void TspNeighborhood::activatePositions(
+    const std::shared_ptr<TspIndividualStructured> &individual, int from,
+    int to) {
+  const auto &data = individual->getData();
+  from = std::max(from, 0);
+  to = std::min(to, (int)data.size() - 1);
+  for(int i = from; i <= to; i++){
+    const uint node = data[i];
+    for(int o = 0; o < neighborhood_options::SIZE; o++){
+      if(!is_active_[o][node]){
+        is_active_[o][node] = true;
+        active_nodes_[o].push_back(node);
+      }
+    }
+  }
+}
+
+bool TspNeighborhood::popActiveNode(
+    TspNeighborhood::neighborhood_options option, uint &node) {
+  if(active_nodes_[option].empty())
+    return false;
+  node = active_nodes_[option].front();
+  active_nodes_[option].pop_front();
+  is_active_[option][node] = false;
+  return true;
+}
+
+const uint *TspNeighborhood::getPartners(uint node) const {
+  return candidate_count_ > 0 ? instance_->getCandidates(node) : all_nodes_.data();
+}
+
+bool TspNeighborhood::try2optMove(
+    const std::shared_ptr<TspIndividualStructured> &individual, int start,
+    int end) {
+  if(start < 0 || start >= end || end >= (int)individual->getData().size())
+    return false;
+  TspIndividualSegment segment{(uint)start, (uint)end};
+  if(!individual->test2optMove(segment))
+    return false;
+  individual->perform2optMove(segment);
+  updatePositions(individual, segment.start_idx, segment.end_idx);
+  activatePositions(individual, start - 1, start);
+  activatePositions(individual, end, end + 1);
+  return true;
+}
+
+bool TspNeighborhood::tryOrOptMove(
+    const std::shared_ptr<TspIndividualStructured> &individual, int start,
+    int end, int idx_to, bool reversed) {
+  const int size = (int)individual->getData().size();
+  if(start < 0 || end >= size || start > end || idx_to < 0 || idx_to > size)
+    return false;
+  if(idx_to >= start && idx_to <= end + 1)
+    return false;
+  TspIndividualSegment segment{(uint)start, (uint)end};
+  if(!individual->testOrOptMove(segment, idx_to, reversed))
+    return false;
+  individual->performOrOptMove(segment, idx_to, reversed);
+
+  // changed positions are between the old and the new place of the segment
+  const int length = end - start + 1;
+  const int from = std::min(start, idx_to);
+  const int to = std::max(end + 1, idx_to) - 1;
+  const int seam = idx_to < start ? idx_to + length - 1 : idx_to - length - 1;
+  updatePositions(individual, from, to);
+  activatePositions(individual, from - 1, from);
+  activatePositions(individual, seam, seam + 1);
+  activatePositions(individual, to, to + 1);
+  return true;
+}
+
+bool TspNeighborhood::perform2optGranular(
+    const std::shared_ptr<TspIndividualStructured> &individual) {
+  const int size = (int)individual->getData().size();
+  bool performed = false;
+  uint node;
+  // one sweep over the nodes active at the start, nodes activated meanwhile wait for the next call
+  for(size_t sweep = active_nodes_[neighborhood_options::TWO_OPT].size(); sweep > 0 && popActiveNode(neighborhood_options::TWO_OPT, node); sweep--){
+    const int i = positions_[node];
+    const uint *partners = getPartners(node);
+    for(uint k = 0; k < partner_count_; k++){
+      const uint partner = partners[k];
+      if(partner == node)
+        continue;
+      // new edge node-partner replacing the edges to their successors
+      const int j_succ = positions_[partner];
+      if(try2optMove(individual, std::min(i, j_succ) + 1, std::max(i, j_succ))){
+        performed = true;
+        break; // neighbors of the node changed, it was activated again
+      }
+      // new edge node-partner replacing the edges to their predecessors
+      const int j_pred = partner == 0 ? size : positions_[partner];
+      if(try2optMove(individual, std::min(i, j_pred), std::max(i, j_pred) - 1)){
+        performed = true;
+        break;
+      }
+    }
+  }
+  return performed;
+}
+
+bool TspNeighborhood::performSwapGranular(
+    const std::shared_ptr<TspIndividualStructured> &individual) {
+  const int size = (int)individual->getData().size();
+  bool performed = false;
+  uint node;
+  for(size_t sweep = active_nodes_[neighborhood_options::SWAP].size(); sweep > 0 && popActiveNode(neighborhood_options::SWAP, node); sweep--){
+    const int i = positions_[node];
+    const uint *partners = getPartners(node);
+    bool performed_for_node = false;
+    for(uint k = 0; k < partner_count_ && !performed_for_node; k++){
+      const uint partner = partners[k];
+      if(partner == node)
+        continue;
+      // swap node with a tour neighbor of the partner
+      const int j = positions_[partner];
+      const int targets[2] = {partner == 0 ? size - 1 : j - 1, j + 1};
+      for(const int target : targets){
+        if(target < 0 || target >= size || std::abs(target - i) < 2)
+          continue;
+        if(individual->testSwapMove(i, target)){
+          individual->performSwapMove(i, target);
+          updatePositions(individual, i, i);
+          updatePositions(individual, target, target);
+          activatePositions(individual, i - 1, i + 1);
+          activatePositions(individual, target - 1, target + 1);
+          performed = true;
+          performed_for_node = true;
+          break;
+        }
+      }
+    }
+  }
+  return performed;
+}
+
+bool TspNeighborhood::performRelocateGranular(
+    const std::shared_ptr<TspIndividualStructured> &individual) {
+  const int size = (int)individual->getData().size();
+  bool performed = false;
+  uint node;
+  for(size_t sweep = active_nodes_[neighborhood_options::RELOCATE].size(); sweep > 0 && popActiveNode(neighborhood_options::RELOCATE, node); sweep--){
+    const int i = positions_[node];
+    const uint *partners = getPartners(node);
+    bool performed_for_node = false;
+    for(uint k = 0; k < partner_count_ && !performed_for_node; k++){
+      const uint partner = partners[k];
+      if(partner == node)
+        continue;
+      // move node directly after or directly before the partner
+      const int j = positions_[partner];
+      int targets[2];
+      if(partner == 0){
+        targets[0] = 0;
+        targets[1] = size - 1;
+      }
+      else if(i < j){
+        targets[0] = j;
+        targets[1] = j - 1;
+      }
+      else{
+        targets[0] = j + 1;
+        targets[1] = j;
+      }
+      for(const int target : targets){
+        if(target < 0 || target >= size || target == i)
+          continue;
+        if(individual->testRelocateMove(i, target)){
+          individual->performRelocateMove(i, target);
+          updatePositions(individual, std::min(i, target), std::max(i, target));
+          activatePositions(individual, i - 1, i + 1);
+          activatePositions(individual, target - 1, target + 1);
+          performed = true;
+          performed_for_node = true;
+          break;
+        }
+      }
+    }
+  }
+  return performed;
+}
+
+bool TspNeighborhood::performOrOptGranular(
+    const std::shared_ptr<TspIndividualStructured> &individual) {
+  const int size = (int)individual->getData().size();
+  bool performed = false;
+  uint node;
+  for(size_t sweep = active_nodes_[neighborhood_options::OR_OPT].size(); sweep > 0 && popActiveNode(neighborhood_options::OR_OPT, node); sweep--){
+    const int i = positions_[node];
+    const uint *partners = getPartners(node);
+    bool performed_for_node = false;
+    for(uint k = 0; k < partner_count_ && !performed_for_node; k++){
+      const uint partner = partners[k];
+      if(partner == node)
+        continue;
+      const int after_partner = partner == 0 ? 0 : positions_[partner] + 1;
+      const int before_partner = partner == 0 ? size : positions_[partner];
+      // segments of up to 3 nodes starting or ending with the node, inserted so that the node is next to the partner
+      for(int length = 1; length <= 3 && !performed_for_node; length++){
+        if(tryOrOptMove(individual, i, i + length - 1, after_partner, false) ||
+           tryOrOptMove(individual, i, i + length - 1, before_partner, true)){
+          performed_for_node = true;
+        }
+        else if(length > 1 && (
+            tryOrOptMove(individual, i - length + 1, i, after_partner, true) ||
+            tryOrOptMove(individual, i - length + 1, i, before_partner, false))){
+          performed_for_node = true;
+        }
+      }
+    }
+    performed = performed || performed_for_node;
+  }
+  return performed;
+}
+
+bool TspNeighborhood::perform3optGranular(
+    const std::shared_ptr<TspIndividualStructured> &individual) {
+  const auto &data = individual->getData();
+  const int size = (int)data.size();
+  bool performed = false;
+  uint node;
+  for(size_t sweep = active_nodes_[neighborhood_options::THREE_OPT].size(); sweep > 0 && popActiveNode(neighborhood_options::THREE_OPT, node); sweep--){
+    const int i = positions_[node];
+    const uint *partners = getPartners(node);
+    bool performed_for_node = false;
+    for(uint k = 0; k < partner_count_ && !performed_for_node; k++){
+      const uint partner = partners[k];
+      if(partner == node)
+        continue;
+      // insert segment node..other between partner and its successor, other being a candidate of the successor
+      const int after_partner = partner == 0 ? 0 : positions_[partner] + 1;
+      const uint next = after_partner < size ? data[after_partner] : 0;
+      const uint *next_candidates = instance_->getCandidates(next);
+      for(uint l = 0; l < candidate_count_ && !performed_for_node; l++){
+        const uint other = next_candidates[l];
+        if(other == 0)
+          continue;
+        const int j = positions_[other];
+        performed_for_node = tryOrOptMove(individual, std::min(i, j), std::max(i, j), after_partner, j < i);
+      }
+      // insert segment other..node between the predecessor of partner and partner, other being a candidate of the predecessor
+      const int before_partner = partner == 0 ? size : positions_[partner];
+      const uint prev = before_partner > 0 ? data[before_partner - 1] : 0;
+      const uint *prev_candidates = instance_->getCandidates(prev);
+      for(uint l = 0; l < candidate_count_ && !performed_for_node; l++){
+        const uint other = prev_candidates[l];
+        if(other == 0)
+          continue;
+        const int j = positions_[other];
+        performed_for_node = tryOrOptMove(individual, std::min(i, j), std::max(i, j), before_partner, j > i);
+      }
+    }
+    performed = performed || performed_for_node;
+  }
+  return performed;
+}
@@ -0,0 +1,239 @@
+#include "TSP/tsp_two_level_tour.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+TspTwoLevelTour::TspTwoLevelTour(const std::vector<uint> &order) : TspTwoLevelTour() {
+  load(order);
+}
+
+void TspTwoLevelTour::load(const std::vector<uint> &order) {
+  const uint size = order.size();
+  group_size_ = std::max(8u, (uint)std::sqrt((double)size));
+  parent_.assign(size, 0);
+  id_.assign(size, 0);
+  id_next_.assign(size, 0);
+  id_prev_.assign(size, 0);
+  segments_.clear();
+  free_segments_.clear();
+
+  for(uint start = 0; start < size; start += group_size_){
+    const uint end = std::min(start + group_size_, size);
+    const uint segment_idx = segments_.size();
+    segments_.push_back({false, order[start], order[end - 1], 0, 0, 0, end - start});
+    for(uint i = start; i < end; i++){
+      parent_[order[i]] = segment_idx;
+      id_[order[i]] = (int)(i - start);
+      if(i + 1 < end){
+        id_next_[order[i]] = order[i + 1];
+        id_prev_[order[i + 1]] = order[i];
+      }
+    }
+  }
+  segment_count_ = segments_.size();
+  for(uint s = 0; s < segment_count_; s++){
+    segments_[s].next = (s + 1) % segment_count_;
+    segments_[s].prev = (s + segment_count_ - 1) % segment_count_;
+    segments_[s].rank = s;
+  }
+}
+
+std::vector<uint> TspTwoLevelTour::getOrder() const {
+  std::vector<uint> order;
+  order.reserve(parent_.size());
+  if(parent_.empty())
+    return order;
+  uint node = logicalFirst(segments_[parent_[0]]);
+  for(uint i = 0; i < parent_.size(); i++){
+    order.push_back(node);
+    node = next(node);
+  }
+  return order;
+}
+
+uint TspTwoLevelTour::offset(uint node) const {
+  const Segment &segment = segments_[parent_[node]];
+  return segment.reversed ? id_[segment.last] - id_[node] : id_[node] - id_[segment.first];
+}
+
+uint TspTwoLevelTour::newSegment() {
+  segment_count_++;
+  if(!free_segments_.empty()){
+    const uint segment_idx = free_segments_.back();
+    free_segments_.pop_back();
+    return segment_idx;
+  }
+  segments_.emplace_back();
+  return segments_.size() - 1;
+}
+
+void TspTwoLevelTour::splitBefore(uint node) {
+  const uint s = parent_[node];
+  const uint split_offset = offset(node);
+  if(split_offset == 0)
+    return;
+  const uint t = newSegment(); // may reallocate segments_
+  Segment &segment = segments_[s];
+  Segment &part = segments_[t];
+  part.reversed = segment.reversed;
+
+  // the smaller part moves to the new segment
+  if(2 * split_offset <= segment.size){
+    // nodes before the node, new segment precedes the old one
+    if(!segment.reversed){
+      part.first = segment.first;
+      part.last = id_prev_[node];
+      segment.first = node;
+    }else{
+      part.first = id_next_[node];
+      part.last = segment.last;
+      segment.last = node;
+    }
+    part.size = split_offset;
+    part.prev = segment.prev;
+    part.next = s;
+    segments_[segment.prev].next = t;
+    segment.prev = t;
+  }else{
+    // the node and nodes after it, new segment follows the old one
+    if(!segment.reversed){
+      part.first = node;
+      part.last = segment.last;
+      segment.last = id_prev_[node];
+    }else{
+      part.first = segment.first;
+      part.last = node;
+      segment.first = id_next_[node];
+    }
+    part.size = segment.size - split_offset;
+    part.next = segment.next;
+    part.prev = s;
+    segments_[segment.next].prev = t;
+    segment.next = t;
+  }
+  segment.size -= part.size;
+
+  for(uint moved = part.first;; moved = id_next_[moved]){
+    parent_[moved] = t;
+    if(moved == part.last)
+      break;
+  }
+}
+
+void TspTwoLevelTour::tryMerge(uint segment_idx) {
+  const uint a = segment_idx;
+  const uint b = segments_[a].next;
+  if(a == b || segments_[a].size + segments_[b].size > group_size_)
+    return;
+  Segment &first = segments_[a];
+  Segment &second = segments_[b];
+
+  if(second.size <= first.size){
+    // append nodes of the second segment after the logical end of the first one
+    uint node = logicalFirst(second);
+    for(uint i = 0; i < second.size; i++){
+      const uint following = second.reversed ? id_prev_[node] : id_next_[node];
+      parent_[node] = a;
+      if(!first.reversed){
+        id_[node] = id_[first.last] + 1;
+        id_next_[first.last] = node;
+        id_prev_[node] = first.last;
+        first.last = node;
+      }else{
+        id_[node] = id_[first.first] - 1;
+        id_prev_[first.first] = node;
+        id_next_[node] = first.first;
+        first.first = node;
+      }
+      node = following;
+    }
+    first.size += second.size;
+    first.next = second.next;
+    segments_[second.next].prev = a;
+    free_segments_.push_back(b);
+  }else{
+    // prepend nodes of the first segment before the logical start of the second one
+    uint node = logicalLast(first);
+    for(uint i = 0; i < first.size; i++){
+      const uint preceding = first.reversed ? id_next_[node] : id_prev_[node];
+      parent_[node] = b;
+      if(!second.reversed){
+        id_[node] = id_[second.first] - 1;
+        id_prev_[second.first] = node;
+        id_next_[node] = second.first;
+        second.first = node;
+      }else{
+        id_[node] = id_[second.last] + 1;
+        id_next_[second.last] = node;
+        id_prev_[node] = second.last;
+        second.last = node;
+      }
+      node = preceding;
+    }
+    second.size += first.size;
+    second.prev = first.prev;
+    segments_[first.prev].next = b;
+    free_segments_.push_back(a);
+  }
+  segment_count_--;
+}
+
+void TspTwoLevelTour::updateRanks() {
+  uint s = parent_[0];
+  for(uint rank = 0; rank < segment_count_; rank++){
+    segments_[s].rank = rank;
+    s = segments_[s].next;
+  }
+}
+
+void TspTwoLevelTour::reversePath(uint from, uint to) {
+  splitBefore(from);
+  splitBefore(next(to));
+  const uint s1 = parent_[from];
+  const uint s2 = parent_[to];
+  const uint p = segments_[s1].prev;
+  const uint q = segments_[s2].next;
+  assert(p != s2 && q != s1);
+
+  // reverse the order of segments s1..s2 and their orientation
+  uint s = s1;
+  while(true){
+    Segment &segment = segments_[s];
+    const uint following = segment.next;
+    segment.reversed = !segment.reversed;
+    std::swap(segment.next, segment.prev);
+    if(s == s2)
+      break;
+    s = following;
+  }
+  segments_[s2].prev = p;
+  segments_[p].next = s2;
+  segments_[s1].next = q;
+  segments_[q].prev = s1;
+
+  // merging may free segments, the boundaries are therefore given by nodes
+  const uint before = logicalLast(segments_[p]);
+  tryMerge(parent_[from]);
+  tryMerge(parent_[before]);
+  if(segment_count_ > 4 * (parent_.size() / group_size_ + 1) || std::abs(id_[from]) > (1 << 30))
+    load(getOrder());
+  else
+    updateRanks();
+}
+
+void TspTwoLevelTour::make2optMove(uint a, uint b, uint c, uint d) {
+  assert(next(a) == b && next(c) == d);
+  // reverse the side which spans fewer segments, reversing b..c or d..a gives the same cyclic tour
+  const uint rank_b = segments_[parent_[b]].rank;
+  const uint rank_c = segments_[parent_[c]].rank;
+  uint inner_segments;
+  if(parent_[b] == parent_[c])
+    inner_segments = offset(b) <= offset(c) ? 1 : segment_count_ + 1;
+  else
+    inner_segments = (rank_c + segment_count_ - rank_b) % segment_count_ + 1;
+
+  if(2 * inner_segments <= segment_count_ + 1)
+    reversePath(b, c);
+  else
+    reversePath(d, a);
+}
@@ -1,15 +1,18 @@
 #include "VRP-TW/setup.h"
+#include <algorithm>
 #include <iostream>
 
 #include "VRP-TW/vrptw_SA_basic.h"
 #include "VRP-TW/vrptw_SA_basic_schedule.h"
 #include "VRP-TW/vrptw_SA_basic_step.h"
 #include "VRP-TW/vrptw_SA_step.h"
+#include "VRP-TW/vrptw_construction.h"
 #include "VRP-TW/vrptw_exhaustive_local_search.h"
 #include "VRP-TW/vrptw_memetic.h"
 #include "VRP-TW/vrptw_mutation_reinsert.h"
 #include "VRP-TW/vrptw_neighborhood.h"
 #include "VRP-TW/vrptw_pmx_crossover_structured.h"
+#include "VRP-TW/vrptw_ruin_recreate.h"
 #include "VRP-TW/vrptw_simulated_annealing.h"
 #include "common/SA_schedule_functions.h"
 #include "common/optal_comms.h"
@@ -18,30 +21,57 @@
 #include "heuristic_framework/truncation_replacement.h"
 
 std::shared_ptr<HeuristicPortfolio>
-SetupVRPTW::preparePortfolio(const JSON &config, const char *instance_filename) {
+SetupVRPTW::preparePortfolio(const JSON &config, const char *instance_filename,
+                            const std::shared_ptr<ThreadScheduling> &scheduling) {
   auto portfolio = std::make_shared<HeuristicPortfolio>();
-  auto instance = std::make_shared<RoutingInstance>();
-  instance->loadSolomonInstance(instance_filename);
+  portfolio->setScheduling(scheduling);
+  auto shared_instance = std::make_shared<RoutingInstance>();
+  shared_instance->loadSolomonInstance(instance_filename);
+
+  // Candidate lists for granular neighborhoods and ruin and recreate ("candidates" in heuristic config),
+  // "dont_look_bits" alone enables node-centered search over all nodes
+  uint candidate_count = 0;
+  for(const auto &heur_config : config){
+    if(heur_config.contains("candidates"))
+      candidate_count = std::max(candidate_count, heur_config["candidates"].get<uint>());
+    else if(heur_config["type"] == "ruin_recreate")
+      candidate_count = std::max(candidate_count, 30u);
+  }
+  if(candidate_count > 0)
+    shared_instance->buildCandidateLists(candidate_count);
 
   //Optal communication thread (it has heuristic interface / optal is basically one of the heuristics)
-  auto serializer = std::make_shared<SolutionSerializer>();
+  auto serializer = std::make_shared<SolutionSerializer>(shared_instance);
   auto optalComms = std::make_shared<OptalComms>(serializer);
-  portfolio->addImprovingHeuristic(optalComms);
+  portfolio->addSolutionListener(optalComms, {{"type", "optal"}});
 
   for(uint h = 0; h < config.size(); h++){
     auto heur_config = config[h];
+    // with replicated distances every heuristic works on its own copy of the instance
+    const auto replica = scheduling->replicateDistances() ? std::make_shared<RoutingInstance>(*shared_instance) : nullptr;
+    const auto &instance = replica != nullptr ? replica : shared_instance;
     if(!heur_config.contains("type"))
       std::cerr << "Heuristic config doesn't contain type." << std::endl;
     if(heur_config["type"] == "exhaustive_local_search"){
-      auto neighborhood = std::make_shared<VrptwNeighborhood>();
+      auto neighborhood = heur_config.contains("candidates") || heur_config.value("dont_look_bits", false) ?
+          std::make_shared<VrptwNeighborhood>(instance, heur_config.value("candidates", 0u)) :
+          std::make_shared<VrptwNeighborhood>();
+      if(heur_config.contains("route_pruning"))
+        neighborhood->setRoutePruning(*instance, heur_config["route_pruning"].get<double>());
       auto localSearch = std::make_shared<VrptwExhaustiveLocalSearch>(instance, neighborhood);
-      portfolio->addImprovingHeuristic(localSearch);
+      portfolio->addImprovingHeuristic(localSearch, replica, heur_config);
     }
     else if(heur_config["type"] == "simulated_annealing_basic"){
       auto step = std::make_shared<VrptwSABasicStep>();
       auto schedule = std::make_shared<VrptwSABasicSchedule>(10000, 20.0);
-      auto sa = std::make_shared<VrptwSABasic>(instance, step, schedule);
-      portfolio->addImprovingHeuristic(sa);
+      // "steps_per_unit": annealing steps in a unit of the heuristic
+      const uint steps_per_unit = heur_config.value("steps_per_unit", 100u);
+      if(steps_per_unit == 0){
+        std::cerr << "Invalid steps_per_unit of heuristic " << heur_config["type"] << std::endl;
+        exit(100);
+      }
+      auto sa = std::make_shared<VrptwSABasic>(instance, step, schedule, steps_per_unit);
+      portfolio->addImprovingHeuristic(sa, replica, heur_config);
     }
     else if(heur_config["type"] == "simulated_annealing"){
       auto step = std::make_shared<VrptwSAStep>();
@@ -56,8 +86,14 @@ SetupVRPTW::preparePortfolio(const JSON &config, const char *instance_filename)
           getEquivalentPunishmentFunction(average_length, 25.0) //constraint
       );
       //auto schedule = std::make_shared<SASchedule>([](double t){return 0.01;});
-      auto sa = std::make_shared<VrptwSimulatedAnnealing>(instance, step, schedule);
-      portfolio->addImprovingHeuristic(sa);
+      // "steps_per_unit": annealing steps in a unit of the heuristic
+      const uint steps_per_unit = heur_config.value("steps_per_unit", 100u);
+      if(steps_per_unit == 0){
+        std::cerr << "Invalid steps_per_unit of heuristic " << heur_config["type"] << std::endl;
+        exit(100);
+      }
+      auto sa = std::make_shared<VrptwSimulatedAnnealing>(instance, step, schedule, steps_per_unit);
+      portfolio->addImprovingHeuristic(sa, replica, heur_config);
     }
     else if(heur_config["type"] == "memetic_algorithm"){
       auto mutation = std::make_shared<VrptwMutationReinsert>();
@@ -65,7 +101,11 @@ SetupVRPTW::preparePortfolio(const JSON &config, const char *instance_filename)
       auto selection = std::make_shared<TournamentSelection>(3);
       auto crossover = std::make_shared<VrptwPmxCrossoverStructured>();
       crossover->setCrossoverRate(0.8);
-      auto neighborhood = std::make_shared<VrptwNeighborhood>();
+      auto neighborhood = heur_config.contains("candidates") || heur_config.value("dont_look_bits", false) ?
+          std::make_shared<VrptwNeighborhood>(instance, heur_config.value("candidates", 0u)) :
+          std::make_shared<VrptwNeighborhood>();
+      if(heur_config.contains("route_pruning"))
+        neighborhood->setRoutePruning(*instance, heur_config["route_pruning"].get<double>());
       auto replacement = std::make_shared<TruncationReplacement>();
       auto memetic_algorithm = std::make_shared<VrptwMemetic>(
           instance,
@@ -76,14 +116,30 @@ SetupVRPTW::preparePortfolio(const JSON &config, const char *instance_filename)
           replacement,
           10
       );
-      portfolio->addImprovingHeuristic(memetic_algorithm);
+      portfolio->addImprovingHeuristic(memetic_algorithm, replica, heur_config);
+    }else if(heur_config["type"] == "ruin_recreate"){
+      auto ruinRecreate = std::make_shared<VrptwRuinRecreate>(instance, RuinRecreateConfig(heur_config, *instance));
+      portfolio->addImprovingHeuristic(ruinRecreate, replica, heur_config);
+    }else if(heur_config["type"] == "construction"){
+      // starting solutions built once, in parallel with the other constructions, for the improving heuristics
+      const std::string algorithm = heur_config.value("algorithm", "nearest_neighbor");
+      if(algorithm != "nearest_neighbor" && algorithm != "random"){
+        std::cerr << "Unknown construction algorithm: " << algorithm << std::endl;
+        exit(101);
+      }
+      auto construction = std::make_shared<VrptwConstruction>(
+          instance,
+          algorithm == "random" ? RANDOM_CONSTRUCTION : NEAREST_NEIGHBOR_CONSTRUCTION,
+          heur_config.value("solutions", 1u)
+      );
+      portfolio->addConstructiveHeuristic(construction, replica, heur_config);
     }else{
       std::cerr << "Unknown heuristic type: " << heur_config["type"] << std::endl;
       exit(101);
     }
   }
 
-  std::cerr << "Heuristic vehicle count " << instance->getVehicleCount() << std::endl;
+  std::cerr << "Heuristic vehicle count " << shared_instance->getVehicleCount() << std::endl;
 
 
   return portfolio;
@@ -4,14 +4,16 @@
 
 VrptwSABasic::VrptwSABasic(const std::shared_ptr<RoutingInstance> &instance,
                            const std::shared_ptr<SABasicStep> &step,
-                           const std::shared_ptr<SABasicSchedule> schedule) {
+                           const std::shared_ptr<SABasicSchedule> schedule,
+                           uint steps_per_unit) {
   instance_ = instance;
   step_ = step;
   schedule_ = schedule;
+  steps_per_unit_ = steps_per_unit;
   best_solution_ = nullptr;
   terminate_ = false;
   sa_basic_ = nullptr;
-  assert(instance != nullptr && step != nullptr && schedule != nullptr);
+  assert(instance != nullptr && step != nullptr && schedule != nullptr && steps_per_unit > 0);
 }
 
 void VrptwSABasic::sendSolution(const std::shared_ptr<Solution> &solution) {
@@ -20,7 +22,7 @@ void VrptwSABasic::sendSolution(const std::shared_ptr<Solution> &solution) {
 
   uint count = 0;
   for(const auto &r: solution->routes){
-    if(r.route_nodes.size() > 2)
+    if(r.node_count > 2)
       count++;
   }
 
@@ -48,6 +50,7 @@ void VrptwSABasic::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<VrptwIndividualStructured>(individual);
     auto solution = individual_->convertSolution();
@@ -68,11 +71,24 @@ void VrptwSABasic::acceptSolution(std::shared_ptr<Solution> solution) {
   }
 }
 
-void VrptwSABasic::run() {
-  auto initialSolution = std::make_shared<VrptwIndividualStructured>(instance_.get());
-  initialSolution->smartInitialize();
+bool VrptwSABasic::startUnits() {
+  auto starting_solution = portfolio_->takeStartingSolution();
+  auto initialSolution = starting_solution != nullptr ?
+      std::make_shared<VrptwIndividualStructured>(instance_.get(), starting_solution) :
+      std::make_shared<VrptwIndividualStructured>(instance_.get());
+  if(starting_solution == nullptr)
+    initialSolution->smartInitialize();
   initialSolution->evaluate();
   auto solution = initialSolution->convertSolution();
   portfolio_->acceptSolution(solution);
-  sa_basic_->run(initialSolution);
+  sa_basic_->start(initialSolution);
+  return true;
+}
+
+bool VrptwSABasic::runUnit() {
+  for(uint i = 0; i < steps_per_unit_; i++){
+    if(!sa_basic_->step())
+      return false;
+  }
+  return true;
 }
@@ -17,7 +17,7 @@ void VrptwExhaustiveLocalSearch::sendSolution(
 
   uint count = 0;
   for(const auto &r: solution->routes){
-    if(r.route_nodes.size() > 2)
+    if(r.node_count > 2)
       count++;
   }
   std::cerr << "solution routes: " << count << std::endl;
@@ -46,6 +46,7 @@ void VrptwExhaustiveLocalSearch::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<VrptwIndividualStructured>(individual);
     auto solution = individual_->convertSolution();
@@ -68,11 +69,20 @@ void VrptwExhaustiveLocalSearch::acceptSolution(
   }
 }
 
-void VrptwExhaustiveLocalSearch::run() {
-  auto initialSolution = std::make_shared<VrptwIndividualStructured>(instance_.get());
-  initialSolution->smartInitialize();
+bool VrptwExhaustiveLocalSearch::startUnits() {
+  auto starting_solution = portfolio_->takeStartingSolution();
+  auto initialSolution = starting_solution != nullptr ?
+      std::make_shared<VrptwIndividualStructured>(instance_.get(), starting_solution) :
+      std::make_shared<VrptwIndividualStructured>(instance_.get());
+  if(starting_solution == nullptr)
+    initialSolution->smartInitialize();
   initialSolution->evaluate();
   auto solution = initialSolution->convertSolution();
   portfolio_->acceptSolution(solution);
-  local_search_->run(initialSolution);
+  local_search_->start(initialSolution);
+  return true;
+}
+
+bool VrptwExhaustiveLocalSearch::runUnit() {
+  return local_search_->step();
 }
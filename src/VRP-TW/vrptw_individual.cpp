@@ -4,11 +4,11 @@
 #include <limits>
 
 VrptwIndividual::VrptwIndividual(const RoutingInstance *const instance) :
-  instance_(instance), matrix_(instance->getMatrix().get()), data_(), is_evaluated_(false),
+  instance_(instance), data_(), is_evaluated_(false),
   fitness_(std::numeric_limits<double>::max()), total_constraint_violation_(0), constraint_violations_(2, 0.0){}
 
 VrptwIndividual::VrptwIndividual(const VrptwIndividual &other) :
-  instance_(other.instance_), matrix_(other.matrix_), data_(other.data_), is_evaluated_(other.is_evaluated_),
+  instance_(other.instance_), data_(other.data_), is_evaluated_(other.is_evaluated_),
   fitness_(other.fitness_), total_constraint_violation_(other.total_constraint_violation_), constraint_violations_(other.constraint_violations_){}
 
 VrptwIndividual::VrptwIndividual(const RoutingInstance *const instance,
@@ -28,7 +28,7 @@ VrptwIndividual::VrptwIndividual(const RoutingInstance *const instance,
     data_[i] = depot_alias;
     i++;
     depot_alias++;
-    for(const auto &node: route.route_nodes){
+    for(const auto &node: solution->routeNodes(route)){
       if(node.idx == 0) //skip depots
         continue;
       data_[i] = node.idx;
@@ -170,13 +170,15 @@ std::shared_ptr<Solution> VrptwIndividual::convertSolution() {
   solution->objective = 0;
   solution->feasible = true;
 
+  solution->reserve(instance_->getVehicleCount(), data_.size() + instance_->getVehicleCount());
+
   //initialize first route
-  solution->routes.emplace_back();
+  solution->addRoute();
   SolutionNode first_node;
   first_node.idx = 0;
   first_node.start_time = 0;
   first_node.end_time = 0;
-  solution->routes.back().route_nodes.push_back(first_node);
+  solution->addNode(first_node);
 
   uint i = (zero_idx + 1) % data_.size();
   uint prev_node = 0;
@@ -199,7 +201,7 @@ std::shared_ptr<Solution> VrptwIndividual::convertSolution() {
     node.start_time = time;
     time += nodes[cur_node].service_time;
     node.end_time = time;
-    solution->routes.back().route_nodes.push_back(node);
+    solution->addNode(node);
 
     if (cur_node == 0) { // end of route
       // finish route
@@ -213,8 +215,8 @@ std::shared_ptr<Solution> VrptwIndividual::convertSolution() {
       solution->end_time_sum += time;
       solution->travel_time_sum += travel_time;
       // initialize next route
-      solution->routes.emplace_back();
-      solution->routes.back().route_nodes.push_back(first_node);
+      solution->addRoute();
+      solution->addNode(first_node);
 
       time = 0;
       travel_time = 0;
@@ -234,7 +236,7 @@ std::shared_ptr<Solution> VrptwIndividual::convertSolution() {
   node.idx = 0;
   node.start_time = time;
   node.end_time = time;
-  solution->routes.back().route_nodes.push_back(node);
+  solution->addNode(node);
 
   solution->routes.back().travel_time = travel_time;
   solution->routes.back().end_time = time;
@@ -48,6 +48,7 @@ void VrptwMemetic::initialize(HeuristicPortfolio *portfolio) {
   callbacks->setTerminationCondition([this]() -> bool {
     return terminate_;
   });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
   callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
     auto individual_ = std::static_pointer_cast<VrptwIndividualStructured>(individual);
     auto solution = individual_->convertSolution();
@@ -56,9 +57,12 @@ void VrptwMemetic::initialize(HeuristicPortfolio *portfolio) {
   memetic_algorithm_ = std::make_shared<MemeticAlgorithm>(callbacks, neighborhood_, mutation_, selection_, crossover_, replacement_);
 }
 
-void VrptwMemetic::run() {
+bool VrptwMemetic::startUnits() {
   auto initialPopulation = std::make_shared<Population>();
-  for(uint i = 0; i < population_size_; i++){
+  const auto starting_solutions = portfolio_->takeStartingSolutions(population_size_);
+  for(const auto &starting_solution : starting_solutions)
+    initialPopulation->addIndividual(std::make_shared<VrptwIndividualStructured>(instance_.get(), starting_solution));
+  for(uint i = starting_solutions.size(); i < population_size_; i++){
     auto solution = std::make_shared<VrptwIndividualStructured>(instance_.get());
     solution->smartInitialize();
     initialPopulation->addIndividual(solution);
@@ -67,7 +71,12 @@ void VrptwMemetic::run() {
   const auto &best_individual = std::static_pointer_cast<VrptwIndividualStructured>(initialPopulation->getBestIndividual());
   best_solution_ = best_individual->convertSolution();
   portfolio_->acceptSolution(best_solution_);
-  memetic_algorithm_->run(initialPopulation);
+  memetic_algorithm_->start(initialPopulation);
+  return true;
+}
+
+bool VrptwMemetic::runUnit() {
+  return memetic_algorithm_->step();
 }
 
 void VrptwMemetic::terminate() {
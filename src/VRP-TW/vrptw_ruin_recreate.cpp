@@ -0,0 +1,83 @@
+#include "VRP-TW/vrptw_ruin_recreate.h"
+#include <iostream>
+
+VrptwRuinRecreateOperators::VrptwRuinRecreateOperators(
+    const RoutingInstance *instance, const RuinRecreateParameters &parameters) :
+  RoutingRuinRecreateOperators(instance, parameters.vehicle_cost, parameters.violation_cost) {}
+
+double VrptwRuinRecreateOperators::getCost(Individual &individual) {
+  auto &individual_ = static_cast<VrptwIndividualStructured &>(individual);
+  return individual_.getFitness() + vehicle_cost_ * individual_.getVehiclesUsed() +
+         violation_cost_ * individual_.getTotalConstraintViolation();
+}
+
+VrptwRuinRecreate::VrptwRuinRecreate(
+    const std::shared_ptr<RoutingInstance> &instance, const RuinRecreateConfig &config) : parameters_(config.getParameters()) {
+  instance_ = instance;
+  best_solution_ = nullptr;
+  portfolio_ = nullptr;
+  terminate_ = false;
+}
+
+void VrptwRuinRecreate::sendSolution(const std::shared_ptr<Solution> &solution) {
+  if(solution == nullptr || portfolio_ == nullptr)
+    return;
+  portfolio_->acceptSolution(solution);
+}
+
+bool VrptwRuinRecreate::checkBetterSolution(
+    const std::shared_ptr<Solution> &solution) {
+  if(solution->objective < 0) { // integer overflow
+    std::cerr << "Integer overflow encountered in VRP-TW ruin and recreate solution value" << std::endl;
+    return false;
+  }
+  std::lock_guard<std::recursive_mutex> lock(solution_mutex_);
+  if(best_solution_ == nullptr || solution->betterThan(*best_solution_)){
+    best_solution_ = solution;
+    return true;
+  }
+  return false;
+}
+
+void VrptwRuinRecreate::initialize(HeuristicPortfolio *portfolio) {
+  portfolio_ = portfolio;
+  terminate_ = false;
+  std::shared_ptr<Callbacks> callbacks = std::make_shared<Callbacks>();
+  callbacks->setTerminationCondition([this]() -> bool {
+    return terminate_;
+  });
+  callbacks->setOutsideSolutionPoll(portfolio->solutionPoll(this));
+  callbacks->addNewBestSolutionCallback([this](const std::shared_ptr<Individual> &individual) {
+    sendSolution(std::static_pointer_cast<VrptwIndividualStructured>(individual)->convertSolution());
+  });
+  auto operators = std::make_shared<VrptwRuinRecreateOperators>(instance_.get(), parameters_);
+  ruin_recreate_ = std::make_shared<RuinRecreate>(callbacks, operators, parameters_);
+}
+
+bool VrptwRuinRecreate::startUnits() {
+  auto starting_solution = portfolio_->takeStartingSolution();
+  auto initial_solution = starting_solution != nullptr ?
+      std::make_shared<VrptwIndividualStructured>(instance_.get(), starting_solution) :
+      std::make_shared<VrptwIndividualStructured>(instance_.get());
+  if(starting_solution == nullptr)
+    initial_solution->smartInitialize();
+  initial_solution->evaluate();
+  portfolio_->acceptSolution(initial_solution->convertSolution());
+  ruin_recreate_->start(initial_solution);
+  return true;
+}
+
+bool VrptwRuinRecreate::runUnit() {
+  return ruin_recreate_->step();
+}
+
+void VrptwRuinRecreate::terminate() {
+  terminate_.store(true);
+}
+
+void VrptwRuinRecreate::acceptSolution(std::shared_ptr<Solution> solution) {
+  if(checkBetterSolution(solution)){
+    auto individual = std::make_shared<VrptwIndividualStructured>(instance_.get(), solution);
+    ruin_recreate_->acceptOutsideSolution(individual);
+  }
+}
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <limits>
 #include <random>
 
 VrptwIndividualStructured::VrptwIndividualStructured(
@@ -10,42 +11,19 @@ VrptwIndividualStructured::VrptwIndividualStructured(
 VrptwIndividualStructured::VrptwIndividualStructured(
     const RoutingInstance *const instance,
     const std::shared_ptr<Solution> &solution) : VrptwIndividualStructured(instance) {
-  const auto &nodes = instance->getNodes();
   uint r = 0;
   for(const auto &route: solution->routes){
-    routes_[r].time = route.end_time;
-    routes_[r].demand = route.demand;
-    routes_[r].travel_time = route.travel_time;
-    routes_[r].customers.reserve(route.route_nodes.size() - 2);
-    routes_[r].time_violation = 0;
-
-    uint time = 0;
-    uint travel_time = 0;
-    uint demand = 0;
-    uint prev_node = 0;
-    for(const auto customer: route.route_nodes){
-      if(customer.idx == 0){
-        continue;
-      }
-      demand += nodes[customer.idx].demand;
-      time += instance->getDistance(prev_node, customer.idx);
-      if(time > (uint)nodes[customer.idx].due_date){
-        //infeasible due to time constraints
-        routes_[r].time_violation += time - (uint)nodes[customer.idx].due_date;
-      }
-      time = std::max(time, (uint)nodes[customer.idx].ready_time);
-      travel_time += instance->getDistance(prev_node, customer.idx);
-
-      routes_[r].customers.emplace_back(customer.idx, travel_time, time, demand);
-      time += nodes[customer.idx].service_time;
-      prev_node = customer.idx;
+    routes_[r].customers.reserve(route.node_count - 2);
+    for(const auto customer: solution->routeNodes(route)){
+      if(customer.idx != 0)
+        routes_[r].customers.emplace_back(customer.idx);
     }
-    time += instance->getDistance(prev_node, 0);
-    travel_time += instance->getDistance(prev_node, 0);
-    assert(time == (uint)route.end_time);
-    assert(travel_time == (uint)route.travel_time);
-    total_time_ += time;
-    total_travel_time_ += travel_time;
+    evaluateRoute(routes_[r]);
+    assert(routes_[r].travel_time == (uint)route.travel_time);
+    // end times of infeasible routes depend on how their lateness was propagated
+    assert(routes_[r].time_violation > 0 || routes_[r].time == (uint)route.end_time);
+    total_time_ += routes_[r].time;
+    total_travel_time_ += routes_[r].travel_time;
     timeViolation() += routes_[r].time_violation;
     capacityViolation() += std::max(0, (int)routes_[r].demand - instance->getVehicleCapacity());
     r++;
@@ -82,28 +60,27 @@ std::shared_ptr<Solution> VrptwIndividualStructured::convertSolution() {
   solution->travel_time_sum = (int)total_travel_time_;
   solution->end_time_sum = (int)total_time_;
   solution->objective = solution->travel_time_sum;
+  solution->reserve(routes_.size(), instance_->getNodesCount() - 1 + 2 * routes_.size());
 
-  SolutionNode first_node(0, 0, 0);
   const auto &nodes = instance_->getNodes();
 
   for(int r = 0; r < (int)routes_.size(); r++){
     const auto &route = routes_[r];
-    solution->routes.emplace_back();
-    auto &sol_route = solution->routes.back();
+    auto &sol_route = solution->addRoute();
     sol_route.demand = (int)route.demand;
     sol_route.travel_time = (int)route.travel_time;
     sol_route.end_time = (int)route.time;
-    sol_route.route_nodes.push_back(first_node);
+    solution->addNode(0, 0, 0);
 
     uint prev_node = 0;
     for(uint i = 0; i < route.customers.size(); i++){
       const auto &customer = route.customers[i];
-      sol_route.route_nodes.emplace_back(customer.idx, customer.time_up_to, customer.time_up_to + nodes[customer.idx].service_time);
+      solution->addNode(customer.idx, customer.time_up_to, customer.time_up_to + nodes[customer.idx].service_time);
       //sol_route.travel_time += instance_->getDistance(prev_node, customer.idx);
       prev_node = customer.idx;
     }
 
-    sol_route.route_nodes.emplace_back(0, sol_route.end_time, sol_route.end_time);
+    solution->addNode(0, sol_route.end_time, sol_route.end_time);
     //sol_route.travel_time += instance_->getDistance(prev_node, 0);
     //solution->travel_time_sum += sol_route.travel_time;
     //solution->end_time_sum += sol_route.end_time;
@@ -118,7 +95,10 @@ std::shared_ptr<Solution> VrptwIndividualStructured::convertSolution() {
 
 void VrptwIndividualStructured::initialize() {
   routes_ = std::vector<VrptwIndividualRoute>(instance_->getVehicleCount());
-  const auto &nodes = instance_->getNodes();
+  const uint *demands = instance_->getDemands();
+  const int *ready_times = instance_->getReadyTimes();
+  const int *due_dates = instance_->getDueDates();
+  const int *service_times = instance_->getServiceTimes();
 
   // randomly shuffle customers
   std::random_device rand;
@@ -136,20 +116,20 @@ void VrptwIndividualStructured::initialize() {
     for(uint c = first_unassigned_customer; c < customers.size(); c++){
       if(customers[c] == 0)
         continue; //already assigned
-      if(routes_[r].demand + nodes[customers[c]].demand > (uint)instance_->getVehicleCapacity() && (uint)r != routes_.size() - 1)
+      if(routes_[r].demand + demands[customers[c]] > (uint)instance_->getVehicleCapacity() && (uint)r != routes_.size() - 1)
         continue; //violates capacity constraint and is not the last vehicle
 
       uint prev_node = routes_[r].customers.empty() ? 0 : routes_[r].customers.back().idx;
       const uint time_after = routes_[r].time + instance_->getDistance(prev_node, customers[c]);
-      if(time_after > (uint)nodes[customers[c]].due_date){
+      if(time_after > (uint)due_dates[customers[c]]){
         if((uint)r != routes_.size() - 1)
           continue; // violates time constraints and is not the last vehicle
-        routes_[r].time_violation += time_after - nodes[customers[c]].due_date;
+        routes_[r].time_violation += time_after - due_dates[customers[c]];
       }
 
-      routes_[r].time = std::max(time_after, (uint)nodes[customers[c]].ready_time) + (uint)nodes[customers[c]].service_time;
+      routes_[r].time = std::max(time_after, (uint)ready_times[customers[c]]) + (uint)service_times[customers[c]];
       routes_[r].travel_time += instance_->getDistance(prev_node, customers[c]);
-      routes_[r].demand += nodes[customers[c]].demand;
+      routes_[r].demand += demands[customers[c]];
       routes_[r].customers.emplace_back(customers[c], routes_[r].travel_time, routes_[r].time, routes_[r].demand);
       customers[c] = 0;
       if(first_unassigned_customer == c)
@@ -159,51 +139,122 @@ void VrptwIndividualStructured::initialize() {
     routes_[r].time += instance_->getDistance(prev_node, 0);
   }
 
-  // calculate final stats for the whole solution
-  capacityViolation() = 0;
-  timeViolation() = 0;
-  total_time_ = 0;
-  for(uint r = 0; r < routes_.size(); r++){
-    if(!routes_[r].customers.empty())
-      vehicles_used_++;
-    total_time_ += routes_[r].time;
-    total_travel_time_ += routes_[r].travel_time;
-    capacityViolation() += std::max(0, (int)routes_[r].demand - instance_->getVehicleCapacity());
-    timeViolation() += routes_[r].time_violation;
+  // final stats for the whole solution, with the time window data of the routes
+  evaluate();
+}
+
+bool VrptwIndividualStructured::nearestNeighborInitialize(const std::function<bool()> &should_terminate) {
+  routes_ = std::vector<VrptwIndividualRoute>(instance_->getVehicleCount());
+  const uint *demands = instance_->getDemands();
+  const int *ready_times = instance_->getReadyTimes();
+  const int *due_dates = instance_->getDueDates();
+  const int *service_times = instance_->getServiceTimes();
+  const uint nodes_count = instance_->getNodesCount();
+  const uint capacity = instance_->getVehicleCapacity();
+
+  std::random_device rand;
+  std::mt19937 gen(rand());
+  std::uniform_int_distribution<uint> dist(1, nodes_count - 1);
+  std::vector<bool> served(nodes_count, false);
+  served[0] = true;
+  uint unserved_count = nodes_count - 1;
+
+  for(uint r = 0; r < routes_.size() && unserved_count > 0; r++){
+    auto &route = routes_[r];
+    const bool last_route = r == routes_.size() - 1;
+    // a random first customer diversifies the constructed solutions
+    uint next_node = dist(gen);
+    while(served[next_node])
+      next_node = next_node % (nodes_count - 1) + 1;
+    uint prev_node = 0;
+    uint time = 0;
+    uint demand = 0;
+    while(next_node != 0){
+      if(should_terminate()){
+        initialize();
+        return false;
+      }
+      served[next_node] = true;
+      unserved_count--;
+      time = std::max(time + instance_->getDistance(prev_node, next_node), (uint)ready_times[next_node]) +
+             (uint)service_times[next_node];
+      demand += demands[next_node];
+      route.customers.emplace_back(next_node);
+      prev_node = next_node;
+
+      next_node = 0;
+      uint best_delay = std::numeric_limits<uint>::max();
+      const uint *row = instance_->getDistanceRow(prev_node);
+      for(uint c = 1; c < nodes_count && unserved_count > 0; c++){
+        if(served[c])
+          continue;
+        const uint arrival = time + (row != nullptr ? row[c] : instance_->getDistance(prev_node, c));
+        if(!last_route && (arrival > (uint)due_dates[c] || demand + demands[c] > capacity))
+          continue;
+        const uint delay = std::max(arrival, (uint)ready_times[c]) - time;
+        if(delay < best_delay){
+          best_delay = delay;
+          next_node = c;
+        }
+      }
+    }
   }
-  is_evaluated_ = true;
+  evaluate();
+  return true;
 }
 
-void VrptwIndividualStructured::evaluateRoute(uint route_idx) {
-  auto &route = routes_[route_idx];
-  const auto &nodes = instance_->getNodes();
+void VrptwIndividualStructured::evaluateRoute(VrptwIndividualRoute &route, uint first_idx, uint changed_end) {
+  const uint *demands = instance_->getDemands();
+  const int *ready_times = instance_->getReadyTimes();
+  const int *due_dates = instance_->getDueDates();
+  const int *service_times = instance_->getServiceTimes();
+  auto &customers = route.customers;
 
-  route.time = 0;
   route.demand = 0;
   route.travel_time = 0;
-  route.time_violation = 0;
+  VrptwTimeWindowSegment time_windows = VrptwTimeWindowSegment::routeStart();
   uint prev_node = 0;
-  for(uint c = 0; c < route.customers.size(); c++){
-    auto &customer = route.customers[c];
-    const uint dist = instance_->getDistance(prev_node, customer.idx);
-    route.time = std::max(route.time + dist, (uint)nodes[customer.idx].ready_time);
+  if(first_idx > 0){
+    const auto &prev_customer = customers[first_idx - 1];
+    route.demand = prev_customer.demand_up_to;
+    route.travel_time = prev_customer.travel_time_up_to;
+    time_windows = prev_customer.time_windows_up_to;
+    prev_node = prev_customer.idx;
+  }
+  for(uint c = first_idx; c < customers.size(); c++){
+    auto &customer = customers[c];
+    const uint node = customer.idx;
+    const uint dist = instance_->getDistance(prev_node, node);
     route.travel_time += dist;
-    route.demand += (uint)nodes[customer.idx].demand;
-    customer.time_up_to = route.time;
+    route.demand += demands[node];
+    time_windows = time_windows.concatenate(VrptwTimeWindowSegment::visit(ready_times[node], due_dates[node], service_times[node]), (int)dist);
+    customer.time_up_to = (uint)(time_windows.endTime() - service_times[node]);
     customer.travel_time_up_to = route.travel_time;
     customer.demand_up_to = route.demand;
-
-    if(route.time > (uint)nodes[customer.idx].due_date){
-      route.time_violation += route.time - (uint)nodes[customer.idx].due_date;
-    }
-    route.time += (uint)nodes[customer.idx].service_time;
-
-    prev_node = customer.idx;
+    customer.time_windows_up_to = time_windows;
+    prev_node = node;
   }
 
   const uint dist = instance_->getDistance(prev_node, 0);
-  route.time += dist;
   route.travel_time += dist;
+  time_windows = time_windows.concatenate(VrptwTimeWindowSegment::routeEnd(), (int)dist);
+  route.time = (uint)time_windows.endTime();
+  route.time_violation = (uint)time_windows.time_warp;
+
+  changed_end = std::min(changed_end, (uint)customers.size());
+  VrptwTimeWindowSegment time_windows_from = VrptwTimeWindowSegment::routeEnd();
+  uint next_node = 0;
+  if(changed_end < customers.size()){
+    time_windows_from = customers[changed_end].time_windows_from;
+    next_node = customers[changed_end].idx;
+  }
+  for(int c = (int)changed_end - 1; c >= 0; c--){
+    auto &customer = customers[c];
+    const uint node = customer.idx;
+    time_windows_from = VrptwTimeWindowSegment::visit(ready_times[node], due_dates[node], service_times[node]).concatenate(time_windows_from, (int)instance_->getDistance(node, next_node));
+    customer.time_windows_from = time_windows_from;
+    next_node = node;
+  }
 }
 void VrptwIndividualStructured::smartInitialize() { initialize(); }
 void VrptwIndividualStructured::resetEvaluated() { is_evaluated_ = false; }
@@ -249,7 +300,7 @@ void VrptwIndividualStructured::evaluate() {
   capacityViolation() = 0;
 
   for(uint r = 0; r < routes_.size(); r++){
-    evaluateRoute(r);
+    evaluateRoute(routes_[r]);
     if(!routes_[r].customers.empty())
       vehicles_used_++;
     total_time_ += routes_[r].time;
@@ -296,7 +347,7 @@ void VrptwIndividualStructured::perform2optMove(
   const int prev_time = (int)route.time;
   const int prev_travel_time = (int)route.travel_time;
   const int prev_time_violation = (int)route.time_violation;
-  evaluateRoute(segment.route_idx);
+  evaluateRoute(route, segment.segment_start_idx, segment.segment_start_idx + segment.segment_length);
   assertEvaluation(route);
 
   total_time_ += (route.time - prev_time);
@@ -304,80 +355,63 @@ void VrptwIndividualStructured::perform2optMove(
   timeViolation() += ((int)route.time_violation - prev_time_violation);
 }
 
-VrptwIndividualRoute VrptwIndividualStructured::insertSegment(
-    const VrptwIndividualRoute &to_route,
-    const VrptwIndividualRoute &from_route,
-    const VrptwRouteSegment &remove_segment,
-    const VrptwRouteSegment &insert_segment) {
-  const auto &nodes = instance_->getNodes();
-  VrptwIndividualRoute new_route;
-  new_route.customers.reserve(to_route.customers.size() - remove_segment.segment_length + insert_segment.segment_length);
-  new_route.time = 0;
-  new_route.travel_time = 0;
-  new_route.time_violation = 0;
-  new_route.demand = 0;
-  uint prev_node = 0;
-  // Insert nodes before removed segment
-  for(uint i = 0; i < (uint)remove_segment.segment_start_idx; i++){
-    const uint cur_node = to_route.customers[i].idx;
-    new_route.time += instance_->getDistance(prev_node, cur_node);
-    new_route.travel_time += instance_->getDistance(prev_node, cur_node);
-    if(new_route.time > (uint)nodes[cur_node].due_date)
-      new_route.time_violation += new_route.time - (uint)nodes[cur_node].due_date;
-    new_route.demand += nodes[cur_node].demand;
-    new_route.time = std::max(new_route.time, (uint)nodes[cur_node].ready_time);
-    new_route.customers.emplace_back(cur_node, new_route.travel_time, new_route.time,
-                                     new_route.demand);
-    new_route.time += nodes[cur_node].service_time;
-    prev_node = cur_node;
-  }
-
-  // Insert nodes from insert segment
-  for(uint i = insert_segment.segment_start_idx; i < insert_segment.segment_start_idx + insert_segment.segment_length; i++){
-    const uint cur_node = from_route.customers[i].idx;
-    new_route.time += instance_->getDistance(prev_node, cur_node);
-    new_route.travel_time += instance_->getDistance(prev_node, cur_node);
-    if(new_route.time > (uint)nodes[cur_node].due_date)
-      new_route.time_violation += new_route.time - (uint)nodes[cur_node].due_date;
-    new_route.demand += nodes[cur_node].demand;
-    new_route.time = std::max(new_route.time, (uint)nodes[cur_node].ready_time);
-    new_route.customers.emplace_back(cur_node, new_route.travel_time, new_route.time,
-                                     new_route.demand);
-    new_route.time += nodes[cur_node].service_time;
-    prev_node = cur_node;
-  }
+/** Nodes of the swapped or inserted segments, kept between the moves so that their capacity is reused */
+static thread_local std::vector<uint> segment_nodes[2];
 
-  // Insert nodes after removed segment
-  for(uint i = remove_segment.segment_start_idx + remove_segment.segment_length; i < to_route.customers.size(); i++){
-    const uint cur_node = to_route.customers[i].idx;
-    new_route.time += instance_->getDistance(prev_node, cur_node);
-    new_route.travel_time += instance_->getDistance(prev_node, cur_node);
-    if(new_route.time > (uint)nodes[cur_node].due_date)
-      new_route.time_violation += new_route.time - (uint)nodes[cur_node].due_date;
-    new_route.demand += nodes[cur_node].demand;
-    new_route.time = std::max(new_route.time, (uint)nodes[cur_node].ready_time);
-    new_route.customers.emplace_back(cur_node, new_route.travel_time, new_route.time,
-                                     new_route.demand);
-    new_route.time += nodes[cur_node].service_time;
-    prev_node = cur_node;
+void VrptwIndividualStructured::swapSegments(
+    const VrptwRouteSegment &segment1, const VrptwRouteSegment &segment2) {
+  assert(segment1.route_idx != segment2.route_idx);
+  const VrptwRouteSegment *segments[2] = {&segment1, &segment2};
+  for(int s = 0; s < 2; s++){
+    const auto &customers = routes_[segments[s]->route_idx].customers;
+    segment_nodes[s].clear();
+    for(uint i = segments[s]->segment_start_idx; i < segments[s]->segment_start_idx + segments[s]->segment_length; i++)
+      segment_nodes[s].push_back(customers[i].idx);
   }
-
-  new_route.travel_time += instance_->getDistance(prev_node, 0);
-  new_route.time += instance_->getDistance(prev_node, 0);
-  return new_route;
+  replaceSegment(segment1, segment_nodes[1]);
+  replaceSegment(segment2, segment_nodes[0]);
 }
 
-void VrptwIndividualStructured::exchange_route(
-    const uint &route_idx, const VrptwIndividualRoute &new_route) {
-  const auto &old_route = routes_[route_idx];
-
-  total_time_ += new_route.time - old_route.time;
-  total_travel_time_ += new_route.travel_time - old_route.travel_time;
+void VrptwIndividualStructured::replaceSegment(
+    const VrptwRouteSegment &remove_segment, const std::vector<uint> &nodes) {
+  auto &route = routes_[remove_segment.route_idx];
+  auto &customers = route.customers;
   const auto &capacity = instance_->getVehicleCapacity();
-  capacityViolation() += (std::max(0, (int)new_route.demand - capacity) - std::max(0, (int)old_route.demand - capacity));
-  timeViolation() += ((int)new_route.time_violation - (int)old_route.time_violation);
-  vehicles_used_ += (old_route.customers.empty() ? 0 : -1) + (new_route.customers.empty() ? 0 : 1);
-  routes_[route_idx] = new_route;
+  total_time_ -= route.time;
+  total_travel_time_ -= route.travel_time;
+  capacityViolation() -= std::max(0, (int)route.demand - capacity);
+  timeViolation() -= route.time_violation;
+  vehicles_used_ -= customers.empty() ? 0 : 1;
+
+  // shift the rest of the route by the length difference, the customers then get the new nodes
+  const auto segment_end = customers.begin() + remove_segment.segment_start_idx + remove_segment.segment_length;
+  if(nodes.size() > remove_segment.segment_length)
+    customers.insert(segment_end, nodes.size() - remove_segment.segment_length, VrptwIndividualCustomer());
+  else if(nodes.size() < remove_segment.segment_length)
+    customers.erase(segment_end - (remove_segment.segment_length - nodes.size()), segment_end);
+  for(uint i = 0; i < nodes.size(); i++)
+    customers[remove_segment.segment_start_idx + i].idx = nodes[i];
+  evaluateRoute(route, remove_segment.segment_start_idx, remove_segment.segment_start_idx + (uint)nodes.size());
+
+  total_time_ += route.time;
+  total_travel_time_ += route.travel_time;
+  capacityViolation() += std::max(0, (int)route.demand - capacity);
+  timeViolation() += route.time_violation;
+  vehicles_used_ += customers.empty() ? 0 : 1;
+}
+
+void VrptwIndividualStructured::performRemoval(const VrptwRouteSegment &segment) {
+  assert(segment.route_idx < routes_.size());
+  assert(segment.segment_start_idx + segment.segment_length <= routes_[segment.route_idx].customers.size());
+  segment_nodes[0].clear();
+  replaceSegment(segment, segment_nodes[0]);
+}
+
+void VrptwIndividualStructured::performInsertion(const VrptwRouteSegment &target_pos, uint node) {
+  assert(target_pos.route_idx < routes_.size());
+  assert(target_pos.segment_start_idx <= routes_[target_pos.route_idx].customers.size() && target_pos.segment_length == 0);
+  segment_nodes[0].assign(1, node);
+  replaceSegment(target_pos, segment_nodes[0]);
 }
 
 void VrptwIndividualStructured::performExchangeMove(
@@ -389,22 +423,7 @@ void VrptwIndividualStructured::performExchangeMove(
   assert(segment1.segment_start_idx < route1.customers.size() && segment1.segment_start_idx + segment1.segment_length <= route1.customers.size());
   assert(segment2.segment_start_idx < route2.customers.size() && segment2.segment_start_idx + segment2.segment_length <= route2.customers.size());
 
-  auto new_route1 = insertSegment(route1, route2, segment1, segment2);
-  auto new_route2 = insertSegment(route2, route1, segment2, segment1);
-
-  /*
-  assert(new_route1.time_violation + new_route2.time_violation <= route1.time_violation + route2.time_violation);
-  assertEvaluation(route1);
-  assertEvaluation(route2);
-  assertEvaluation(new_route1);
-  assertEvaluation(new_route2);
-  if(route1.time_violation + route2.time_violation == 0){
-    assert(route1.travel_time + route2.travel_time > new_route1.travel_time + new_route2.travel_time);
-  }
-  */
-
-  exchange_route(segment1.route_idx, new_route1);
-  exchange_route(segment2.route_idx, new_route2);
+  swapSegments(segment1, segment2);
 }
 
 void VrptwIndividualStructured::performRelocateMove(
@@ -418,18 +437,7 @@ void VrptwIndividualStructured::performRelocateMove(
   assert(target_pos.segment_start_idx <= route_to.customers.size());
   assert(target_pos.segment_length == 0);
 
-  auto new_route_from = insertSegment(route_from, route_to, segment_moved, target_pos);
-  auto new_route_to = insertSegment(route_to, route_from, target_pos, segment_moved);
-  /*
-  assert(new_route_from.time_violation + new_route_to.time_violation <= route_from.time_violation + route_to.time_violation);
-  assertEvaluation(route_from);
-  assertEvaluation(route_to);
-  assertEvaluation(new_route_from);
-  assertEvaluation(new_route_to);
-  */
-
-  exchange_route(segment_moved.route_idx, new_route_from);
-  exchange_route(target_pos.route_idx, new_route_to);
+  swapSegments(segment_moved, target_pos);
 }
 
 void VrptwIndividualStructured::performCrossMove(
@@ -445,18 +453,7 @@ void VrptwIndividualStructured::performCrossMove(
   VrptwRouteSegment segment2_ = segment2;
   segment1_.segment_length = route1.customers.size() - segment1.segment_start_idx;
   segment2_.segment_length = route2.customers.size() - segment2.segment_start_idx;
-  auto new_route1 = insertSegment(route1, route2, segment1_, segment2_);
-  auto new_route2 = insertSegment(route2, route1, segment2_, segment1_);
-
-  /*
-  assert(route1.time_violation + route2.time_violation >= new_route1.time_violation + new_route2.time_violation);
-  assertEvaluation(route1);
-  assertEvaluation(route2);
-  assertEvaluation(new_route1);
-  assertEvaluation(new_route2);*/
-
-  exchange_route(segment1.route_idx, new_route1);
-  exchange_route(segment2.route_idx, new_route2);
+  swapSegments(segment1_, segment2_);
 }
 
 bool VrptwIndividualStructured::testExchangeMove(
@@ -524,25 +521,6 @@ uint VrptwIndividualStructured::getExchangeTravelTime(
   return prev_time + instance_->getDistance(prev_node, first_node) + getSegmentTravelTime(insert_segment) + instance_->getDistance(last_node, next_node) + after_time;
 }
 
-uint VrptwIndividualStructured::getArrivalTime(
-    const VrptwIndividualRoute &route, const uint &customer_idx) {
-  assert(customer_idx < route.customers.size());
-  if(customer_idx == 0)
-    return instance_->getDistance(0, route.customers[customer_idx].idx);
-
-  const auto &nodes = instance_->getNodes();
-  const auto &prev_customer = route.customers[customer_idx - 1];
-  return prev_customer.time_up_to + nodes[prev_customer.idx].service_time + instance_->getDistance(prev_customer.idx, route.customers[customer_idx].idx);
-}
-
-uint VrptwIndividualStructured::getEndTime(const VrptwIndividualRoute &route,
-                                           const int &customer_idx) {
-  if(customer_idx == -1)
-    return 0;
-  assert(customer_idx < (int)route.customers.size());
-  return route.customers[customer_idx].time_up_to + instance_->getNodes()[route.customers[customer_idx].idx].service_time;
-}
-
 bool VrptwIndividualStructured::testRelocateMove(
     const VrptwRouteSegment &segment_moved,
     const VrptwRouteSegment &target_pos) {
@@ -588,71 +566,12 @@ bool VrptwIndividualStructured::test2optMoveNoViolations(
   if(new_length >= old_length)
     return false;
 
-  const auto &nodes = instance_->getNodes();
-  uint time = getEndTime(routes_[segment.route_idx], (int)segment.segment_start_idx - 1);
-  uint prev_node = pre_node;
-  for(int c = (int)end_idx; c >= (int)segment.segment_start_idx; c--){
-    const auto &customer = customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    if(time > (uint)nodes[customer.idx].due_date)
-      return false;
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    time += nodes[customer.idx].service_time;
-    prev_node = customer.idx;
-  }
-
-
-  for(uint c = end_idx + 1; c < customers.size(); c++){
-    const auto &customer = customers[c];
-    time += instance_->getDistance(prev_node, customers[c].idx);
-    if(time < customer.time_up_to)
-      return true;
-    if(time > (uint)nodes[customer.idx].due_date)
-      return false;
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    time += nodes[customer.idx].service_time;
-    prev_node = customer.idx;
-  }
-  return true;
+  return get2optTimeWindows(segment).time_warp == 0;
 }
 
 bool VrptwIndividualStructured::test2optMoveViolation(
     const VrptwRouteSegment &segment) {
-  const auto &route = routes_[segment.route_idx];
-
-  //Find time violation of the exchanged segment
-  const auto &nodes = instance_->getNodes();
-  uint time = getEndTime(routes_[segment.route_idx], (int)segment.segment_start_idx - 1);
-  uint prev_node = segment.segment_start_idx == 0 ? 0 : route.customers[segment.segment_start_idx - 1].idx;
-  uint time_violation = 0;
-  uint prev_time_violation = 0;
-  for(int c = (int)segment.segment_start_idx + (int)segment.segment_length - 1; c >= (int)segment.segment_start_idx; c--){
-    const auto &customer = route.customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    if(time > (uint)nodes[customer.idx].due_date)
-      time_violation += time - nodes[customer.idx].due_date;
-    if(customer.time_up_to > (uint)nodes[customer.idx].due_date)
-      prev_time_violation += customer.time_up_to - nodes[customer.idx].due_date;
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    time += nodes[customer.idx].service_time;
-    prev_node += customer.idx;
-  }
-
-  for(uint c = segment.segment_start_idx + segment.segment_length; c < route.customers.size(); c++){
-    const auto &customer = route.customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    if(time > (uint)nodes[customer.idx].due_date)
-      time_violation += time - nodes[customer.idx].due_date;
-    if(customer.time_up_to > (uint)nodes[customer.idx].due_date)
-      prev_time_violation += customer.time_up_to - nodes[customer.idx].due_date;
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    if(time == customer.time_up_to)
-      break;
-    time += nodes[customer.idx].service_time;
-    prev_node += customer.idx;
-  }
-
-  return time_violation < prev_time_violation;
+  return get2optTimeWindows(segment).time_warp < (int)routes_[segment.route_idx].time_violation;
 }
 
 bool VrptwIndividualStructured::testExchangeMoveNoViolation(
@@ -716,75 +635,80 @@ bool VrptwIndividualStructured::testExchangeMoveViolation(
   return time_violation_change < 0;
 }
 
-bool VrptwIndividualStructured::exchangeViolatesTimeConstraints(
+VrptwTimeWindowSegment VrptwIndividualStructured::getSegmentTimeWindows(
+    const VrptwRouteSegment &segment, bool reversed) {
+  const auto &customers = routes_[segment.route_idx].customers;
+  const int *ready_times = instance_->getReadyTimes();
+  const int *due_dates = instance_->getDueDates();
+  const int *service_times = instance_->getServiceTimes();
+  const uint first_idx = reversed ? segment.segment_start_idx + segment.segment_length - 1 : segment.segment_start_idx;
+  const uint first_node = customers[first_idx].idx;
+  VrptwTimeWindowSegment time_windows = VrptwTimeWindowSegment::visit(ready_times[first_node], due_dates[first_node], service_times[first_node]);
+  uint prev_node = first_node;
+  for(uint i = 1; i < segment.segment_length; i++){
+    const uint cur_node = customers[reversed ? first_idx - i : first_idx + i].idx;
+    time_windows = time_windows.concatenate(VrptwTimeWindowSegment::visit(ready_times[cur_node], due_dates[cur_node], service_times[cur_node]), (int)instance_->getDistance(prev_node, cur_node));
+    prev_node = cur_node;
+  }
+  return time_windows;
+}
+
+VrptwTimeWindowSegment VrptwIndividualStructured::getExchangeTimeWindows(
     const VrptwRouteSegment &remove_segment,
     const VrptwRouteSegment &insert_segment) {
-  const auto &to_route = routes_[remove_segment.route_idx];
-  const auto &from_route = routes_[insert_segment.route_idx];
-  const auto &nodes = instance_->getNodes();
-  uint time = getEndTime(to_route, (int)remove_segment.segment_start_idx - 1);
-  uint prev_node = remove_segment.segment_start_idx > 0 ? to_route.customers[remove_segment.segment_start_idx - 1].idx : 0;
-  for(uint c = insert_segment.segment_start_idx; c < insert_segment.segment_start_idx + insert_segment.segment_length; c++){
-    const auto &customer = from_route.customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    if(time > (uint)nodes[customer.idx].due_date)
-      return true;
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    time += (uint)nodes[customer.idx].service_time;
-    prev_node = customer.idx;
+  const auto &cust_to = routes_[remove_segment.route_idx].customers;
+  const auto &cust_from = routes_[insert_segment.route_idx].customers;
+  uint prev_node = 0;
+  VrptwTimeWindowSegment time_windows = VrptwTimeWindowSegment::routeStart();
+  if(remove_segment.segment_start_idx > 0){
+    prev_node = cust_to[remove_segment.segment_start_idx - 1].idx;
+    time_windows = cust_to[remove_segment.segment_start_idx - 1].time_windows_up_to;
   }
+  const uint after_idx = remove_segment.segment_start_idx + remove_segment.segment_length;
 
-  for(uint c = remove_segment.segment_start_idx + remove_segment.segment_length; c < to_route.customers.size(); c++){
-    const auto &customer = to_route.customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    /*if(time <= customer.time_up_to)
-      break;*/
-    if(time > (uint)nodes[customer.idx].due_date)
-      return true;
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    time += (uint)nodes[customer.idx].service_time;
-    prev_node = customer.idx;
+  if(insert_segment.segment_length > 0){
+    const uint insert_end = insert_segment.segment_start_idx + insert_segment.segment_length;
+    const uint first_node = cust_from[insert_segment.segment_start_idx].idx;
+    // the insert segment brings its route end along
+    if(insert_end == cust_from.size() && after_idx == cust_to.size())
+      return time_windows.concatenate(cust_from[insert_segment.segment_start_idx].time_windows_from, (int)instance_->getDistance(prev_node, first_node));
+    time_windows = time_windows.concatenate(getSegmentTimeWindows(insert_segment, false), (int)instance_->getDistance(prev_node, first_node));
+    prev_node = cust_from[insert_end - 1].idx;
   }
-  return false;
+
+  if(after_idx < cust_to.size())
+    return time_windows.concatenate(cust_to[after_idx].time_windows_from, (int)instance_->getDistance(prev_node, cust_to[after_idx].idx));
+  return time_windows.concatenate(VrptwTimeWindowSegment::routeEnd(), (int)instance_->getDistance(prev_node, 0));
 }
-int VrptwIndividualStructured::exchangeTimeViolationChange(
-    const VrptwRouteSegment &remove_segment,
-    const VrptwRouteSegment &insert_segment) {
-  const auto &to_route = routes_[remove_segment.route_idx];
-  const auto &from_route = routes_[insert_segment.route_idx];
-  const auto &nodes = instance_->getNodes();
-  int time_violation_old = 0;
-  int time_violation_new = 0;
-  uint time = getEndTime(to_route, (int)remove_segment.segment_start_idx - 1);
-  uint prev_node = remove_segment.segment_start_idx > 0 ? to_route.customers[remove_segment.segment_start_idx - 1].idx : 0;
-  for(uint c = insert_segment.segment_start_idx; c < insert_segment.segment_start_idx + insert_segment.segment_length; c++){
-    const auto &customer = from_route.customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    if(time > (uint)nodes[customer.idx].due_date)
-      time_violation_new += (int)time - nodes[customer.idx].due_date;
-    if(customer.time_up_to > (uint)nodes[customer.idx].due_date)
-      time_violation_old += (int)customer.time_up_to - nodes[customer.idx].due_date;
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    time += (uint)nodes[customer.idx].service_time;
-    prev_node = customer.idx;
-  }
 
-  for(uint c = remove_segment.segment_start_idx + remove_segment.segment_length; c < to_route.customers.size(); c++){
-    const auto &customer = to_route.customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    if(time == customer.time_up_to)
-      break;
-    if(time > (uint)nodes[customer.idx].due_date)
-      time_violation_new += (int)time - nodes[customer.idx].due_date;
-    if(customer.time_up_to > (uint)nodes[customer.idx].due_date)
-      time_violation_old += (int)customer.time_up_to - nodes[customer.idx].due_date;
-    time += (uint)nodes[customer.idx].service_time;
-    prev_node = customer.idx;
+VrptwTimeWindowSegment VrptwIndividualStructured::get2optTimeWindows(const VrptwRouteSegment &segment) {
+  const auto &customers = routes_[segment.route_idx].customers;
+  const uint end_idx = segment.segment_start_idx + segment.segment_length - 1;
+  uint prev_node = 0;
+  VrptwTimeWindowSegment time_windows = VrptwTimeWindowSegment::routeStart();
+  if(segment.segment_start_idx > 0){
+    prev_node = customers[segment.segment_start_idx - 1].idx;
+    time_windows = customers[segment.segment_start_idx - 1].time_windows_up_to;
   }
+  time_windows = time_windows.concatenate(getSegmentTimeWindows(segment, true), (int)instance_->getDistance(prev_node, customers[end_idx].idx));
+  const uint last_node = customers[segment.segment_start_idx].idx;
+  if(end_idx + 1 < customers.size())
+    return time_windows.concatenate(customers[end_idx + 1].time_windows_from, (int)instance_->getDistance(last_node, customers[end_idx + 1].idx));
+  return time_windows.concatenate(VrptwTimeWindowSegment::routeEnd(), (int)instance_->getDistance(last_node, 0));
+}
+
+bool VrptwIndividualStructured::exchangeViolatesTimeConstraints(
+    const VrptwRouteSegment &remove_segment,
+    const VrptwRouteSegment &insert_segment) {
+  return getExchangeTimeWindows(remove_segment, insert_segment).time_warp > 0;
+}
 
-  return time_violation_new - time_violation_old;
+int VrptwIndividualStructured::exchangeTimeViolationChange(
+    const VrptwRouteSegment &remove_segment,
+    const VrptwRouteSegment &insert_segment) {
+  return getExchangeTimeWindows(remove_segment, insert_segment).time_warp - (int)routes_[remove_segment.route_idx].time_violation;
 }
+
 bool VrptwIndividualStructured::assertEvaluation(
     const VrptwIndividualRoute &route) {
   const auto &nodes = instance_->getNodes();
@@ -798,13 +722,17 @@ bool VrptwIndividualStructured::assertEvaluation(
     const auto &customer = route.customers[c];
     time += instance_->getDistance(prev_node, customer.idx);
     time = std::max(time, (uint)nodes[customer.idx].ready_time);
+    // late vehicle warps back to the due date
+    if(time > (uint)nodes[customer.idx].due_date){
+      time_violation += time - (uint)nodes[customer.idx].due_date;
+      time = (uint)nodes[customer.idx].due_date;
+    }
     travel_time += instance_->getDistance(prev_node, customer.idx);
     demand += nodes[customer.idx].demand;
     assert(time == customer.time_up_to);
     assert(travel_time == customer.travel_time_up_to);
     assert(demand == customer.demand_up_to);
-    if(time > (uint)nodes[customer.idx].due_date)
-      time_violation += time - (uint)nodes[customer.idx].due_date;
+    assert((uint)customer.time_windows_up_to.time_warp == time_violation);
     time += nodes[customer.idx].service_time;
 
     prev_node = customer.idx;
@@ -853,7 +781,7 @@ VrptwIndividualStructured::get2optMoveCost(const VrptwRouteSegment &segment) {
   assert(segment.route_idx < routes_.size());
   const auto &customers = routes_[segment.route_idx].customers;
   assert(segment.segment_start_idx < customers.size() && end_idx < customers.size());
-  uint prev_node = segment.segment_start_idx == 0 ? 0 : customers[segment.segment_start_idx - 1].idx;
+  const uint prev_node = segment.segment_start_idx == 0 ? 0 : customers[segment.segment_start_idx - 1].idx;
   const uint next_node = end_idx + 1 >= customers.size() ? 0 : customers[end_idx + 1].idx;
   const uint first_node = customers[segment.segment_start_idx].idx;
   const uint last_node = customers[end_idx].idx;
@@ -861,41 +789,8 @@ VrptwIndividualStructured::get2optMoveCost(const VrptwRouteSegment &segment) {
   const uint old_length = instance_->getDistance(prev_node, first_node) + instance_->getDistance(last_node, next_node);
   const uint new_length = instance_->getDistance(prev_node, last_node) + instance_->getDistance(first_node, next_node);
 
-  const auto &nodes = instance_->getNodes();
-  uint time = getEndTime(routes_[segment.route_idx], (int)segment.segment_start_idx - 1);;
-  uint time_violation = 0;
-  uint old_time_violation = 0;
-  for(int c = segment.segment_start_idx + segment.segment_length - 1; c >= (int)segment.segment_start_idx; c--){
-    const auto &customer = routes_[segment.route_idx].customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    if(time > (uint)nodes[customer.idx].due_date){
-      time_violation += time - nodes[customer.idx].due_date;
-    }
-    if(customer.time_up_to > (uint)nodes[customer.idx].due_date){
-      old_time_violation += customer.time_up_to - nodes[customer.idx].due_date;
-    }
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    time += nodes[customer.idx].service_time;
-    prev_node = customer.idx;
-  }
-
-  for(uint c = segment.segment_start_idx + segment.segment_length; c < customers.size(); c++){
-    const auto &customer = routes_[segment.route_idx].customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    if(time > (uint)nodes[customer.idx].due_date){
-      time_violation += time - nodes[customer.idx].due_date;
-    }
-    if(customer.time_up_to > (uint)nodes[customer.idx].due_date){
-      old_time_violation += customer.time_up_to - nodes[customer.idx].due_date;
-    }
-    if(time == customer.time_up_to)
-      break;
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    time += nodes[customer.idx].service_time;
-    prev_node = customer.idx;
-  }
-
-  return {(int)new_length - (int)old_length, (int)time_violation - (int)old_time_violation, 0};
+  const int time_violation_change = get2optTimeWindows(segment).time_warp - (int)routes_[segment.route_idx].time_violation;
+  return {(int)new_length - (int)old_length, time_violation_change, 0};
 }
 
 FitnessDiff VrptwIndividualStructured::getExchangeMoveCost(
@@ -957,6 +852,50 @@ VrptwIndividualStructured::getCrossMoveCost(const VrptwRouteSegment &segment1,
   return getExchangeMoveCost(segment1_, segment2_);
 }
 
+FitnessDiff VrptwIndividualStructured::getRemovalCost(const VrptwRouteSegment &segment) {
+  assert(segment.route_idx < routes_.size());
+  const auto &route = routes_[segment.route_idx];
+  assert(segment.segment_start_idx + segment.segment_length <= route.customers.size());
+  const auto &capacity = instance_->getVehicleCapacity();
+  const int demand_violation_old = std::max(0, (int)route.demand - capacity);
+  const int demand_violation_new = std::max(0, (int)route.demand - (int)getSegmentDemand(segment) - capacity);
+  const VrptwRouteSegment empty_segment = {segment.route_idx, 0, 0};
+  const int time_violation_change = exchangeTimeViolationChange(segment, empty_segment);
+  const bool emptied = segment.segment_length > 0 && segment.segment_length == route.customers.size();
+  return {
+      (int)getExchangeTravelTime(segment, empty_segment) - (int)route.travel_time,
+      time_violation_change + demand_violation_new - demand_violation_old,
+      emptied ? -1 : 0
+  };
+}
+
+FitnessDiff VrptwIndividualStructured::getInsertionCost(const VrptwRouteSegment &target_pos, uint node) {
+  assert(target_pos.route_idx < routes_.size());
+  const auto &route = routes_[target_pos.route_idx];
+  const auto &customers = route.customers;
+  const uint pos = target_pos.segment_start_idx;
+  assert(pos <= customers.size() && target_pos.segment_length == 0);
+  const uint prev_node = pos == 0 ? 0 : customers[pos - 1].idx;
+  const uint next_node = pos == customers.size() ? 0 : customers[pos].idx;
+  const int dist_to = (int)instance_->getDistance(prev_node, node);
+  const int dist_from = (int)instance_->getDistance(node, next_node);
+
+  const VrptwTimeWindowSegment time_windows_before = pos == 0 ? VrptwTimeWindowSegment::routeStart() : customers[pos - 1].time_windows_up_to;
+  const VrptwTimeWindowSegment time_windows_after = pos == customers.size() ? VrptwTimeWindowSegment::routeEnd() : customers[pos].time_windows_from;
+  const VrptwTimeWindowSegment visit = VrptwTimeWindowSegment::visit(instance_->getReadyTimes()[node], instance_->getDueDates()[node], instance_->getServiceTimes()[node]);
+  const int time_violation_change = time_windows_before.concatenate(visit, dist_to).concatenate(time_windows_after, dist_from).time_warp -
+                                    (int)route.time_violation;
+
+  const auto &capacity = instance_->getVehicleCapacity();
+  const int demand_violation_old = std::max(0, (int)route.demand - capacity);
+  const int demand_violation_new = std::max(0, (int)(route.demand + instance_->getDemands()[node]) - capacity);
+  return {
+      dist_to + dist_from - (int)instance_->getDistance(prev_node, next_node),
+      time_violation_change + demand_violation_new - demand_violation_old,
+      customers.empty() ? 1 : 0
+  };
+}
+
 FitnessDiff VrptwIndividualStructured::getFitnessDiff(
     const VrptwIndividualStructured &other) {
   return {
@@ -965,26 +904,3 @@ FitnessDiff VrptwIndividualStructured::getFitnessDiff(
       (int)vehicles_used_ - (int)other.vehicles_used_
   };
 }
-
-std::pair<uint, uint> VrptwIndividualStructured::andvanceSegmentTimeViolation(
-    const VrptwRouteSegment &segment, const uint &prev_customer,
-    const std::pair<uint, uint> &prev_time_violation,
-    bool terminate_on_match) {
-  const auto &nodes = instance_->getNodes();
-  uint time = prev_time_violation.first;
-  uint prev_node = prev_customer;
-  uint time_violation = prev_time_violation.second;
-  for(uint c = segment.segment_start_idx; c < segment.segment_start_idx + segment.segment_length; c++){
-    const auto &customer = routes_[segment.route_idx].customers[c];
-    time += instance_->getDistance(prev_node, customer.idx);
-    if(time > (uint)nodes[customer.idx].due_date){
-      time_violation += time - nodes[customer.idx].due_date;
-    }
-    time = std::max(time, (uint)nodes[customer.idx].ready_time);
-    if(terminate_on_match && time == customer.time_up_to)
-      return {time, time_violation};
-    time += nodes[customer.idx].service_time;
-    prev_node = customer.idx;
-  }
-  return {time, time_violation};
-}
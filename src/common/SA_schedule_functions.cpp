@@ -20,12 +20,13 @@ std::function<double(double)> getLinearSchedule(double initial_temperature,
 }
 
 double getAverageEdgeLength(const RoutingInstance &instance) {
-  const uint * const matrix = instance.getMatrix().get();
   const uint node_count = instance.getNodesCount();
   double sum = 0.0;
-  for(uint i = 0; i < node_count; i++)
+  for(uint i = 0; i < node_count; i++){
+    const uint *row = instance.getDistanceRow(i);
     for(uint j = i + 1; j < node_count; j++)
-      sum += matrix[i * node_count + j];
+      sum += row != nullptr ? row[j] : instance.getDistance(i, j);
+  }
   return sum / (node_count * (node_count - 1) / 2);
 }
 
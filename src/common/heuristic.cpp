@@ -0,0 +1,49 @@
+#include "common/heuristic.h"
+
+void Heuristic::run() {
+  if(!startUnits())
+    return;
+  const auto start = std::chrono::steady_clock::now();
+  unsigned long units = 0;
+  while(true){
+    // terminating the portfolio resumes the paused heuristics, runUnit then returns false
+    while(!waitWhilePaused(std::chrono::milliseconds(100))){}
+    if(!runUnit())
+      break;
+    units++;
+    if(budgetExhausted(start, units)){
+      terminate();
+      break;
+    }
+  }
+}
+
+void Heuristic::pause() {
+  paused_ = true;
+}
+
+void Heuristic::resume() {
+  {
+    std::lock_guard<std::mutex> lock(pause_lock_);
+    paused_ = false;
+  }
+  pause_condition_.notify_all();
+}
+
+bool Heuristic::waitWhilePaused(std::chrono::milliseconds timeout) {
+  if(!paused_)
+    return true;
+  std::unique_lock<std::mutex> lock(pause_lock_);
+  return pause_condition_.wait_for(lock, timeout, [this](){ return !paused_;});
+}
+
+void Heuristic::setBudget(double seconds, unsigned long units) {
+  time_budget_ = seconds;
+  unit_budget_ = units;
+}
+
+bool Heuristic::budgetExhausted(std::chrono::steady_clock::time_point start, unsigned long units) const {
+  if(unit_budget_ > 0 && units >= unit_budget_)
+    return true;
+  return time_budget_ > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= time_budget_;
+}
@@ -0,0 +1,153 @@
+#include "common/instance_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+size_t RoutingInstance::InstanceCache::alignedSize(size_t bytes) {
+  return (bytes + alignment_ - 1) / alignment_ * alignment_;
+}
+
+std::string RoutingInstance::InstanceCache::cacheFilename(const char *filename) {
+  std::string basename(filename);
+  const auto slash_idx = basename.rfind('/');
+  if(slash_idx != std::string::npos)
+    basename = basename.substr(slash_idx + 1);
+  return cache_directory_ + "/" + basename + ".cache";
+}
+
+uint64_t RoutingInstance::InstanceCache::checksum(const MappedFile &source, uint64_t source_format) {
+  // multiply-rotate hash over 8-byte words, runs at memory speed
+  constexpr uint64_t prime = 0x9e3779b97f4a7c15;
+  uint64_t hash = (source_format + source.size()) * prime;
+  const char *data = source.data();
+  size_t i = 0;
+  for(; i + 8 <= source.size(); i += 8){
+    uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    hash = ((hash ^ word) * prime);
+    hash ^= hash >> 29;
+  }
+  for(; i < source.size(); i++)
+    hash = (hash ^ (unsigned char)data[i]) * prime;
+  return hash ^ (hash >> 32);
+}
+
+bool RoutingInstance::InstanceCache::load(RoutingInstance &instance) {
+  auto cache = std::make_shared<MappedFile>(instance.cache_filename_.c_str());
+  if(!cache->isOpen() || cache->size() < sizeof(Header))
+    return false;
+  Header header{};
+  std::memcpy(&header, cache->data(), sizeof(Header));
+  if(header.magic != magic_ || header.version != version_ || header.header_size != sizeof(Header) ||
+     header.source_checksum != instance.source_checksum_)
+    return false;
+  size_t expected_size = alignedSize(sizeof(Header));
+  for(uint64_t bytes : header.section_bytes)
+    expected_size += alignedSize(bytes);
+  if(cache->size() != expected_size)
+    return false;
+
+  const char *sections[SECTION_COUNT];
+  const char *position = cache->data() + alignedSize(sizeof(Header));
+  for(int s = 0; s < SECTION_COUNT; s++){
+    sections[s] = position;
+    position += alignedSize(header.section_bytes[s]);
+  }
+  const auto copySection = [&](auto &vector, Section section){
+    using Element = typename std::remove_reference_t<decltype(vector)>::value_type;
+    const auto *first = reinterpret_cast<const Element *>(sections[section]);
+    vector.assign(first, first + header.section_bytes[section] / sizeof(Element));
+  };
+
+  instance.instance_name_ = std::string(sections[NAME], header.section_bytes[NAME]);
+  instance.comment_ = std::string(sections[COMMENT], header.section_bytes[COMMENT]);
+  instance.problem_type_ = (ProblemType)header.problem_type;
+  instance.edge_weight_type_ = (EdgeWeightType)header.edge_weight_type;
+  instance.edge_weight_format_ = (EdgeWeightFormat)header.edge_weight_format;
+  instance.display_data_type_ = (DisplayDataType)header.display_data_type;
+  instance.vehicle_capacity_ = header.vehicle_capacity;
+  instance.vehicle_count_ = header.vehicle_count;
+  instance.node_count_ = header.node_count;
+  instance.distance_storage_ = (DistanceStorage)header.distance_storage;
+  instance.compact_distances_ = header.compact_distances != 0;
+  instance.stride_ = header.stride;
+  instance.candidate_count_ = header.candidate_count;
+  copySection(instance.nodes_, NODES);
+  copySection(instance.depots_, DEPOTS);
+  copySection(instance.coord_x_, COORD_X);
+  copySection(instance.coord_y_, COORD_Y);
+  copySection(instance.row_offsets_, ROW_OFFSETS);
+  copySection(instance.candidates_, CANDIDATES);
+  copySection(instance.candidate_distances_, CANDIDATE_DISTANCES);
+
+  // the matrix stays in the mapped file, which is kept alive by the matrix pointers
+  instance.matrix_ = nullptr;
+  instance.compact_matrix_ = nullptr;
+  instance.distance_rows_ = nullptr;
+  if(header.section_bytes[MATRIX] > 0){
+    instance.matrix_ = std::shared_ptr<uint[]>(cache, reinterpret_cast<uint *>(const_cast<char *>(sections[MATRIX])));
+    instance.matrix_size_ = header.section_bytes[MATRIX] / sizeof(uint);
+  }
+  if(header.section_bytes[COMPACT_MATRIX] > 0){
+    instance.compact_matrix_ = std::shared_ptr<uint16_t[]>(cache, reinterpret_cast<uint16_t *>(const_cast<char *>(sections[COMPACT_MATRIX])));
+    instance.matrix_size_ = header.section_bytes[COMPACT_MATRIX] / sizeof(uint16_t);
+  }
+  if(instance.distance_storage_ == FULL_MATRIX_STORAGE && !instance.compact_distances_)
+    instance.distance_rows_ = instance.matrix_.get();
+  return true;
+}
+
+void RoutingInstance::InstanceCache::save(const RoutingInstance &instance) {
+  Header header{};
+  header.magic = magic_;
+  header.version = version_;
+  header.header_size = sizeof(Header);
+  header.source_checksum = instance.source_checksum_;
+  header.problem_type = instance.problem_type_;
+  header.edge_weight_type = instance.edge_weight_type_;
+  header.edge_weight_format = instance.edge_weight_format_;
+  header.display_data_type = instance.display_data_type_;
+  header.vehicle_capacity = instance.vehicle_capacity_;
+  header.vehicle_count = instance.vehicle_count_;
+  header.node_count = instance.node_count_;
+  header.distance_storage = instance.distance_storage_;
+  header.compact_distances = instance.compact_distances_;
+  header.candidate_count = instance.candidate_count_;
+  header.stride = instance.stride_;
+
+  const char *sections[SECTION_COUNT];
+  const auto setSection = [&](Section section, const void *data, size_t bytes){
+    sections[section] = static_cast<const char *>(data);
+    header.section_bytes[section] = bytes;
+  };
+  setSection(NAME, instance.instance_name_.data(), instance.instance_name_.size());
+  setSection(COMMENT, instance.comment_.data(), instance.comment_.size());
+  setSection(NODES, instance.nodes_.data(), instance.nodes_.size() * sizeof(Node));
+  setSection(DEPOTS, instance.depots_.data(), instance.depots_.size() * sizeof(uint));
+  setSection(COORD_X, instance.coord_x_.data(), instance.coord_x_.size() * sizeof(double));
+  setSection(COORD_Y, instance.coord_y_.data(), instance.coord_y_.size() * sizeof(double));
+  const bool matrix_stored = instance.distance_storage_ != COORDINATE_STORAGE;
+  setSection(MATRIX, instance.matrix_.get(), matrix_stored && !instance.compact_distances_ ? instance.matrix_size_ * sizeof(uint) : 0);
+  setSection(COMPACT_MATRIX, instance.compact_matrix_.get(), matrix_stored && instance.compact_distances_ ? instance.matrix_size_ * sizeof(uint16_t) : 0);
+  setSection(ROW_OFFSETS, instance.row_offsets_.data(), instance.row_offsets_.size() * sizeof(size_t));
+  setSection(CANDIDATES, instance.candidates_.data(), instance.candidates_.size() * sizeof(uint));
+  setSection(CANDIDATE_DISTANCES, instance.candidate_distances_.data(), instance.candidate_distances_.size() * sizeof(uint));
+
+  const std::string temporary_filename = instance.cache_filename_ + ".tmp" + std::to_string(getpid());
+  std::ofstream file(temporary_filename, std::ios::binary | std::ios::trunc);
+  const char padding[alignment_] = {};
+  file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  file.write(padding, (std::streamsize)(alignedSize(sizeof(Header)) - sizeof(Header)));
+  for(int s = 0; s < SECTION_COUNT; s++){
+    if(header.section_bytes[s] > 0)
+      file.write(sections[s], (std::streamsize)header.section_bytes[s]);
+    file.write(padding, (std::streamsize)(alignedSize(header.section_bytes[s]) - header.section_bytes[s]));
+  }
+  file.close();
+  if(!file || std::rename(temporary_filename.c_str(), instance.cache_filename_.c_str()) != 0){
+    std::cerr << "Couldn't write instance cache " << instance.cache_filename_ << std::endl;
+    std::remove(temporary_filename.c_str());
+  }
+}
@@ -43,3 +43,8 @@ void ObjectiveValueLogger::log(const Solution &solution) {
     std::cerr << "Log file is closed when trying to log a solution." << std::endl;
   }
 }
+
+void ObjectiveValueLogger::logComment(const std::string &lines) {
+  if(file_ && file_.is_open())
+    file_ << lines << std::flush;
+}
@@ -0,0 +1,97 @@
+#include "common/mapped_file.h"
+#include <charconv>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const char *filename) : data_(nullptr), size_(0), pos_(nullptr), end_(nullptr), buffer_(),
+  is_mapped_(false), is_open_(false) {
+  const int fd = open(filename, O_RDONLY);
+  if(fd < 0)
+    return;
+  struct stat file_stat{};
+  if(fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0){
+    void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapped != MAP_FAILED){
+      madvise(mapped, file_stat.st_size, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(mapped);
+      size_ = file_stat.st_size;
+      is_mapped_ = true;
+    }
+  }
+  close(fd);
+
+  if(!is_mapped_){
+    std::ifstream file(filename, std::ios::binary);
+    if(!file.is_open())
+      return;
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+  }
+  pos_ = data_;
+  end_ = data_ + size_;
+  is_open_ = true;
+}
+
+MappedFile::~MappedFile() {
+  if(is_mapped_)
+    munmap(const_cast<char *>(data_), size_);
+}
+
+void MappedFile::skipSpaces() {
+  while(pos_ < end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\v' || *pos_ == '\f'))
+    pos_++;
+}
+
+bool MappedFile::nextLine(std::string_view &line) {
+  if(pos_ >= end_)
+    return false;
+  const char *line_end = pos_;
+  while(line_end < end_ && *line_end != '\n')
+    line_end++;
+  line = std::string_view(pos_, line_end - pos_);
+  if(!line.empty() && line.back() == '\r')
+    line.remove_suffix(1);
+  pos_ = line_end < end_ ? line_end + 1 : end_;
+  return true;
+}
+
+void MappedFile::skipLine() {
+  while(pos_ < end_ && *pos_ != '\n')
+    pos_++;
+  if(pos_ < end_)
+    pos_++;
+}
+
+bool MappedFile::nextInt(int &value) {
+  skipSpaces();
+  const auto result = std::from_chars(pos_, end_, value);
+  if(result.ec != std::errc())
+    return false;
+  pos_ = result.ptr;
+  return true;
+}
+
+bool MappedFile::nextUInt(unsigned int &value) {
+  skipSpaces();
+  const auto result = std::from_chars(pos_, end_, value);
+  if(result.ec != std::errc())
+    return false;
+  pos_ = result.ptr;
+  return true;
+}
+
+bool MappedFile::nextDouble(double &value) {
+  skipSpaces();
+  // from_chars does not accept the plus sign allowed by the stream extraction
+  const char *start = pos_ < end_ && *pos_ == '+' ? pos_ + 1 : pos_;
+  const auto result = std::from_chars(start, end_, value);
+  if(result.ec != std::errc())
+    return false;
+  pos_ = result.ptr;
+  return true;
+}
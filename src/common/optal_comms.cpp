@@ -1,29 +1,50 @@
 #include "common/optal_comms.h"
 #include <iostream>
 #include <mutex>
+#include <thread>
+
+std::string OptalComms::channel_name_;
+
+/** Longest wait for a solution from the shared memory channel before checking the termination */
+constexpr int channel_timeout_ms = 10;
 
 OptalComms::OptalComms(const std::shared_ptr<SolutionSerializer> &serializer){
   serializer_ = serializer;
   portfolio_ = nullptr;
   terminate_ = false;
   best_solution_ = nullptr;
+  pending_solution_ = nullptr;
+  written_all_ = false;
+  written_count_ = 0;
+  coalesced_count_ = 0;
+  dropped_count_ = 0;
+  channel_ = nullptr;
+  if(!channel_name_.empty()){
+    channel_ = std::make_unique<SharedMemoryChannel>(channel_name_, (uint32_t)serializer->maxPayloadSize());
+    if(!channel_->isOpen())
+      exit(102);
+  }
+}
 
+void OptalComms::setSharedMemoryChannel(const std::string &name) {
+  channel_name_ = name;
 }
 
 void OptalComms::initialize(HeuristicPortfolio *portfolio){
   portfolio_ = portfolio;
   terminate_ = false;
   best_solution_ = nullptr;
+  pending_solution_ = nullptr;
+  written_all_ = false;
 }
 
 void OptalComms::run() {
+  std::thread writer(&OptalComms::writeSolutions, this);
   while(!terminate_){
-    std::string solution_string;
     std::shared_ptr<Solution> new_solution = nullptr;
 
-    if(std::getline(std::cin, solution_string)){
+    if(readSolution(new_solution)){
       //received solution from Optal
-      new_solution = serializer_->parseSolution(solution_string);
       if(new_solution == nullptr)
         continue;
 
@@ -44,24 +65,82 @@ void OptalComms::run() {
     //received solution is BSF solution
     sendSolution(new_solution);
   }
+  writer.join();
+  std::cerr << "Optal communication: " << written_count_ << " solutions written, " << coalesced_count_
+            << " coalesced, " << dropped_count_ << " dropped" << std::endl;
+}
+
+void OptalComms::writeSolutions() {
+  std::unique_lock<std::mutex> lock(solution_lock_);
+  while(true){
+    pending_condition_.wait(lock, [this]() -> bool {
+      return pending_solution_ != nullptr || terminate_;
+    });
+    if(pending_solution_ == nullptr)
+      break; // terminated and the mailbox is drained
+
+    std::shared_ptr<Solution> solution = pending_solution_;
+    pending_solution_ = nullptr;
+    lock.unlock();
+    if(channel_ != nullptr)
+      channel_->send(serializer_->encodeSolution(*solution));
+    else
+      serializer_->writeSolution(std::cout, solution);
+    written_count_++;
+    lock.lock();
+    // a burst of solutions goes out in one flush
+    if(pending_solution_ == nullptr && channel_ == nullptr)
+      std::cout.flush();
+  }
+  std::cout.flush();
+  written_all_ = true;
+  written_condition_.notify_all();
+}
+
+bool OptalComms::readSolution(std::shared_ptr<Solution> &solution) {
+  if(channel_ == nullptr)
+    return serializer_->readSolution(std::cin, solution);
+
+  solution = nullptr;
+  std::string payload;
+  if(!channel_->receive(payload, channel_timeout_ms))
+    return false;
+  if(!payload.empty())
+    solution = serializer_->decodeSolution(payload);
+  return true;
 }
 
 void OptalComms::acceptSolution(std::shared_ptr<Solution> solution) {
-  if(!solution->feasible)
+  if(!solution->feasible){
+    dropped_count_++;
     return;
+  }
   std::lock_guard<std::mutex> lock(solution_lock_);
   if(best_solution_ == nullptr || solution->betterThan(*best_solution_)){
     best_solution_ = solution;
-    const std::string solution_string = serializer_->serializeSolution(solution);
-    std::cout << solution_string << std::endl;
+    if(pending_solution_ != nullptr)
+      coalesced_count_++;
+    pending_solution_ = solution;
+    pending_condition_.notify_one();
   }
+  else if(solution != best_solution_) // not counting the solutions received from Optal coming back
+    dropped_count_++;
 }
 
 void OptalComms::terminate() {
-  terminate_ = true;
+  {
+    std::lock_guard<std::mutex> lock(solution_lock_);
+    terminate_ = true;
+  }
+  pending_condition_.notify_all();
   portfolio_ = nullptr;
 }
 
+bool OptalComms::flush(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(solution_lock_);
+  return written_condition_.wait_for(lock, timeout, [this](){ return written_all_;});
+}
+
 inline void OptalComms::sendSolution(const std::shared_ptr<Solution>& solution) {
   if(solution == nullptr || portfolio_ == nullptr)
     return;
@@ -1,56 +1,223 @@
 #include "common/portfolio.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <sstream>
 #include <thread>
+#include <time.h>
+
+/** Heuristic running on the thread, credited with the best-so-far solutions it publishes */
+thread_local const Heuristic *running_heuristic = nullptr;
+
+static double threadCpuSeconds() {
+  timespec time{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+/** Relative improvement over the previous best-so-far solution, becoming feasible or saving a vehicle counts fully */
+static double improvementOf(const std::shared_ptr<Solution> &previous, const Solution &solution) {
+  if(previous == nullptr)
+    return 0;
+  if((solution.feasible && !previous->feasible) || solution.used_vehicles < previous->used_vehicles)
+    return 1;
+  if(previous->objective <= 0)
+    return 0;
+  return std::clamp((double)(previous->objective - solution.objective) / previous->objective, 0.0, 1.0);
+}
 
 HeuristicPortfolio::HeuristicPortfolio() :
-  improving_heuristics_(), constructive_heuristics_(),
-  logger_(nullptr), best_solution_(nullptr) {
+  improving_heuristics_(), constructive_heuristics_(), solution_listeners_(),
+  instance_replicas_(), heuristic_names_(), heuristic_arms_(), bandit_(nullptr), time_limit_(0), finished_(false), scheduling_(std::make_shared<ThreadScheduling>()), running_threads_(0), terminated_(false), task_pool_(nullptr),
+  logger_(nullptr), logged_solution_(nullptr), starting_solutions_(), next_starting_solution_(0), running_constructions_(0),
+  best_solution_(nullptr), solution_epoch_(0) {
 
 }
 void HeuristicPortfolio::addImprovingHeuristic(
-    const std::shared_ptr<Heuristic>& heuristic) {
+    const std::shared_ptr<Heuristic>& heuristic, const std::shared_ptr<RoutingInstance>& instance_replica,
+    const nlohmann::json &config) {
   improving_heuristics_.push_back(heuristic);
+  configureHeuristic(heuristic, config);
+  if(instance_replica != nullptr)
+    instance_replicas_[heuristic.get()] = instance_replica;
 }
 
 void HeuristicPortfolio::addConstructiveHeuristic(
-    const std::shared_ptr<Heuristic>& heuristic) {
+    const std::shared_ptr<Heuristic>& heuristic, const std::shared_ptr<RoutingInstance>& instance_replica,
+    const nlohmann::json &config) {
   constructive_heuristics_.push_back(heuristic);
+  configureHeuristic(heuristic, config);
+  if(instance_replica != nullptr)
+    instance_replicas_[heuristic.get()] = instance_replica;
+}
+
+void HeuristicPortfolio::addSolutionListener(
+    const std::shared_ptr<Heuristic>& heuristic, const nlohmann::json &config) {
+  addImprovingHeuristic(heuristic, nullptr, config);
+  solution_listeners_.push_back(heuristic);
+}
+
+void HeuristicPortfolio::configureHeuristic(const std::shared_ptr<Heuristic> &heuristic, const nlohmann::json &config) {
+  heuristic_names_[heuristic.get()] = config.contains("type") && config["type"].is_string() ? config["type"].get<std::string>() : "";
+  if(!config.contains("budget"))
+    return;
+  const auto &budget = config["budget"];
+  const bool valid = budget.is_object() &&
+      (!budget.contains("seconds") || (budget["seconds"].is_number() && budget["seconds"].get<double>() >= 0)) &&
+      (!budget.contains("units") || budget["units"].is_number_unsigned());
+  if(!valid){
+    std::cerr << "Invalid budget of heuristic " << config["type"] << ", expected {\"seconds\": s, \"units\": n}" << std::endl;
+    exit(100);
+  }
+  heuristic->setBudget(budget.value("seconds", 0.0), budget.value("units", 0UL));
+}
+
+bool HeuristicPortfolio::isListener(const std::shared_ptr<Heuristic> &heuristic) const {
+  return std::find(solution_listeners_.begin(), solution_listeners_.end(), heuristic) != solution_listeners_.end();
+}
+
+void HeuristicPortfolio::setTimeLimit(double seconds) {
+  time_limit_ = seconds;
 }
 
 void HeuristicPortfolio::start() {
+  const size_t heuristic_count = constructive_heuristics_.size() + improving_heuristics_.size() - solution_listeners_.size();
+  if(scheduling_->getWorkerCount() == 0 && scheduling_->getMaxThreads() > 0 && scheduling_->getMaxThreads() < heuristic_count)
+    std::cerr << "max_threads " << scheduling_->getMaxThreads() << " is lower than the heuristic count " << heuristic_count
+              << ", the heuristics over the cap start only when a running one finishes" << std::endl;
+  if(scheduling_->isAdaptive() && scheduling_->getWorkerCount() == 0)
+    std::cerr << "adaptive scheduling needs workers, heuristic statistics are collected only" << std::endl;
+  bandit_ = std::make_unique<PortfolioBandit>(scheduling_->isAdaptive(), scheduling_->getExploration(), scheduling_->getDiscount());
+  std::vector<std::shared_ptr<Heuristic>> heuristics(constructive_heuristics_);
+  heuristics.insert(heuristics.end(), improving_heuristics_.begin(), improving_heuristics_.end());
+  for(const auto &heur : heuristics)
+    heuristic_arms_[heur.get()] = bandit_->addArm(heuristic_names_[heur.get()].empty() ? "heuristic" : heuristic_names_[heur.get()]);
+
+  // the limit covers the initialization too, it is the wall-clock time the caller waits for
+  std::thread deadline_thread;
+  if(time_limit_ > 0){
+    const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_limit_));
+    deadline_thread = std::thread(&HeuristicPortfolio::watchDeadline, this, deadline);
+  }
   initializeThreads();
   if(logger_ != nullptr){
     logger_->startClock();
   }
   runThreads();
+  if(deadline_thread.joinable()){
+    {
+      std::lock_guard<std::mutex> lock(thread_lock_);
+      finished_ = true;
+    }
+    thread_condition_.notify_all();
+    deadline_thread.join();
+  }
+
+  if(logger_ != nullptr){
+    std::ostringstream statistics;
+    bandit_->writeStatistics(statistics);
+    logger_->logComment(statistics.str());
+  }
 }
 
 void HeuristicPortfolio::terminate() {
+  {
+    // heuristics still waiting for a thread slot are not started at all
+    std::lock_guard<std::mutex> lock(thread_lock_);
+    terminated_ = true;
+  }
+  thread_condition_.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(starting_solution_lock_);
+    running_constructions_ = 0;
+  }
+  starting_solution_condition_.notify_all();
   for(auto& heur: constructive_heuristics_){
     heur->terminate();
+    heur->resume();
   }
 
   for(auto& heur: improving_heuristics_){
+    if(isListener(heur))
+      continue;
     heur->terminate();
+    heur->resume();
   }
 }
 
+void HeuristicPortfolio::watchDeadline(std::chrono::steady_clock::time_point deadline) {
+  {
+    std::unique_lock<std::mutex> lock(thread_lock_);
+    if(thread_condition_.wait_until(lock, deadline, [this](){ return terminated_ || finished_;}))
+      return;
+  }
+  std::cerr << "Time limit of " << time_limit_ << " s reached, terminating the heuristics" << std::endl;
+  terminate();
+}
+
 void HeuristicPortfolio::acceptSolution(const std::shared_ptr<Solution>& solution) {
-  std::lock_guard<std::mutex> lock(solution_lock_);
-  if(best_solution_ == nullptr || solution->betterThan(*best_solution_)){
-    best_solution_ = solution;
-    sendSolution();
+  std::shared_ptr<Solution> current = std::atomic_load(&best_solution_);
+  do{
+    if(current != nullptr && !solution->betterThan(*current))
+      return;
+  }while(!std::atomic_compare_exchange_weak(&best_solution_, &current, solution));
+  solution_epoch_.fetch_add(1, std::memory_order_release);
+  if(running_heuristic != nullptr && bandit_ != nullptr)
+    bandit_->addImprovement(heuristic_arms_.at(running_heuristic), improvementOf(current, *solution));
+  sendSolution(solution);
+}
 
-    if(logger_ != nullptr)
+void HeuristicPortfolio::sendSolution(const std::shared_ptr<Solution>& solution) {
+  for(auto& heur: solution_listeners_){
+    heur->acceptSolution(solution);
+  }
+
+  if(logger_ != nullptr){
+    // concurrent publishers may get here out of order, only improvements are logged
+    std::lock_guard<std::mutex> lock(log_lock_);
+    if(logged_solution_ == nullptr || solution->betterThan(*logged_solution_)){
+      logged_solution_ = solution;
       logger_->log(*solution);
+    }
   }
 }
 
-void HeuristicPortfolio::sendSolution() {
-  for(auto& heur: improving_heuristics_){
-    heur->acceptSolution(best_solution_);
+void HeuristicPortfolio::addStartingSolution(const std::shared_ptr<Solution>& solution) {
+  {
+    std::lock_guard<std::mutex> lock(starting_solution_lock_);
+    starting_solutions_.push_back(solution);
   }
+  acceptSolution(solution);
+}
+
+std::vector<std::shared_ptr<Solution>> HeuristicPortfolio::takeStartingSolutions(size_t count) {
+  std::unique_lock<std::mutex> lock(starting_solution_lock_);
+  // the constructions run in parallel once, waiting for all of them gives every heuristic a different start
+  starting_solution_condition_.wait(lock, [this](){ return running_constructions_ == 0;});
+  std::vector<std::shared_ptr<Solution>> solutions;
+  count = std::min(count, starting_solutions_.size());
+  for(size_t i = 0; i < count; i++){
+    solutions.push_back(starting_solutions_[next_starting_solution_]);
+    next_starting_solution_ = (next_starting_solution_ + 1) % starting_solutions_.size();
+  }
+  return solutions;
+}
+
+std::shared_ptr<Solution> HeuristicPortfolio::takeStartingSolution() {
+  const auto solutions = takeStartingSolutions(1);
+  return solutions.empty() ? nullptr : solutions.front();
+}
+
+std::function<void()> HeuristicPortfolio::solutionPoll(Heuristic *heuristic) {
+  return [this, heuristic, epoch = 0UL]() mutable {
+    const unsigned long current_epoch = solution_epoch_.load(std::memory_order_acquire);
+    if(current_epoch == epoch)
+      return;
+    epoch = current_epoch;
+    heuristic->acceptSolution(std::atomic_load(&best_solution_));
+  };
 }
 
 void HeuristicPortfolio::setLogger(
@@ -58,36 +225,210 @@ void HeuristicPortfolio::setLogger(
   logger_ = logger;
 }
 
+void HeuristicPortfolio::setScheduling(const std::shared_ptr<ThreadScheduling> &scheduling) {
+  scheduling_ = scheduling;
+}
+
 void HeuristicPortfolio::initializeThreads() {
-  std::vector<std::thread> threads;
-  threads.reserve(constructive_heuristics_.size() + improving_heuristics_.size());
-  // start constructive heuristics
-  for(auto& heur: constructive_heuristics_){
-    threads.emplace_back([this, heur]()->void{ heur->initialize(this);});
+  for(auto &heur : solution_listeners_)
+    heur->initialize(this);
+  if(scheduling_->getWorkerCount() == 0){
+    runHeuristicThreads([this](Heuristic &heur)->void{ heur.initialize(this);}, true);
+    return;
   }
+  task_pool_ = std::make_unique<TaskPool>(scheduling_->getWorkerCount(), [this](unsigned int worker_idx)->void{
+    scheduling_->applyToCurrentThread(worker_idx);
+  });
+  std::vector<std::shared_ptr<Heuristic>> heuristics(constructive_heuristics_);
+  heuristics.insert(heuristics.end(), improving_heuristics_.begin(), improving_heuristics_.end());
+  for(auto &heur : heuristics){
+    if(isListener(heur))
+      continue;
+    const auto replica = instance_replicas_.find(heur.get());
+    auto instance_replica = replica != instance_replicas_.end() ? replica->second : nullptr;
+    task_pool_->submit([this, heur, instance_replica]()->TaskPool::TaskResult{
+      if(instance_replica != nullptr)
+        instance_replica->replicateDistances();
+      running_heuristic = heur.get();
+      const double cpu_start = threadCpuSeconds();
+      heur->initialize(this);
+      addCpuTime(*heur, cpu_start, 0, false);
+      running_heuristic = nullptr;
+      return TaskPool::TASK_FINISHED;
+    });
+  }
+  task_pool_->wait();
+}
 
-  // start improving heuristics
-  for(auto& heur: improving_heuristics_){
-    threads.emplace_back([this, heur]()->void{ heur->initialize(this);});
+void HeuristicPortfolio::runThreads() {
+  {
+    std::lock_guard<std::mutex> lock(starting_solution_lock_);
+    running_constructions_ = constructive_heuristics_.size();
+  }
+  auto listeners = startListeners();
+  if(task_pool_ != nullptr){
+    runHeuristicTasks();
+  }
+  else{
+    runHeuristicThreads([this](Heuristic &heur)->void{
+      heur.run();
+      finishHeuristic(heur);
+    }, false);
   }
+  stopListeners(listeners);
+}
 
-  //wait for threads to finish
-  for(auto &thread : threads){
-    thread.join();
+std::vector<std::future<double>> HeuristicPortfolio::startListeners() {
+  // listeners (Optal communication) mostly wait for I/O, they run unplaced and outside of the thread cap and the pool
+  std::vector<std::future<double>> listeners;
+  for(auto &heur : solution_listeners_){
+    std::packaged_task<double()> task([heur]()->double{
+      running_heuristic = heur.get();
+      const double cpu_start = threadCpuSeconds();
+      heur->run();
+      return threadCpuSeconds() - cpu_start;
+    });
+    listeners.push_back(task.get_future());
+    std::thread(std::move(task)).detach();
   }
+  return listeners;
 }
 
-void HeuristicPortfolio::runThreads() {
-  std::vector<std::thread> threads;
-  threads.reserve(constructive_heuristics_.size() + improving_heuristics_.size());
-  // start constructive heuristics
-  for(auto& heur: constructive_heuristics_){
-    threads.emplace_back([this, heur]()->void{ heur->run();});
+void HeuristicPortfolio::stopListeners(std::vector<std::future<double>> &listeners) {
+  // how long a listener gets to deliver the final solution and to return
+  constexpr auto flush_timeout = std::chrono::seconds(5);
+  constexpr auto return_timeout = std::chrono::milliseconds(100);
+  for(size_t i = 0; i < solution_listeners_.size(); i++){
+    auto &heur = solution_listeners_[i];
+    heur->terminate();
+    if(!heur->flush(flush_timeout))
+      std::cerr << "Heuristic " << heuristic_names_[heur.get()] << " didn't deliver the final solution in time" << std::endl;
+    // the listener thread is detached, one still blocked in reading ends with the process
+    if(listeners[i].wait_for(return_timeout) == std::future_status::ready)
+      bandit_->addCpuTime(heuristic_arms_.at(heur.get()), listeners[i].get(), 0, false);
   }
+}
 
-  // start improving heuristics
-  for(auto& heur: improving_heuristics_){
-    threads.emplace_back([this, heur]()->void{ heur->run();});
+void HeuristicPortfolio::addCpuTime(const Heuristic &heuristic, double cpu_start, unsigned long units, bool slice) {
+  bandit_->addCpuTime(heuristic_arms_.at(&heuristic), threadCpuSeconds() - cpu_start, units, slice);
+}
+
+void HeuristicPortfolio::finishHeuristic(const Heuristic &heuristic) {
+  bandit_->deactivate(heuristic_arms_.at(&heuristic));
+  const auto is_constructive = [&heuristic](const std::shared_ptr<Heuristic> &constructive){ return constructive.get() == &heuristic;};
+  if(std::any_of(constructive_heuristics_.begin(), constructive_heuristics_.end(), is_constructive)){
+    {
+      std::lock_guard<std::mutex> lock(starting_solution_lock_);
+      if(running_constructions_ > 0)
+        running_constructions_--;
+    }
+    starting_solution_condition_.notify_all();
+  }
+}
+
+TaskPool::Task HeuristicPortfolio::heuristicTask(const std::shared_ptr<Heuristic> &heuristic) {
+  const auto slice = std::chrono::milliseconds(scheduling_->getSliceMs());
+  const size_t arm = heuristic_arms_.at(heuristic.get());
+  return [this, heuristic, slice, arm, started = false, run_start = std::chrono::steady_clock::time_point(), run_units = 0UL]()
+      mutable -> TaskPool::TaskResult {
+    if(!started){
+      {
+        std::lock_guard<std::mutex> lock(thread_lock_);
+        if(terminated_){
+          finishHeuristic(*heuristic);
+          return TaskPool::TASK_FINISHED;
+        }
+      }
+      started = true;
+      run_start = std::chrono::steady_clock::now();
+      running_heuristic = heuristic.get();
+      const double cpu_start = threadCpuSeconds();
+      const bool in_units = heuristic->startUnits();
+      // a heuristic without units keeps the worker until it finishes
+      if(!in_units)
+        heuristic->run();
+      addCpuTime(*heuristic, cpu_start, 0, false);
+      running_heuristic = nullptr;
+      if(!in_units){
+        finishHeuristic(*heuristic);
+        return TaskPool::TASK_FINISHED;
+      }
+      bandit_->activate(arm);
+    }
+    if(heuristic->isPaused())
+      return TaskPool::TASK_IDLE;
+    running_heuristic = heuristic.get();
+    const double cpu_start = threadCpuSeconds();
+    // the bandit lengthens slices of the heuristics improving the best-so-far solution and shortens the others
+    const auto slice_end = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(slice * bandit_->sliceScale(arm));
+    unsigned long units = 0;
+    bool running;
+    do{
+      running = heuristic->runUnit();
+      units++;
+      if(running && heuristic->budgetExhausted(run_start, run_units + units)){
+        heuristic->terminate();
+        running = false;
+      }
+    }while(running && std::chrono::steady_clock::now() < slice_end);
+    run_units += units;
+    addCpuTime(*heuristic, cpu_start, units, true);
+    running_heuristic = nullptr;
+    if(running)
+      return TaskPool::TASK_RESCHEDULE;
+    finishHeuristic(*heuristic);
+    return TaskPool::TASK_FINISHED;
+  };
+}
+
+void HeuristicPortfolio::runHeuristicTasks() {
+  for(auto &heur : constructive_heuristics_)
+    task_pool_->submit(heuristicTask(heur));
+  // improving heuristics wait for the starting solutions, on a worker they could block the constructions
+  task_pool_->wait();
+  for(auto &heur : improving_heuristics_){
+    if(!isListener(heur))
+      task_pool_->submit(heuristicTask(heur));
+  }
+  task_pool_->wait();
+  task_pool_ = nullptr;
+}
+
+void HeuristicPortfolio::runHeuristicThreads(const std::function<void(Heuristic &)> &task, bool replicate_distances) {
+  std::vector<std::shared_ptr<Heuristic>> heuristics(constructive_heuristics_);
+  heuristics.insert(heuristics.end(), improving_heuristics_.begin(), improving_heuristics_.end());
+  std::vector<std::thread> threads;
+  threads.reserve(heuristics.size());
+  const unsigned int max_threads = scheduling_->getMaxThreads();
+  unsigned int heuristic_idx = 0;
+  for(auto& heur: heuristics){
+    if(isListener(heur))
+      continue;
+    {
+      std::unique_lock<std::mutex> lock(thread_lock_);
+      thread_condition_.wait(lock, [this, max_threads](){ return terminated_ || max_threads == 0 || running_threads_ < max_threads;});
+      if(terminated_)
+        break;
+      running_threads_++;
+    }
+    const auto replica = instance_replicas_.find(heur.get());
+    auto instance_replica = replica != instance_replicas_.end() && replicate_distances ? replica->second : nullptr;
+    threads.emplace_back([this, heur, instance_replica, heuristic_idx, &task]()->void{
+      scheduling_->applyToCurrentThread(heuristic_idx);
+      if(instance_replica != nullptr)
+        instance_replica->replicateDistances();
+      running_heuristic = heur.get();
+      const double cpu_start = threadCpuSeconds();
+      task(*heur);
+      addCpuTime(*heur, cpu_start, 0, false);
+      {
+        std::lock_guard<std::mutex> lock(thread_lock_);
+        running_threads_--;
+      }
+      thread_condition_.notify_all();
+    });
+    heuristic_idx++;
   }
 
   //wait for threads to finish
@@ -0,0 +1,119 @@
+#include "common/portfolio_bandit.h"
+#include <algorithm>
+#include <cmath>
+
+/** Smallest share of an active arm relative to the even share, stalled heuristics keep probing */
+constexpr double min_share_ratio = 0.1;
+
+PortfolioBandit::PortfolioBandit(bool adaptive, double exploration, double discount) :
+  arms_(), adaptive_(adaptive), exploration_(exploration), discount_(discount) {}
+
+size_t PortfolioBandit::addArm(const std::string &name) {
+  std::lock_guard<std::mutex> lock(lock_);
+  arms_.emplace_back();
+  arms_.back().name = name;
+  return arms_.size() - 1;
+}
+
+void PortfolioBandit::activate(size_t arm) {
+  std::lock_guard<std::mutex> lock(lock_);
+  arms_[arm].active = true;
+  allocate();
+}
+
+void PortfolioBandit::deactivate(size_t arm) {
+  std::lock_guard<std::mutex> lock(lock_);
+  arms_[arm].active = false;
+  arms_[arm].share = 0;
+  allocate();
+}
+
+void PortfolioBandit::addImprovement(size_t arm, double improvement) {
+  std::lock_guard<std::mutex> lock(lock_);
+  arms_[arm].improvements++;
+  arms_[arm].credit += improvement;
+  arms_[arm].pending_credit += improvement;
+}
+
+void PortfolioBandit::addCpuTime(size_t arm, double cpu_seconds, unsigned long units, bool slice) {
+  std::lock_guard<std::mutex> lock(lock_);
+  Arm &a = arms_[arm];
+  a.cpu_seconds += cpu_seconds;
+  a.units += units;
+  if(!slice)
+    return;
+  a.slices++;
+  a.discounted_credit = discount_ * a.discounted_credit + a.pending_credit;
+  a.discounted_seconds = discount_ * a.discounted_seconds + cpu_seconds;
+  a.discounted_slices = discount_ * a.discounted_slices + 1;
+  a.pending_credit = 0;
+  allocate();
+}
+
+void PortfolioBandit::allocate() {
+  size_t active_count = 0;
+  double total_slices = 0;
+  double max_rate = 0;
+  for(const auto &a : arms_){
+    if(!a.active)
+      continue;
+    active_count++;
+    total_slices += a.discounted_slices;
+    if(a.discounted_seconds > 0)
+      max_rate = std::max(max_rate, a.discounted_credit / a.discounted_seconds);
+  }
+  if(active_count == 0)
+    return;
+
+  std::vector<double> indices(arms_.size(), 0);
+  double index_sum = 0;
+  for(size_t i = 0; i < arms_.size(); i++){
+    const Arm &a = arms_[i];
+    if(!a.active)
+      continue;
+    if(!adaptive_){
+      indices[i] = 1;
+    }
+    else{
+      // UCB on the reward rate normalized by the best arm, arms without slices count as sampled once
+      const double rate = a.discounted_seconds > 0 && max_rate > 0 ? a.discounted_credit / a.discounted_seconds / max_rate : 0;
+      indices[i] = rate + exploration_ * std::sqrt(std::log(std::max(total_slices, 1.0) + 1) / std::max(a.discounted_slices, 1.0));
+    }
+    index_sum += indices[i];
+  }
+  const double min_share = min_share_ratio / (double)active_count;
+  double share_sum = 0;
+  for(size_t i = 0; i < arms_.size(); i++){
+    if(arms_[i].active){
+      arms_[i].share = std::max(min_share, indices[i] / index_sum);
+      share_sum += arms_[i].share;
+    }
+  }
+  for(auto &a : arms_){
+    if(a.active)
+      a.share /= share_sum;
+  }
+}
+
+double PortfolioBandit::sliceScale(size_t arm) {
+  std::lock_guard<std::mutex> lock(lock_);
+  size_t active_count = 0;
+  for(const auto &a : arms_)
+    active_count += a.active ? 1 : 0;
+  if(!arms_[arm].active || arms_[arm].share <= 0)
+    return 1;
+  return arms_[arm].share * (double)active_count;
+}
+
+void PortfolioBandit::writeStatistics(std::ostream &stream) {
+  std::lock_guard<std::mutex> lock(lock_);
+  double total_seconds = 0;
+  for(const auto &a : arms_)
+    total_seconds += a.cpu_seconds;
+  stream << "# heuristic name cpu_seconds cpu_share units slices improvements credit" << std::endl;
+  for(size_t i = 0; i < arms_.size(); i++){
+    const Arm &a = arms_[i];
+    stream << "# " << i << " " << a.name << " " << a.cpu_seconds << " " << (total_seconds > 0 ? a.cpu_seconds / total_seconds : 0)
+           << " " << a.units << " " << a.slices << " " << a.improvements << " " << a.credit << std::endl;
+  }
+}
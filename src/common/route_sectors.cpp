@@ -0,0 +1,45 @@
+#include "common/route_sectors.h"
+#include <cmath>
+
+RouteSectors::RouteSectors() : angles_(), starts_(), ends_(), empty_(), tolerance_(0) {}
+
+void RouteSectors::initialize(const RoutingInstance &instance, double tolerance_degrees) {
+  const double *xs = instance.getCoordinatesX();
+  const double *ys = instance.getCoordinatesY();
+  if(xs == nullptr || ys == nullptr)
+    return;
+  tolerance_ = (int)std::lround(tolerance_degrees / 360.0 * full_circle);
+  angles_.resize(instance.getNodesCount());
+  for(uint i = 0; i < angles_.size(); i++){
+    const double angle = std::atan2(ys[i] - ys[0], xs[i] - xs[0]);
+    angles_[i] = positiveMod((int)std::lround(angle / (2 * M_PI) * full_circle));
+  }
+}
+
+void RouteSectors::extend(uint route, int angle) {
+  if(empty_[route]){
+    starts_[route] = angle;
+    ends_[route] = angle;
+    empty_[route] = false;
+    return;
+  }
+  if(positiveMod(angle - starts_[route]) <= positiveMod(ends_[route] - starts_[route]))
+    return; // already enclosed
+  // grow the sector on the side closer to the angle
+  if(positiveMod(angle - ends_[route]) <= positiveMod(starts_[route] - angle))
+    ends_[route] = angle;
+  else
+    starts_[route] = angle;
+}
+
+bool RouteSectors::overlap(uint route1, uint route2) const {
+  if(!isEnabled() || route1 >= empty_.size() || route2 >= empty_.size() || empty_[route1] || empty_[route2])
+    return true;
+  const int width1 = positiveMod(ends_[route1] - starts_[route1]) + 2 * tolerance_;
+  const int width2 = positiveMod(ends_[route2] - starts_[route2]) + 2 * tolerance_;
+  if(width1 >= full_circle || width2 >= full_circle)
+    return true;
+  const int start1 = starts_[route1] - tolerance_;
+  const int start2 = starts_[route2] - tolerance_;
+  return positiveMod(start2 - start1) <= width1 || positiveMod(start1 - start2) <= width2;
+}
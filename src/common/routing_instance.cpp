@@ -1,7 +1,58 @@
 #include "common/routing_instance.h"
 #include "common/tsplib_loader.h"
 #include "common/solomon_loader.h"
+#include "common/instance_cache.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <thread>
 
+/** Largest full matrix kept, larger symmetric instances are stored as a triangle */
+constexpr size_t max_full_matrix_bytes = (size_t)1 << 30;
+/** Largest triangular matrix kept, larger instances with coordinates compute the distances on the fly */
+constexpr size_t max_triangular_matrix_bytes = (size_t)2 << 30;
+/** Rows of the matrix given to one thread at a time */
+constexpr size_t matrix_row_block = 64;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+// AVX2 and baseline SSE2 versions selected at load time (the file is compiled with -fno-math-errno to vectorize sqrt)
+#define DISTANCE_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define DISTANCE_KERNEL
+#endif
+
+/** TSPLIB nint of the euclidean distance, the same rule as the vectorized row kernel */
+static inline uint roundedDistance(double dist) {
+  return (uint)(int)(dist + 0.5);
+}
+
+/** Ceiling of the euclidean distance by integer conversion, the same rule as the vectorized row kernel */
+static inline uint ceiledDistance(double dist) {
+  const int truncated = (int)dist;
+  return (uint)(truncated + ((double)truncated < dist));
+}
+
+/** Distances from (x, y) to nodes first..last-1, branch-free loops the compiler vectorizes */
+DISTANCE_KERNEL
+static void euclideanDistanceRow(const double *xs, const double *ys, double x, double y,
+                                 size_t first, size_t last, bool ceiled, uint *row) {
+  if(ceiled){
+    for(size_t j = first; j < last; j++){
+      const double dx = xs[j] - x;
+      const double dy = ys[j] - y;
+      row[j] = ceiledDistance(std::sqrt(dx * dx + dy * dy));
+    }
+  }else{
+    for(size_t j = first; j < last; j++){
+      const double dx = xs[j] - x;
+      const double dy = ys[j] - y;
+      row[j] = roundedDistance(std::sqrt(dx * dx + dy * dy));
+    }
+  }
+}
+
+std::string RoutingInstance::cache_directory_;
 
 RoutingInstance::RoutingInstance() {
   problem_type_ = TSP;
@@ -11,15 +62,37 @@ RoutingInstance::RoutingInstance() {
   vehicle_capacity_ = -1;
   vehicle_count_ = 1;
   node_count_ = 0;
+  distance_storage_ = FULL_MATRIX_STORAGE;
+  compact_distances_ = false;
+  distance_rows_ = nullptr;
+  stride_ = 0;
+  matrix_size_ = 0;
+  candidate_count_ = 0;
+  source_checksum_ = 0;
+}
+
+void RoutingInstance::setCacheDirectory(const std::string &directory) {
+  cache_directory_ = directory;
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
 }
 
 void RoutingInstance::loadTSPlibInstance(const char *filename) {
-  std::ifstream file(filename);
-  if(!file.is_open()){
+  MappedFile file(filename);
+  if(!file.isOpen()){
     std::cerr << "Error opening file: " << filename << std::endl;
     exit(100);
   }
 
+  if(!cache_directory_.empty()){
+    cache_filename_ = InstanceCache::cacheFilename(filename);
+    source_checksum_ = InstanceCache::checksum(file, InstanceCache::tsplib_format);
+    if(InstanceCache::load(*this)){
+      buildNodeAttributes();
+      return;
+    }
+  }
+
   TSPlibLoader::loadHeader(*this, file);
   assert(nodes_.size() == node_count_);
   uint sum_demands = 0;
@@ -27,32 +100,352 @@ void RoutingInstance::loadTSPlibInstance(const char *filename) {
     sum_demands += node.demand;
   }
 
-  const std::regex pattern(R"((.*/)?A-n\d+-k(\d+)\.vrp)");
-
-  std::smatch match;
-
-  // Check for str1
-  std::string filename_(filename);
-  if (std::regex_match(filename_, match, pattern)) {
-    vehicle_count_ = std::stoi(match[2]);
+  const int vehicle_count = parseVehicleCount(filename);
+  if(vehicle_count > 0) {
+    vehicle_count_ = vehicle_count;
   } else {
     vehicle_count_ = (int)std::round((1.5 * (double)sum_demands) / (double)vehicle_capacity_);
   }
+  buildNodeAttributes();
+  buildDistances();
+  if(!cache_filename_.empty())
+    InstanceCache::save(*this);
+}
+
+void RoutingInstance::buildNodeAttributes() {
+  demands_.resize(nodes_.size());
+  ready_times_.resize(nodes_.size());
+  due_dates_.resize(nodes_.size());
+  service_times_.resize(nodes_.size());
+  for(size_t i = 0; i < nodes_.size(); i++){
+    demands_[i] = (uint)nodes_[i].demand;
+    ready_times_[i] = nodes_[i].ready_time;
+    due_dates_[i] = nodes_[i].due_date;
+    service_times_[i] = nodes_[i].service_time;
+  }
+}
+
+int RoutingInstance::parseVehicleCount(std::string_view filename) {
+  // A-n<nodes>-k<vehicles>.vrp
+  const auto slash_idx = filename.rfind('/');
+  if(slash_idx != std::string_view::npos)
+    filename.remove_prefix(slash_idx + 1);
+  if(filename.substr(0, 3) != "A-n")
+    return 0;
+  const char *end = filename.data() + filename.size();
+  int node_count = 0, vehicle_count = 0;
+  auto result = std::from_chars(filename.data() + 3, end, node_count);
+  if(result.ec != std::errc() || std::string_view(result.ptr, end - result.ptr).substr(0, 2) != "-k")
+    return 0;
+  result = std::from_chars(result.ptr + 2, end, vehicle_count);
+  if(result.ec != std::errc() || std::string_view(result.ptr, end - result.ptr) != ".vrp")
+    return 0;
+  return vehicle_count;
 }
 
 void RoutingInstance::loadSolomonInstance(const char *filename) {
-  std::ifstream file(filename);
-  if(!file.is_open()){
+  MappedFile file(filename);
+  if(!file.isOpen()){
     std::cerr << "Error opening file: " << filename << std::endl;
     exit(100);
   }
 
+  if(!cache_directory_.empty()){
+    cache_filename_ = InstanceCache::cacheFilename(filename);
+    source_checksum_ = InstanceCache::checksum(file, InstanceCache::solomon_format);
+    if(InstanceCache::load(*this)){
+      buildNodeAttributes();
+      return;
+    }
+  }
+
   SolomonLoader::loadHeader(*this, file);
   SolomonLoader::loadNodes(*this, file);
+  buildNodeAttributes();
+  buildDistances();
+  if(!cache_filename_.empty())
+    InstanceCache::save(*this);
 }
 
-uint RoutingInstance::getDistance(uint from, uint to) const {
+uint RoutingInstance::getStoredDistance(uint from, uint to) const {
   from = from >= (uint)node_count_ ? 0 : from;
   to = to >= (uint)node_count_ ? 0: to;
-  return matrix_[from * node_count_ + to];
+  switch(distance_storage_){
+    case FULL_MATRIX_STORAGE: {
+      const size_t idx = (size_t)from * node_count_ + to;
+      return compact_distances_ ? compact_matrix_[idx] : matrix_[idx];
+    }
+    case TRIANGULAR_STORAGE: {
+      const size_t idx = from <= to ? row_offsets_[from] + to : row_offsets_[to] + from;
+      return compact_distances_ ? compact_matrix_[idx] : matrix_[idx];
+    }
+    default:
+      return computeDistance(from, to);
+  }
+}
+
+uint RoutingInstance::computeDistance(uint from, uint to) const {
+  if(from == to)
+    return 0;
+  switch(edge_weight_type_){
+    case EUC_2D: {
+      const double dx = coord_x_[from] - coord_x_[to];
+      const double dy = coord_y_[from] - coord_y_[to];
+      return roundedDistance(std::sqrt(dx * dx + dy * dy));
+    }
+    case CEIL_2D: {
+      const double dx = coord_x_[from] - coord_x_[to];
+      const double dy = coord_y_[from] - coord_y_[to];
+      return ceiledDistance(std::sqrt(dx * dx + dy * dy));
+    }
+    case GEO: {
+      const double q1 = std::cos(coord_y_[from] - coord_y_[to]);
+      const double q2 = std::cos(coord_x_[from] - coord_x_[to]);
+      const double q3 = std::cos(coord_x_[from] + coord_x_[to]);
+      return (uint)std::floor(6378.388 * std::acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
+    }
+    default:
+      return explicit_matrix_[(size_t)from * node_count_ + to];
+  }
+}
+
+uint RoutingInstance::getMaxDistance() const {
+  if(edge_weight_type_ == EXPLICIT)
+    return *std::max_element(explicit_matrix_.begin(), explicit_matrix_.end());
+  if(edge_weight_type_ == GEO)
+    return (uint)(6378.388 * M_PI) + 1; // half of the great circle
+  // diagonal of the bounding box
+  const auto [min_x, max_x] = std::minmax_element(coord_x_.begin(), coord_x_.end());
+  const auto [min_y, max_y] = std::minmax_element(coord_y_.begin(), coord_y_.end());
+  const double diagonal = std::ceil(std::hypot(*max_x - *min_x, *max_y - *min_y)) + 1.0;
+  return diagonal >= (double)UINT32_MAX ? UINT32_MAX : (uint)diagonal;
+}
+
+bool RoutingInstance::isSymmetric() const {
+  if(edge_weight_type_ != EXPLICIT)
+    return true;
+  const size_t n = node_count_;
+  for(size_t i = 0; i < n; i++)
+    for(size_t j = i + 1; j < n; j++)
+      if(explicit_matrix_[i * n + j] != explicit_matrix_[j * n + i])
+        return false;
+  return true;
+}
+
+void RoutingInstance::buildDistances() {
+  const size_t n = node_count_;
+  const bool explicit_matrix = edge_weight_type_ == EXPLICIT;
+  if(explicit_matrix)
+    for(size_t i = 0; i < n; i++)
+      explicit_matrix_[i * n + i] = 0;
+
+  // the full matrix has a row and a column for each depot alias (route separators of the individuals)
+  const size_t padded = n + std::max(vehicle_count_, 1);
+  const bool fits_uint16 = n > 0 && getMaxDistance() <= UINT16_MAX;
+  const size_t element_size = fits_uint16 ? sizeof(uint16_t) : sizeof(uint);
+  compact_distances_ = false;
+  if(padded * padded * sizeof(uint) <= max_full_matrix_bytes){
+    distance_storage_ = FULL_MATRIX_STORAGE;
+  }else if(fits_uint16 && n * n * sizeof(uint16_t) <= max_full_matrix_bytes){
+    distance_storage_ = FULL_MATRIX_STORAGE;
+    compact_distances_ = true;
+  }else if(isSymmetric() && n * (n + 1) / 2 * element_size <= max_triangular_matrix_bytes){
+    distance_storage_ = TRIANGULAR_STORAGE;
+    compact_distances_ = fits_uint16;
+  }else if(!explicit_matrix){
+    distance_storage_ = COORDINATE_STORAGE;
+  }else{
+    distance_storage_ = FULL_MATRIX_STORAGE;
+  }
+
+  distance_rows_ = nullptr;
+  if(distance_storage_ == COORDINATE_STORAGE)
+    return;
+
+  const bool padded_matrix = distance_storage_ == FULL_MATRIX_STORAGE && !compact_distances_;
+  stride_ = padded_matrix ? padded : n;
+  size_t size = stride_ * stride_;
+  if(distance_storage_ == TRIANGULAR_STORAGE){
+    row_offsets_.resize(n);
+    size = 0;
+    for(size_t i = 0; i < n; i++){
+      row_offsets_[i] = size - i;
+      size += n - i;
+    }
+  }
+  matrix_size_ = size;
+  // left uninitialized, the pages are first touched by the filling threads
+  if(compact_distances_)
+    compact_matrix_ = std::shared_ptr<uint16_t[]>(new uint16_t[size]);
+  else
+    matrix_ = std::shared_ptr<uint[]>(new uint[size]);
+
+  // blocks of rows are interleaved among the threads, which balances the shrinking rows of the triangle
+  const size_t block_count = (stride_ + matrix_row_block - 1) / matrix_row_block;
+  const size_t thread_count = std::min((size_t)std::max(std::thread::hardware_concurrency(), 1u), block_count);
+  std::vector<std::thread> threads;
+  for(size_t t = 1; t < thread_count; t++)
+    threads.emplace_back([this, t, thread_count](){fillDistanceRows(t, thread_count);});
+  fillDistanceRows(0, thread_count);
+  for(auto &thread : threads)
+    thread.join();
+  explicit_matrix_ = std::vector<uint>();
+  if(padded_matrix)
+    distance_rows_ = matrix_.get();
+}
+
+void RoutingInstance::replicateDistances() {
+  if(matrix_ != nullptr){
+    auto matrix = std::shared_ptr<uint[]>(new uint[matrix_size_]);
+    std::copy(matrix_.get(), matrix_.get() + matrix_size_, matrix.get());
+    if(distance_rows_ == matrix_.get())
+      distance_rows_ = matrix.get();
+    matrix_ = matrix;
+  }
+  if(compact_matrix_ != nullptr){
+    auto compact_matrix = std::shared_ptr<uint16_t[]>(new uint16_t[matrix_size_]);
+    std::copy(compact_matrix_.get(), compact_matrix_.get() + matrix_size_, compact_matrix.get());
+    compact_matrix_ = compact_matrix;
+  }
+  // vectors copied by the copy constructor were allocated by the thread which made the copy
+  row_offsets_ = std::vector<size_t>(row_offsets_);
+  coord_x_ = std::vector<double>(coord_x_);
+  coord_y_ = std::vector<double>(coord_y_);
+  demands_ = std::vector<uint>(demands_);
+  ready_times_ = std::vector<int>(ready_times_);
+  due_dates_ = std::vector<int>(due_dates_);
+  service_times_ = std::vector<int>(service_times_);
+  candidates_ = std::vector<uint>(candidates_);
+  candidate_distances_ = std::vector<uint>(candidate_distances_);
+}
+
+void RoutingInstance::computeDistanceRow(uint from, size_t first, size_t last, uint *row) const {
+  if(edge_weight_type_ == EUC_2D || edge_weight_type_ == CEIL_2D){
+    euclideanDistanceRow(coord_x_.data(), coord_y_.data(), coord_x_[from], coord_y_[from],
+                         first, last, edge_weight_type_ == CEIL_2D, row);
+    return;
+  }
+  for(size_t j = first; j < last; j++)
+    row[j] = computeDistance(from, j);
+}
+
+void RoutingInstance::fillDistanceRows(size_t part, size_t part_count) {
+  const size_t n = node_count_;
+  const bool triangular = distance_storage_ == TRIANGULAR_STORAGE;
+  std::vector<uint> row_buffer(compact_distances_ ? stride_ : 0);
+  for(size_t block = part; block * matrix_row_block < stride_; block += part_count){
+    const size_t block_end = std::min(stride_, (block + 1) * matrix_row_block);
+    for(size_t i = block * matrix_row_block; i < block_end; i++){
+      // only the upper triangle is computed in the triangular storage, depot aliases copy the depot row
+      const size_t first = triangular ? i : 0;
+      const size_t offset = triangular ? row_offsets_[i] : i * stride_;
+      uint *row = compact_distances_ ? row_buffer.data() : matrix_.get() + offset;
+      computeDistanceRow(i < n ? i : 0, first, std::max(first, n), row);
+      for(size_t j = std::max(first, n); j < stride_; j++)
+        row[j] = row[0];
+      if(compact_distances_)
+        std::copy(row + first, row + stride_, compact_matrix_.get() + offset + first);
+    }
+  }
+}
+
+void RoutingInstance::buildCandidateLists(uint candidate_count) {
+  candidate_count = std::min(candidate_count, (uint)node_count_ - 1);
+  if(candidate_count <= candidate_count_)
+    return;
+
+  if(edge_weight_type_ == EUC_2D || edge_weight_type_ == CEIL_2D)
+    buildGridCandidateLists(candidate_count);
+  else
+    buildScannedCandidateLists(candidate_count);
+  if(!cache_filename_.empty())
+    InstanceCache::save(*this);
+}
+
+void RoutingInstance::buildScannedCandidateLists(uint candidate_count) {
+  candidates_ = std::vector<uint>((size_t)node_count_ * candidate_count);
+  candidate_distances_ = std::vector<uint>((size_t)node_count_ * candidate_count);
+  std::vector<uint> others;
+  others.reserve(node_count_ - 1);
+  for(uint i = 0; i < (uint)node_count_; i++){
+    others.clear();
+    for(uint j = 0; j < (uint)node_count_; j++){
+      if(i != j)
+        others.push_back(j);
+    }
+    const auto closer = [&](uint a, uint b){
+      const uint dist_a = getDistance(i, a);
+      const uint dist_b = getDistance(i, b);
+      return dist_a < dist_b || (dist_a == dist_b && a < b);
+    };
+    std::nth_element(others.begin(), others.begin() + candidate_count - 1, others.end(), closer);
+    std::sort(others.begin(), others.begin() + candidate_count, closer);
+    for(uint k = 0; k < candidate_count; k++){
+      candidates_[(size_t)i * candidate_count + k] = others[k];
+      candidate_distances_[(size_t)i * candidate_count + k] = getDistance(i, others[k]);
+    }
+  }
+  candidate_count_ = candidate_count;
+}
+
+void RoutingInstance::buildGridCandidateLists(uint candidate_count) {
+  const uint n = node_count_;
+  const auto [min_x, max_x] = std::minmax_element(coord_x_.begin(), coord_x_.end());
+  const auto [min_y, max_y] = std::minmax_element(coord_y_.begin(), coord_y_.end());
+  // square cells with about two nodes per cell
+  const uint cells_per_side = std::max(1u, (uint)std::sqrt(n / 2.0));
+  double cell_size = std::max(*max_x - *min_x, *max_y - *min_y) / cells_per_side;
+  cell_size = cell_size > 0.0 ? cell_size : 1.0;
+  const int grid_width = (int)((*max_x - *min_x) / cell_size) + 1;
+  const int grid_height = (int)((*max_y - *min_y) / cell_size) + 1;
+  const auto cellX = [&](uint node){return std::min(grid_width - 1, (int)((coord_x_[node] - *min_x) / cell_size));};
+  const auto cellY = [&](uint node){return std::min(grid_height - 1, (int)((coord_y_[node] - *min_y) / cell_size));};
+
+  // nodes sorted by cells, cell_start has the first node of each cell
+  std::vector<uint> cell_start((size_t)grid_width * grid_height + 1, 0);
+  for(uint i = 0; i < n; i++)
+    cell_start[(size_t)cellY(i) * grid_width + cellX(i) + 1]++;
+  for(size_t c = 1; c < cell_start.size(); c++)
+    cell_start[c] += cell_start[c - 1];
+  std::vector<uint> cell_nodes(n);
+  std::vector<uint> cell_fill(cell_start.begin(), cell_start.end() - 1);
+  for(uint i = 0; i < n; i++)
+    cell_nodes[cell_fill[(size_t)cellY(i) * grid_width + cellX(i)]++] = i;
+
+  candidates_ = std::vector<uint>((size_t)n * candidate_count);
+  candidate_distances_ = std::vector<uint>((size_t)n * candidate_count);
+  std::vector<std::pair<uint, uint>> found; // distance, node
+  for(uint i = 0; i < n; i++){
+    found.clear();
+    const int cx = cellX(i);
+    const int cy = cellY(i);
+    const int max_ring = std::max(std::max(cx, grid_width - 1 - cx), std::max(cy, grid_height - 1 - cy));
+    for(int ring = 0; ring <= max_ring; ring++){
+      for(int y = std::max(0, cy - ring); y <= std::min(grid_height - 1, cy + ring); y++){
+        // inner rows of the ring have only the two border cells
+        const int step = (y == cy - ring || y == cy + ring) ? 1 : 2 * ring;
+        for(int x = cx - ring; x <= cx + ring; x += std::max(step, 1)){
+          if(x < 0 || x >= grid_width)
+            continue;
+          const size_t cell = (size_t)y * grid_width + x;
+          for(uint c = cell_start[cell]; c < cell_start[cell + 1]; c++){
+            if(cell_nodes[c] != i)
+              found.emplace_back(computeDistance(i, cell_nodes[c]), cell_nodes[c]);
+          }
+        }
+      }
+      if(found.size() < candidate_count)
+        continue;
+      // nodes outside the searched rings are farther than ring * cell_size
+      std::nth_element(found.begin(), found.begin() + candidate_count - 1, found.end());
+      if((double)found[candidate_count - 1].first + 1.0 < ring * cell_size)
+        break;
+    }
+    std::sort(found.begin(), found.end());
+    for(uint k = 0; k < candidate_count; k++){
+      candidates_[(size_t)i * candidate_count + k] = found[k].second;
+      candidate_distances_[(size_t)i * candidate_count + k] = found[k].first;
+    }
+  }
+  candidate_count_ = candidate_count;
 }
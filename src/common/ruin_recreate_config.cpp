@@ -0,0 +1,61 @@
+#include "common/ruin_recreate_config.h"
+#include "common/SA_schedule_functions.h"
+#include <iostream>
+
+RuinRecreateConfig::RuinRecreateConfig(const nlohmann::json &config, const RoutingInstance &instance) :
+  parameters_({{}, 10, 10, 0.5, 0.01, 0.01, ANNEALING_ACCEPTANCE, 0, 0, 60.0, 0.01, 100, 30, 0, 0}) {
+  try{
+    const auto removals = config.value("removals", std::vector<std::string>{"string", "random", "related", "worst"});
+    for(const auto &removal : removals){
+      if(removal == "string")
+        parameters_.removals.push_back(STRING_RUIN);
+      else if(removal == "random")
+        parameters_.removals.push_back(RANDOM_RUIN);
+      else if(removal == "related")
+        parameters_.removals.push_back(RELATED_RUIN);
+      else if(removal == "worst")
+        parameters_.removals.push_back(WORST_RUIN);
+      else{
+        std::cerr << "Unknown ruin and recreate removal: " << removal << std::endl;
+        exit(101);
+      }
+    }
+    const std::string acceptance = config.value("acceptance", "simulated_annealing");
+    if(acceptance == "simulated_annealing")
+      parameters_.acceptance = ANNEALING_ACCEPTANCE;
+    else if(acceptance == "record_to_record")
+      parameters_.acceptance = RECORD_TO_RECORD_ACCEPTANCE;
+    else{
+      std::cerr << "Unknown ruin and recreate acceptance: " << acceptance << std::endl;
+      exit(101);
+    }
+    parameters_.average_removed = config.value("average_removed", parameters_.average_removed);
+    parameters_.max_string_length = config.value("max_string_length", parameters_.max_string_length);
+    parameters_.split_rate = config.value("split_rate", parameters_.split_rate);
+    parameters_.split_depth = config.value("split_depth", parameters_.split_depth);
+    parameters_.blink_rate = config.value("blink_rate", parameters_.blink_rate);
+    parameters_.cooling_time = config.value("cooling_time", parameters_.cooling_time);
+    parameters_.deviation = config.value("deviation", parameters_.deviation);
+    parameters_.iterations_per_unit = config.value("iterations_per_unit", parameters_.iterations_per_unit);
+    parameters_.candidate_count = config.value("candidates", parameters_.candidate_count);
+
+    // same scale as the simulated annealing, the final temperature accepts few small deteriorations
+    const double average_length = getAverageEdgeLength(instance);
+    parameters_.initial_temperature = config.value("initial_temperature", getTemperatureByTargetAcceptanceRate(average_length / 10, 0.5));
+    parameters_.final_temperature = config.value("final_temperature", getTemperatureByTargetAcceptanceRate(average_length / 100, 0.01));
+    parameters_.vehicle_cost = getEquivalentPunishmentFunction(average_length, 1.0)(0);
+    parameters_.violation_cost = getEquivalentPunishmentFunction(average_length, 25.0)(0);
+  }
+  catch(const nlohmann::json::exception &ex){
+    std::cerr << "Invalid ruin and recreate config: " << ex.what() << std::endl;
+    exit(100);
+  }
+  const RuinRecreateParameters &p = parameters_;
+  if(p.removals.empty() || p.average_removed == 0 || p.max_string_length == 0 || p.iterations_per_unit == 0 ||
+     p.candidate_count == 0 || p.split_rate < 0 || p.split_rate > 1 || p.split_depth <= 0 || p.split_depth > 1 ||
+     p.blink_rate < 0 || p.blink_rate >= 1 || p.initial_temperature <= 0 || p.final_temperature <= 0 ||
+     p.final_temperature > p.initial_temperature || p.cooling_time <= 0 || p.deviation < 0){
+    std::cerr << "Invalid ruin and recreate config: " << config << std::endl;
+    exit(100);
+  }
+}
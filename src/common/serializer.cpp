@@ -1,8 +1,20 @@
 #include "common/serializer.h"
+#include <iostream>
 #include <sstream>
 
 using JSON = nlohmann::json;
 
+bool SolutionSerializer::binary_protocol_ = false;
+
+/** Frames bigger than this are treated as a corrupted stream */
+constexpr uint32_t max_frame_size = 1u << 28;
+
+SolutionSerializer::SolutionSerializer(const std::shared_ptr<RoutingInstance> &instance) : instance_(instance) {}
+
+void SolutionSerializer::setBinaryProtocol(bool binary_protocol) {
+  binary_protocol_ = binary_protocol;
+}
+
 std::shared_ptr<Solution>
 SolutionSerializer::parseSolution(std::string solution_string) {
   auto solution = std::make_shared<Solution>();
@@ -22,10 +34,10 @@ SolutionSerializer::parseSolution(std::string solution_string) {
   solution->travel_time_sum = solution_json.at("travel_time_sum");
   auto routes_json = solution_json.at("routes");
   size_t route_count = routes_json.size();
-  solution->routes = std::list<SolutionRoute>();
+  solution->reserve(route_count, instance_->getNodesCount() + 2 * route_count);
   for(uint i = 0; i < route_count; i++){
-    solution->routes.push_back(parseRoute(routes_json[i]));
-    if(solution->routes.back().route_nodes.size() > 2)
+    parseRoute(routes_json[i], *solution);
+    if(solution->routes.back().node_count > 2)
       solution->used_vehicles++;
   }
   return solution;
@@ -36,7 +48,7 @@ SolutionSerializer::serializeSolution(std::shared_ptr<Solution> &solution) {
   std::vector<JSON> routes_json;
   routes_json.reserve(solution->routes.size());
   for(const auto &route : solution->routes){
-    routes_json.push_back(serializeRoute(route));
+    routes_json.push_back(serializeRoute(*solution, route));
   }
 
   JSON solution_json;
@@ -57,10 +69,10 @@ nlohmann::json SolutionSerializer::serializeNode(const SolutionNode &node) {
 }
 
 nlohmann::json
-SolutionSerializer::serializeRoute(const SolutionRoute &route) {
+SolutionSerializer::serializeRoute(const Solution &solution, const SolutionRoute &route) {
   std::vector<JSON> nodes_json;
-  nodes_json.reserve(route.route_nodes.size());
-  for(const auto & node: route.route_nodes){
+  nodes_json.reserve(route.node_count);
+  for(const auto & node: solution.routeNodes(route)){
     nodes_json.push_back(serializeNode(node));
   }
 
@@ -80,18 +92,165 @@ SolutionNode SolutionSerializer::parseNode(const nlohmann::json &node_json) {
   return node;
 }
 
-SolutionRoute
-SolutionSerializer::parseRoute(const nlohmann::json &route_json) {
-  SolutionRoute route;
+void
+SolutionSerializer::parseRoute(const nlohmann::json &route_json, Solution &solution) {
+  auto &route = solution.addRoute();
   route.demand = route_json.at("demand");
   route.end_time = route_json.at("end_time");
   route.travel_time = route_json.at("travel_time");
-  route.route_nodes = std::list<SolutionNode>();
 
   const auto &nodes_json = route_json.at("route_nodes");
   size_t node_count = nodes_json.size();
   for(uint i = 0; i < node_count; i++){
-    route.route_nodes.push_back(parseNode(nodes_json[i]));
+    solution.addNode(parseNode(nodes_json[i]));
   }
-  return route;
+}
+
+void SolutionSerializer::writeVarint(std::string &buffer, uint64_t value) {
+  while(value >= 0x80){
+    buffer.push_back((char)((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back((char)value);
+}
+
+bool SolutionSerializer::readVarint(const char *&position, const char *end, uint64_t &value) {
+  value = 0;
+  for(uint shift = 0; position < end && shift < 64; shift += 7){
+    const auto byte = (unsigned char)*position++;
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    if(byte < 0x80)
+      return true;
+  }
+  return false;
+}
+
+size_t SolutionSerializer::maxPayloadSize() const {
+  // 5 bytes per 32-bit varint: objective, route count, a customer count per route and the customers
+  const size_t route_count = std::max(instance_->getVehicleCount(), 1);
+  return 5 * (2 + route_count + instance_->getNodesCount());
+}
+
+std::string SolutionSerializer::encodeSolution(const Solution &solution) {
+  std::string payload;
+  payload.reserve(maxPayloadSize());
+  const int64_t objective = solution.objective;
+  writeVarint(payload, ((uint64_t)objective << 1) ^ (uint64_t)(objective >> 63));
+  writeVarint(payload, solution.routes.size());
+  for(const auto &route : solution.routes){
+    const auto route_nodes = solution.routeNodes(route);
+    size_t customer_count = 0;
+    for(const auto &node : route_nodes)
+      customer_count += node.idx != 0;
+    writeVarint(payload, customer_count);
+    for(const auto &node : route_nodes){
+      if(node.idx != 0)
+        writeVarint(payload, node.idx);
+    }
+  }
+  return payload;
+}
+
+std::shared_ptr<Solution> SolutionSerializer::decodeSolution(std::string_view payload) {
+  const char *position = payload.data();
+  const char *end = payload.data() + payload.size();
+  uint64_t objective, route_count;
+  if(!readVarint(position, end, objective) || !readVarint(position, end, route_count) || route_count > payload.size())
+    return nullptr;
+
+  auto solution = std::make_shared<Solution>();
+  solution->objective = (int)(int64_t)((objective >> 1) ^ (~(objective & 1) + 1));
+  solution->travel_time_sum = 0;
+  solution->end_time_sum = 0;
+  const uint64_t node_count = instance_->getNodesCount();
+  solution->reserve(route_count, node_count + 2 * route_count);
+  std::vector<int> customers;
+  for(uint64_t r = 0; r < route_count; r++){
+    uint64_t customer_count;
+    if(!readVarint(position, end, customer_count) || customer_count >= node_count)
+      return nullptr;
+    customers.clear();
+    for(uint64_t c = 0; c < customer_count; c++){
+      uint64_t idx;
+      if(!readVarint(position, end, idx) || idx == 0 || idx >= node_count)
+        return nullptr;
+      customers.push_back((int)idx);
+    }
+    buildRoute(*solution, customers);
+    solution->travel_time_sum += solution->routes.back().travel_time;
+    solution->end_time_sum += solution->routes.back().end_time;
+    if(!customers.empty())
+      solution->used_vehicles++;
+  }
+  if(position != end)
+    return nullptr;
+  return solution;
+}
+
+void SolutionSerializer::buildRoute(Solution &solution, const std::vector<int> &customers) {
+  // same times as convertSolution of the individuals: TSP and CVRP visits take one time unit, the TSP depot included
+  const auto &nodes = instance_->getNodes();
+  const bool is_tsp = instance_->getProblemType() == TSP || instance_->getProblemType() == ATSP;
+  const bool has_time_windows = instance_->getProblemType() == VRPTW;
+  int time = is_tsp ? 1 : 0;
+  auto &route = solution.addRoute();
+  route.travel_time = 0;
+  route.demand = 0;
+  solution.addNode(0, 0, time);
+  int prev_node = 0;
+  for(const int customer : customers){
+    const int distance = (int)instance_->getDistance(prev_node, customer);
+    route.travel_time += distance;
+    route.demand += nodes[customer].demand;
+    time += distance;
+    if(has_time_windows)
+      time = std::max(time, nodes[customer].ready_time);
+    const int start_time = time;
+    time += has_time_windows ? nodes[customer].service_time : 1;
+    solution.addNode(customer, start_time, time);
+    prev_node = customer;
+  }
+  const int distance = (int)instance_->getDistance(prev_node, 0);
+  route.travel_time += distance;
+  time += distance;
+  solution.addNode(0, time, is_tsp ? time + 1 : time);
+  route.end_time = time;
+}
+
+bool SolutionSerializer::readSolution(std::istream &input, std::shared_ptr<Solution> &solution) {
+  solution = nullptr;
+  if(!binary_protocol_){
+    std::string solution_string;
+    if(!std::getline(input, solution_string))
+      return false;
+    solution = parseSolution(solution_string);
+    return true;
+  }
+
+  unsigned char size_bytes[4];
+  if(!input.read(reinterpret_cast<char *>(size_bytes), 4))
+    return false;
+  const uint32_t size = size_bytes[0] | size_bytes[1] << 8 | size_bytes[2] << 16 | (uint32_t)size_bytes[3] << 24;
+  if(size > max_frame_size){
+    std::cerr << "Invalid solution frame size " << size << std::endl;
+    return false;
+  }
+  std::string payload(size, '\0');
+  if(!input.read(payload.data(), size))
+    return false;
+  solution = decodeSolution(payload);
+  return true;
+}
+
+void SolutionSerializer::writeSolution(std::ostream &output, std::shared_ptr<Solution> &solution) {
+  if(!binary_protocol_){
+    output << serializeSolution(solution) << '\n';
+    return;
+  }
+
+  const std::string payload = encodeSolution(*solution);
+  const auto size = (uint32_t)payload.size();
+  const char size_bytes[4] = {(char)(size & 0xff), (char)(size >> 8 & 0xff), (char)(size >> 16 & 0xff), (char)(size >> 24)};
+  output.write(size_bytes, 4);
+  output.write(payload.data(), (std::streamsize)payload.size());
 }
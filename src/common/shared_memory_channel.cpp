@@ -0,0 +1,124 @@
+#include "common/shared_memory_channel.h"
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iostream>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+              "shared memory sequence numbers need plain lock-free 32-bit atomics");
+
+/** Payload copies racing with the writer are retried this many times before the reader gives up until the next call */
+constexpr int max_read_attempts = 16;
+
+static size_t alignedSize(size_t bytes, size_t alignment) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+static void futexWait(std::atomic<uint32_t> *word, uint32_t expected, int timeout_ms) {
+  timespec timeout{timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000};
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+static void futexWake(std::atomic<uint32_t> *word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+SharedMemoryChannel::SharedMemoryChannel(const std::string &name, uint32_t capacity) :
+  name_(name[0] == '/' ? name : "/" + name), data_(nullptr), size_(0), capacity_(capacity),
+  slot_stride_(alignment_ + alignedSize(capacity, alignment_)), sent_sequence_(0), received_sequence_(0) {
+  size_ = alignment_ + 2 * slot_stride_;
+  const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+  if(fd < 0){
+    std::cerr << "Couldn't create shared memory segment " << name_ << std::endl;
+    return;
+  }
+  if(ftruncate(fd, (off_t)size_) != 0){
+    std::cerr << "Couldn't resize shared memory segment " << name_ << std::endl;
+    close(fd);
+    shm_unlink(name_.c_str());
+    return;
+  }
+  void *mapped = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(mapped == MAP_FAILED){
+    std::cerr << "Couldn't map shared memory segment " << name_ << std::endl;
+    shm_unlink(name_.c_str());
+    return;
+  }
+  data_ = static_cast<char *>(mapped);
+
+  // the segment is zero-filled, the magic is written last as the readiness mark for the solver side
+  header()->version = version_;
+  header()->capacity = capacity_;
+  std::atomic_thread_fence(std::memory_order_release);
+  header()->magic = magic_;
+}
+
+SharedMemoryChannel::~SharedMemoryChannel() {
+  if(data_ == nullptr)
+    return;
+  munmap(data_, size_);
+  shm_unlink(name_.c_str());
+}
+
+SharedMemoryChannel::Header *SharedMemoryChannel::header() const {
+  return reinterpret_cast<Header *>(data_);
+}
+
+SharedMemoryChannel::Slot *SharedMemoryChannel::slot(SlotIndex index) const {
+  return reinterpret_cast<Slot *>(data_ + alignment_ + index * slot_stride_);
+}
+
+char *SharedMemoryChannel::payload(SlotIndex index) const {
+  return data_ + alignment_ + index * slot_stride_ + alignment_;
+}
+
+void SharedMemoryChannel::send(std::string_view payload_data) {
+  if(data_ == nullptr)
+    return;
+  if(payload_data.size() > capacity_){
+    std::cerr << "Solution frame of " << payload_data.size() << " bytes doesn't fit the shared memory slot" << std::endl;
+    return;
+  }
+  Slot *to_solver = slot(TO_SOLVER_SLOT);
+  to_solver->sequence.store(++sent_sequence_, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(payload(TO_SOLVER_SLOT), payload_data.data(), payload_data.size());
+  to_solver->size.store((uint32_t)payload_data.size(), std::memory_order_relaxed);
+  to_solver->sequence.store(++sent_sequence_, std::memory_order_release);
+  futexWake(&to_solver->sequence);
+}
+
+bool SharedMemoryChannel::receive(std::string &payload_data, int timeout_ms) {
+  payload_data.clear();
+  if(data_ == nullptr)
+    return false;
+  Slot *from_solver = slot(FROM_SOLVER_SLOT);
+  uint32_t sequence = from_solver->sequence.load(std::memory_order_acquire);
+  if(sequence == received_sequence_){
+    futexWait(&from_solver->sequence, sequence, timeout_ms);
+    sequence = from_solver->sequence.load(std::memory_order_acquire);
+  }
+  if(header()->closed.load(std::memory_order_acquire) != 0)
+    return false;
+
+  for(int attempt = 0; attempt < max_read_attempts && sequence != received_sequence_; attempt++){
+    if(sequence % 2 == 0){
+      const uint32_t size = std::min(from_solver->size.load(std::memory_order_relaxed), capacity_);
+      payload_data.assign(payload(FROM_SOLVER_SLOT), size);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if(from_solver->sequence.load(std::memory_order_relaxed) == sequence){
+        received_sequence_ = sequence;
+        return true;
+      }
+      payload_data.clear();
+    }
+    sequence = from_solver->sequence.load(std::memory_order_acquire);
+  }
+  return true;
+}
@@ -1,7 +1,5 @@
 #include "common/solomon_loader.h"
 #include <cassert>
-#include <cmath>
-#include <fstream>
 #include <iostream>
 #include <sstream>
 
@@ -10,23 +8,23 @@ void RoutingInstance::SolomonLoader::error() {
   exit(101);
 }
 void RoutingInstance::SolomonLoader::loadHeader(RoutingInstance &instance,
-                                                std::ifstream &file) {
-  std::string line;
-  if(!std::getline(file, line))
+                                                MappedFile &file) {
+  std::string_view line;
+  if(!file.nextLine(line))
     error();
 
-  instance.instance_name_ = line;
+  instance.instance_name_ = std::string(line);
 
-  for(int i = 0; i < 4; i++)
-    if(!std::getline(file, line))
+  for(int i = 0; i < 3; i++)
+    if(!file.nextLine(line))
       error();
 
-  std::istringstream line_stream(line);
-  line_stream >> instance.vehicle_count_;
-  line_stream >> instance.vehicle_capacity_;
+  if(!file.nextInt(instance.vehicle_count_) || !file.nextInt(instance.vehicle_capacity_))
+    error();
+  file.skipLine();
 
   for(int i = 0; i < 4; i++)
-    if(!std::getline(file, line))
+    if(!file.nextLine(line))
       error();
 
   instance.problem_type_ = VRPTW;
@@ -38,15 +36,15 @@ void RoutingInstance::SolomonLoader::loadHeader(RoutingInstance &instance,
 }
 
 void RoutingInstance::SolomonLoader::loadNodes(RoutingInstance &instance,
-                                               std::ifstream &file) {
-  std::string line;
-  std::istringstream line_stream;
+                                               MappedFile &file) {
   int node_count = 0;
   std::vector<std::pair<int, int>> node_coords;
-  while(std::getline(file, line)){
-    int idx, x_coord, y_coord, demand, ready_time, due_date, service_time;
-    line_stream = std::istringstream(line);
-    line_stream >> idx >> x_coord >> y_coord >> demand >> ready_time >> due_date >> service_time;
+  int idx;
+  while(file.nextInt(idx)){
+    int x_coord, y_coord, demand, ready_time, due_date, service_time;
+    if(!file.nextInt(x_coord) || !file.nextInt(y_coord) || !file.nextInt(demand) ||
+       !file.nextInt(ready_time) || !file.nextInt(due_date) || !file.nextInt(service_time))
+      error();
     assert(idx == node_count);
     node_count++;
     instance.nodes_.emplace_back(idx, demand, ready_time, due_date, service_time);
@@ -56,26 +54,15 @@ void RoutingInstance::SolomonLoader::loadNodes(RoutingInstance &instance,
   assert((size_t)node_count == instance.nodes_.size());
   instance.node_count_ = node_count;
 
-  buildTransitionMatrix(instance, node_coords);
+  storeCoordinates(instance, node_coords);
 }
-void RoutingInstance::SolomonLoader::buildTransitionMatrix(
+void RoutingInstance::SolomonLoader::storeCoordinates(
     RoutingInstance &instance,
     const std::vector<std::pair<int, int>> &node_poses) {
-  const auto node_c = instance.nodes_.size();
-  instance.matrix_ = std::shared_ptr<unsigned int[]>(new unsigned int[node_c * node_c]);
-  for(size_t i = 0; i < node_c; i++){
-    for(size_t j = 0; j < node_c; j++){
-      instance.matrix_[i * node_c + j] = dist(node_poses[i], node_poses[j]); // NOLINT(*-narrowing-conversions)
-    }
+  instance.coord_x_.resize(node_poses.size());
+  instance.coord_y_.resize(node_poses.size());
+  for(size_t i = 0; i < node_poses.size(); i++){
+    instance.coord_x_[i] = node_poses[i].first;
+    instance.coord_y_[i] = node_poses[i].second;
   }
-
-  for(size_t i = 0; i < node_c; i++)
-    instance.matrix_[i * node_c + i] = 0; // NOLINT(*-narrowing-conversions)
-}
-
-inline uint RoutingInstance::SolomonLoader::dist(const std::pair<int, int> &n1,
-                                          const std::pair<int, int> &n2) {
-  double float_dist = std::pow((double)(n1.first - n2.first), 2) + std::pow((double)(n1.second - n2.second), 2);
-  float_dist = std::sqrt(float_dist);
-  return (uint)ceil(float_dist);
 }
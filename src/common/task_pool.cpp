@@ -0,0 +1,113 @@
+#include "common/task_pool.h"
+#include <chrono>
+
+TaskPool::TaskPool(unsigned int worker_count, const std::function<void(unsigned int)> &setup) :
+  workers_(), threads_(), queued_tasks_(0), unfinished_tasks_(0), next_worker_(0), stopped_(false) {
+  for(unsigned int w = 0; w < worker_count; w++)
+    workers_.push_back(std::make_unique<Worker>());
+  threads_.reserve(worker_count);
+  for(unsigned int w = 0; w < worker_count; w++){
+    threads_.emplace_back([this, w, setup]()->void{
+      setup(w);
+      work(w);
+    });
+  }
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    stopped_ = true;
+  }
+  task_condition_.notify_all();
+  for(auto &thread : threads_)
+    thread.join();
+}
+
+void TaskPool::submit(Task task) {
+  unsigned int worker_idx;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    unfinished_tasks_++;
+    worker_idx = (unsigned int)(next_worker_++ % workers_.size());
+  }
+  push(worker_idx, std::move(task));
+}
+
+void TaskPool::wait() {
+  std::unique_lock<std::mutex> lock(lock_);
+  finished_condition_.wait(lock, [this](){ return unfinished_tasks_ == 0;});
+}
+
+void TaskPool::push(unsigned int worker_idx, Task task) {
+  // counted before it is published, a worker stealing it at once would otherwise decrement the counter below zero;
+  // a worker woken before the task is in the deque misses it in pop and waits again
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    queued_tasks_++;
+  }
+  {
+    std::lock_guard<std::mutex> lock(workers_[worker_idx]->lock);
+    workers_[worker_idx]->tasks.push_back(std::move(task));
+  }
+  task_condition_.notify_one();
+}
+
+bool TaskPool::pop(unsigned int worker_idx, Task &task) {
+  const auto take = [&](Worker &worker, bool front){
+    std::lock_guard<std::mutex> lock(worker.lock);
+    if(worker.tasks.empty())
+      return false;
+    if(front){
+      task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+    }
+    else{
+      task = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+    }
+    return true;
+  };
+  bool found = take(*workers_[worker_idx], true);
+  for(size_t i = 1; i < workers_.size() && !found; i++)
+    found = take(*workers_[(worker_idx + i) % workers_.size()], false);
+  if(found){
+    std::lock_guard<std::mutex> lock(lock_);
+    queued_tasks_--;
+  }
+  return found;
+}
+
+void TaskPool::work(unsigned int worker_idx) {
+  Task task;
+  size_t idle_streak = 0;
+  while(true){
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      task_condition_.wait(lock, [this](){ return stopped_ || queued_tasks_ > 0;});
+      // every queued task was idle, sleep until a new task comes or a paused one may have been resumed
+      if(idle_streak > queued_tasks_){
+        task_condition_.wait_for(lock, std::chrono::milliseconds(1));
+        idle_streak = 0;
+      }
+      if(stopped_)
+        return;
+    }
+    // another worker may have taken the task in the meantime
+    if(!pop(worker_idx, task))
+      continue;
+    const TaskResult result = task();
+    if(result != TASK_FINISHED){
+      idle_streak = result == TASK_IDLE ? idle_streak + 1 : 0;
+      push(worker_idx, std::move(task));
+      continue;
+    }
+    idle_streak = 0;
+    task = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      unfinished_tasks_--;
+    }
+    finished_condition_.notify_all();
+  }
+}
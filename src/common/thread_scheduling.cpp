@@ -0,0 +1,137 @@
+#include "common/thread_scheduling.h"
+#include <climits>
+#include <fstream>
+#include <iostream>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+ThreadScheduling::ThreadScheduling() : cpu_sets_(), numa_nodes_(), nice_values_(), max_threads_(0), replicate_distances_(false),
+  worker_count_(0), slice_ms_(20), adaptive_(false), exploration_(0.3), discount_(0.9) {}
+
+ThreadScheduling::ThreadScheduling(const nlohmann::json &config) : ThreadScheduling() {
+  // a single value applies to all heuristics, an array is used by the heuristics in turn
+  const auto values = [&](const char *key){
+    if(!config.contains(key))
+      return std::vector<nlohmann::json>();
+    if(config[key].is_array())
+      return config[key].get<std::vector<nlohmann::json>>();
+    return std::vector<nlohmann::json>{config[key]};
+  };
+  try{
+    for(const auto &list : values("cpus")){
+      cpu_sets_.emplace_back();
+      if(!parseCpuList(list.get<std::string>(), cpu_sets_.back())){
+        std::cerr << "Invalid CPU list in scheduling config: " << list << std::endl;
+        exit(100);
+      }
+    }
+    for(const auto &node : values("numa_nodes")){
+      numa_nodes_.push_back(node.get<int>());
+      if(numa_nodes_.back() < 0){
+        std::cerr << "Invalid NUMA node in scheduling config: " << node << std::endl;
+        exit(100);
+      }
+    }
+    for(const auto &nice : values("nice"))
+      nice_values_.push_back(nice.get<int>());
+    max_threads_ = config.value("max_threads", 0u);
+    replicate_distances_ = config.value("replicate_distances", false);
+    worker_count_ = config.value("workers", 0u);
+    slice_ms_ = config.value("slice_ms", 20u);
+    if(slice_ms_ == 0){
+      std::cerr << "Invalid slice_ms in scheduling config: 0" << std::endl;
+      exit(100);
+    }
+    adaptive_ = config.value("adaptive", false);
+    exploration_ = config.value("exploration", 0.3);
+    discount_ = config.value("discount", 0.9);
+    if(exploration_ < 0 || discount_ <= 0 || discount_ > 1){
+      std::cerr << "Invalid exploration or discount in scheduling config" << std::endl;
+      exit(100);
+    }
+  }
+  catch(const nlohmann::json::exception &ex){
+    std::cerr << "Invalid scheduling config: " << ex.what() << std::endl;
+    exit(100);
+  }
+}
+
+bool ThreadScheduling::parseCpuList(const std::string &list, std::vector<int> &cpus) {
+  size_t position = 0;
+  while(position < list.size()){
+    size_t range_end = list.find(',', position);
+    if(range_end == std::string::npos)
+      range_end = list.size();
+    const std::string range = list.substr(position, range_end - position);
+    position = range_end + 1;
+    if(range.find_first_not_of(" \n") == std::string::npos)
+      continue;
+    int first, last;
+    char dash;
+    std::istringstream stream(range);
+    if(!(stream >> first))
+      return false;
+    last = first;
+    if(stream >> dash && (dash != '-' || !(stream >> last)))
+      return false;
+    if(first < 0 || last < first || last >= CPU_SETSIZE)
+      return false;
+    for(int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return !cpus.empty();
+}
+
+std::vector<int> ThreadScheduling::numaNodeCpus(int node) {
+  std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  std::string list;
+  std::vector<int> cpus;
+  if(!std::getline(file, list) || !parseCpuList(list, cpus))
+    cpus.clear();
+  return cpus;
+}
+
+void ThreadScheduling::applyToCurrentThread(unsigned int heuristic_idx) const {
+  std::vector<int> cpus;
+  if(!cpu_sets_.empty())
+    cpus = cpu_sets_[heuristic_idx % cpu_sets_.size()];
+
+  if(!numa_nodes_.empty()){
+    const int node = numa_nodes_[heuristic_idx % numa_nodes_.size()];
+    const auto node_cpus = numaNodeCpus(node);
+    if(node_cpus.empty()){
+      std::cerr << "NUMA node " << node << " not found, heuristic " << heuristic_idx << " is not bound to it" << std::endl;
+    }
+    else{
+      if(cpus.empty())
+        cpus = node_cpus;
+      // preferred rather than strict binding, allocations fall back to other nodes when the node is full
+      constexpr int bits = sizeof(unsigned long) * CHAR_BIT;
+      std::vector<unsigned long> node_mask(node / bits + 1, 0);
+      node_mask[node / bits] |= 1UL << (node % bits);
+      if(syscall(SYS_set_mempolicy, MPOL_PREFERRED, node_mask.data(), node_mask.size() * bits + 1) != 0)
+        std::cerr << "Couldn't bind memory of heuristic " << heuristic_idx << " to NUMA node " << node << std::endl;
+    }
+  }
+
+  if(!cpus.empty()){
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for(const int cpu : cpus)
+      CPU_SET(cpu, &cpu_set);
+    if(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+      std::cerr << "Couldn't set CPU affinity of heuristic " << heuristic_idx << std::endl;
+  }
+
+  if(!nice_values_.empty()){
+    // nice values are per thread on Linux
+    const int nice = nice_values_[heuristic_idx % nice_values_.size()];
+    if(setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice) != 0)
+      std::cerr << "Couldn't set nice value " << nice << " of heuristic " << heuristic_idx << std::endl;
+  }
+}
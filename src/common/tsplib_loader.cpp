@@ -1,8 +1,10 @@
 #include "common/tsplib_loader.h"
 
-inline std::string RoutingInstance::TSPlibLoader::strip(const std::string& line) {
-  auto begin_idx = line.find_first_not_of(" \n\r\t\v");
-  auto last_idx = line.find_last_not_of(" \n\r\t\v");
+inline std::string_view RoutingInstance::TSPlibLoader::strip(std::string_view line) {
+  const auto begin_idx = line.find_first_not_of(" \n\r\t\v");
+  if(begin_idx == std::string_view::npos)
+    return {};
+  const auto last_idx = line.find_last_not_of(" \n\r\t\v");
   return line.substr(begin_idx, last_idx + 1 - begin_idx);
 }
 
@@ -18,12 +20,11 @@ RoutingInstance::TSPlibLoader::latitudeLongitude(double x, double y) {
   return {latitude, longitude};
 }
 
-std::string RoutingInstance::TSPlibLoader::parseName(std::string &line) {
-  return strip(line.substr(line.find(':') + 1));
+std::string RoutingInstance::TSPlibLoader::parseName(std::string_view value) {
+  return std::string(value);
 }
 
-ProblemType RoutingInstance::TSPlibLoader::parseType(std::string &line) {
-  std::string type = strip(line.substr(line.find(':') + 1));
+ProblemType RoutingInstance::TSPlibLoader::parseType(std::string_view type) {
   if(type == "TSP")
     return ProblemType::TSP;
   else if(type == "ATSP")
@@ -36,13 +37,12 @@ ProblemType RoutingInstance::TSPlibLoader::parseType(std::string &line) {
   }
 }
 
-std::string RoutingInstance::TSPlibLoader::parseComment(std::string &line) {
-  return strip(line.substr(line.find(':') + 1));
+std::string RoutingInstance::TSPlibLoader::parseComment(std::string_view value) {
+  return std::string(value);
 }
 
 EdgeWeightType
-RoutingInstance::TSPlibLoader::parseEdgeWeightType(std::string &line) {
-  std::string type = strip(line.substr(line.find(':') + 1));
+RoutingInstance::TSPlibLoader::parseEdgeWeightType(std::string_view type) {
   if(type == "GEO")
     return EdgeWeightType::GEO;
   else if(type == "EUC_2D")
@@ -58,8 +58,7 @@ RoutingInstance::TSPlibLoader::parseEdgeWeightType(std::string &line) {
 }
 
 EdgeWeightFormat
-RoutingInstance::TSPlibLoader::parseEdgeWeightFormat(std::string &line) {
-  std::string format = strip(line.substr(line.find(':') + 1));
+RoutingInstance::TSPlibLoader::parseEdgeWeightFormat(std::string_view format) {
   if(format == "FUNCTION")
     return EdgeWeightFormat::FUNCTION;
   else if(format == "FULL_MATRIX")
@@ -71,8 +70,7 @@ RoutingInstance::TSPlibLoader::parseEdgeWeightFormat(std::string &line) {
 }
 
 DisplayDataType
-RoutingInstance::TSPlibLoader::parseDisplayDataType(std::string &line) {
-  std::string type = strip(line.substr(line.find(':') + 1));
+RoutingInstance::TSPlibLoader::parseDisplayDataType(std::string_view type) {
   if(type == "COORD_DISPLAY")
     return DisplayDataType::COORD_DISPLAY;
   else if(type == "TWOD_DISPLAY")
@@ -86,7 +84,7 @@ RoutingInstance::TSPlibLoader::parseDisplayDataType(std::string &line) {
 }
 
 
-void RoutingInstance::TSPlibLoader::loadNodes(RoutingInstance &instance, std::ifstream &file) {
+void RoutingInstance::TSPlibLoader::loadNodes(RoutingInstance &instance, MappedFile &file) {
   if(instance.edge_weight_type_ == EUC_2D){
     loadNodes_EUC_2D(instance, file);
     //correctMatrix();
@@ -106,101 +104,50 @@ void RoutingInstance::TSPlibLoader::loadNodes(RoutingInstance &instance, std::if
     throw std::domain_error("Not implemented combination of problem type and edge weight type");
   }
 
-  for(int i = 0; i < instance.node_count_; i++)
-    instance.matrix_[i * instance.node_count_ + i] = 0;
-
-  file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  file.skipLine();
 }
 
-void RoutingInstance::TSPlibLoader::loadNodes_EUC_2D(RoutingInstance &instance,
-                                                     std::ifstream &file) {
-  double dump;
-  std::unique_ptr<double[]> nodes_x = std::unique_ptr<double[]>(new double[instance.node_count_]);
-  std::unique_ptr<double[]> nodes_y = std::unique_ptr<double[]>(new double[instance.node_count_]);
+void RoutingInstance::TSPlibLoader::loadCoordinates(RoutingInstance &instance, MappedFile &file) {
+  double node_idx;
+  instance.coord_x_.resize(instance.node_count_);
+  instance.coord_y_.resize(instance.node_count_);
   for(int i = 0; i < instance.node_count_; i++){
-    file >> dump;
-    if(dump != i + 1.0){
+    if(!file.nextDouble(node_idx) || node_idx != i + 1.0){
       std::cerr << "Error loading input node_idx doesn't match" << std::endl;
       exit(110);
     }
-    file >> nodes_x[i];
-    file >> nodes_y[i];
+    if(!file.nextDouble(instance.coord_x_[i]) || !file.nextDouble(instance.coord_y_[i]))
+      numberError();
   }
+}
 
-  instance.matrix_ = std::shared_ptr<unsigned int[]>(new unsigned int[instance.node_count_ * instance.node_count_]);
-
-  for(int i = 0; i < instance.node_count_; i++){
-    for(int j = 0; j < instance.node_count_; j++){
-      auto dist = (unsigned int)round(sqrt(pow(nodes_x[i] - nodes_x[j], 2) + pow(nodes_y[i] - nodes_y[j], 2)));
-      instance.matrix_[i * instance.node_count_ + j] = dist;
-    }
-  }
+void RoutingInstance::TSPlibLoader::loadNodes_EUC_2D(RoutingInstance &instance,
+                                                     MappedFile &file) {
+  loadCoordinates(instance, file);
 }
 
 void RoutingInstance::TSPlibLoader::loadNodes_CEIL_2D(RoutingInstance &instance,
-                                                      std::ifstream &file) {
-  double dump;
-  std::unique_ptr<double[]> nodes_x = std::unique_ptr<double[]>(new double[instance.node_count_]);
-  std::unique_ptr<double[]> nodes_y = std::unique_ptr<double[]>(new double[instance.node_count_]);
-  for(int i = 0; i < instance.node_count_; i++){
-    file >> dump;
-    if(dump != i + 1.0){
-      std::cerr << "Error loading input node_idx doesn't match" << std::endl;
-      exit(110);
-    }
-    file >> nodes_x[i];
-    file >> nodes_y[i];
-  }
-
-  instance.matrix_ = std::shared_ptr<unsigned int[]>(new unsigned int[instance.node_count_ * instance.node_count_]);
-
-  for(int i = 0; i < instance.node_count_; i++){
-    for(int j = 0; j < instance.node_count_; j++){
-      auto dist = (unsigned int)ceil(sqrt(pow(nodes_x[i] - nodes_x[j], 2) + pow(nodes_y[i] - nodes_y[j], 2)));
-      instance.matrix_[i * instance.node_count_ + j] = dist;
-    }
-  }
+                                                      MappedFile &file) {
+  loadCoordinates(instance, file);
 }
 
 void RoutingInstance::TSPlibLoader::loadNodes_GEO(RoutingInstance &instance,
-                                                  std::ifstream &file) {
-  double dump;
-  std::unique_ptr<double[]> nodes_x = std::unique_ptr<double[]>(new double[instance.node_count_]);
-  std::unique_ptr<double[]> nodes_y = std::unique_ptr<double[]>(new double[instance.node_count_]);
-  for(int i = 0; i < instance.node_count_; i++){
-    file >> dump;
-    if(dump != i + 1.0){
-      std::cerr << "Error loading input node_idx doesn't match" << std::endl;
-      exit(110);
-    }
-    file >> nodes_x[i];
-    file >> nodes_y[i];
-  }
-
-  instance.matrix_ = std::shared_ptr<unsigned int[]>(new unsigned int[instance.node_count_ * instance.node_count_]);
-
+                                                  MappedFile &file) {
+  loadCoordinates(instance, file);
   for(int i = 0; i < instance.node_count_; i++){
-    for(int j = 0; j < instance.node_count_; j++){
-      auto lat_long_i = latitudeLongitude(nodes_x[i], nodes_y[i]);
-      auto lat_long_j = latitudeLongitude(nodes_x[j], nodes_y[j]);
-      double q1 = cos(lat_long_i.second - lat_long_j.second);
-      double q2 = cos(lat_long_i.first - lat_long_j.first);
-      double q3 = cos(lat_long_i.first + lat_long_j.first);
-      auto dist = (unsigned int)floor(6378.388 * acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
-      instance.matrix_[i * instance.node_count_ + j] = dist;
-    }
+    auto lat_long = latitudeLongitude(instance.coord_x_[i], instance.coord_y_[i]);
+    instance.coord_x_[i] = lat_long.first;
+    instance.coord_y_[i] = lat_long.second;
   }
 }
 
 void RoutingInstance::TSPlibLoader::loadNodes_FULL_MATRIX(
-    RoutingInstance &instance, std::ifstream &file) {
-  instance.matrix_ = std::shared_ptr<unsigned int[]>(new unsigned int[instance.node_count_ * instance.node_count_]);
-  unsigned int input;
-  for(int i = 0; i < instance.node_count_; i++){
-    for(int j = 0; j < instance.node_count_; j++){
-      file >> input;
-      instance.matrix_[i * instance.node_count_ + j] = input;
-    }
+    RoutingInstance &instance, MappedFile &file) {
+  instance.explicit_matrix_ = std::vector<uint>((size_t)instance.node_count_ * instance.node_count_);
+  const size_t size = (size_t)instance.node_count_ * instance.node_count_;
+  for(size_t i = 0; i < size; i++){
+    if(!file.nextUInt(instance.explicit_matrix_[i]))
+      numberError();
   }
 }
 
@@ -216,27 +163,30 @@ void RoutingInstance::TSPlibLoader::fillNodes(RoutingInstance &instance) {
 }
 
 void RoutingInstance::TSPlibLoader::loadDemand(RoutingInstance &instance,
-                                               std::ifstream &file) {
+                                               MappedFile &file) {
   for(int i = 0; i < instance.node_count_; i++){
     int dump, demand;
-    file >> dump >> demand;
+    if(!file.nextInt(dump) || !file.nextInt(demand))
+      numberError();
     assert(dump == i + 1);
     instance.nodes_[i].demand = demand;
   }
-  file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  file.skipLine();
 }
 
 void RoutingInstance::TSPlibLoader::loadDepos(RoutingInstance &instance,
-                                              std::ifstream &file) {
+                                              MappedFile &file) {
   std::vector<int> depos;
   int depo;
-  file >> depo;
+  if(!file.nextInt(depo))
+    numberError();
   while(depo != -1){
     depos.push_back(depo - 1);
     assert(instance.nodes_[depo - 1].demand == 0); // Depots have to have zero demand
-    file >> depo;
+    if(!file.nextInt(depo))
+      numberError();
   }
-  file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  file.skipLine();
 
   assert(depos.size() == 1); // not implemented for more depots
   assert(depos[0] == 0); // not implemented for other depot than 0
@@ -244,67 +194,65 @@ void RoutingInstance::TSPlibLoader::loadDepos(RoutingInstance &instance,
   instance.depots_ = {0};
 }
 
-void RoutingInstance::TSPlibLoader::loadHeader(RoutingInstance &instance,
-                                               std::ifstream &file) {
-  const std::regex name_regex = std::regex("^ *NAME *:");
-  const std::regex type_regex = std::regex("^ *TYPE *:");
-  const std::regex comment_regex = std::regex("^ *COMMENT *:");
-  const std::regex dimension_regex = std::regex("^ *DIMENSION *:");
-  const std::regex edge_weight_type_regex = std::regex("^ *EDGE_WEIGHT_TYPE *:");
-  const std::regex edge_weight_format_regex = std::regex("^ *EDGE_WEIGHT_FORMAT *:");
-  const std::regex display_data_type_regex = std::regex("^ *DISPLAY_DATA_TYPE *:");
-  const std::regex node_coord_section_regex = std::regex("^ *NODE_COORD_SECTION *");
-  const std::regex edge_weight_section_regex = std::regex("^ *EDGE_WEIGHT_SECTION *");
-  const std::regex demand_regex = std::regex("^ *DEMAND_SECTION *");
-  const std::regex depot_regex = std::regex("^ *DEPOT_SECTION *");
-  const std::regex capacity_regex = std::regex("^ *CAPACITY *:");
-  const std::regex eof_regex = std::regex("^ *EOF *");
+void RoutingInstance::TSPlibLoader::numberError() {
+  std::cerr << "Error loading input, number expected" << std::endl;
+  exit(110);
+}
 
-  std::string line;
-  while( std::getline(file, line) )
+void RoutingInstance::TSPlibLoader::loadHeader(RoutingInstance &instance,
+                                               MappedFile &file) {
+  std::string_view line;
+  while(file.nextLine(line))
   {
+    line = strip(line);
     if(line.empty())
       continue;
 
-    if(std::regex_search(line, name_regex)){
-      instance.instance_name_ = parseName(line);
+    // "KEYWORD : value" lines and "KEYWORD" section lines
+    const auto colon_idx = line.find(':');
+    const std::string_view keyword = strip(line.substr(0, colon_idx));
+    const std::string_view value = colon_idx == std::string_view::npos ? std::string_view() : strip(line.substr(colon_idx + 1));
+
+    if(keyword == "NAME"){
+      instance.instance_name_ = parseName(value);
     }
-    else if(std::regex_search(line, type_regex)){
-      instance.problem_type_ = parseType(line);
+    else if(keyword == "TYPE"){
+      instance.problem_type_ = parseType(value);
     }
-    else if(std::regex_search(line, comment_regex)){
-      instance.comment_ = parseComment(line);
+    else if(keyword == "COMMENT"){
+      instance.comment_ = parseComment(value);
     }
-    else if(std::regex_search(line, dimension_regex)){
-      instance.node_count_ = std::stoi(line.substr(line.find(':') + 1));
+    else if(keyword == "DIMENSION"){
+      if(std::from_chars(value.data(), value.data() + value.size(), instance.node_count_).ec != std::errc())
+        numberError();
       fillNodes(instance);
     }
-    else if(std::regex_search(line, edge_weight_type_regex)){
-      instance.edge_weight_type_ = parseEdgeWeightType(line);
+    else if(keyword == "EDGE_WEIGHT_TYPE"){
+      instance.edge_weight_type_ = parseEdgeWeightType(value);
     }
-    else if(std::regex_search(line, edge_weight_format_regex)){
-      instance.edge_weight_format_ = parseEdgeWeightFormat(line);
+    else if(keyword == "EDGE_WEIGHT_FORMAT"){
+      instance.edge_weight_format_ = parseEdgeWeightFormat(value);
     }
-    else if(std::regex_search(line, display_data_type_regex)) {
-      instance.display_data_type_ = parseDisplayDataType(line);
+    else if(keyword == "DISPLAY_DATA_TYPE") {
+      instance.display_data_type_ = parseDisplayDataType(value);
     }
-    else if(std::regex_search(line, capacity_regex)){
-      std::string cap_str = strip(line.substr(line.find(':') + 1));
-      instance.vehicle_capacity_ = std::stoi(cap_str);
+    else if(keyword == "CAPACITY"){
+      if(std::from_chars(value.data(), value.data() + value.size(), instance.vehicle_capacity_).ec != std::errc())
+        numberError();
     }
-    else if(std::regex_search(line, node_coord_section_regex)){
+    else if(keyword == "NODE_COORD_SECTION"){
       loadNodes(instance, file);
     }
-    else if(std::regex_search(line, edge_weight_section_regex)){
+    else if(keyword == "EDGE_WEIGHT_SECTION"){
       loadNodes(instance, file);
     }
-    else if(std::regex_search(line, demand_regex)){
+    else if(keyword == "DEMAND_SECTION"){
       loadDemand(instance, file);
     }
-    else if(std::regex_search(line, depot_regex)){
+    else if(keyword == "DEPOT_SECTION"){
       loadDepos(instance, file);
     }
-    else if(std::regex_search(line, eof_regex)){
+    else if(keyword == "EOF"){
       break;
     }
     else{
@@ -312,4 +260,4 @@ void RoutingInstance::TSPlibLoader::loadHeader(RoutingInstance &instance,
       exit(100);
     }
   }
-}
\ No newline at end of file
+}
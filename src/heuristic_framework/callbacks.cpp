@@ -13,6 +13,10 @@ bool Callbacks::shouldTerminate() {
   return terminate_();
 }
 
+void Callbacks::pollOutsideSolution() {
+  poll_outside_solution_();
+}
+
 void Callbacks::addNewBestSolutionCallback(
     const std::function<void(const std::shared_ptr<Individual> &)>& function) {
   new_best_solution_callbacks_.push_back(function);
@@ -22,7 +26,12 @@ void Callbacks::setTerminationCondition(std::function<bool()> function) {
   terminate_ = std::move(function);
 }
 
+void Callbacks::setOutsideSolutionPoll(std::function<void()> function) {
+  poll_outside_solution_ = std::move(function);
+}
+
 Callbacks::Callbacks(): new_best_solution_callbacks_() {
+  poll_outside_solution_ = []() -> void {};
   terminate_ = []() -> bool{
     std::cerr << "Termination condition not set!" << std::endl;
     return true;
@@ -11,30 +11,36 @@ ExhaustiveLocalSearch::ExhaustiveLocalSearch(
   assert(neighborhood != nullptr);
 }
 
-void ExhaustiveLocalSearch::run(
+void ExhaustiveLocalSearch::start(
     const std::shared_ptr<Individual> &initialSolution) {
-  std::shared_ptr<Individual> solution = initialSolution->deepcopy();
-  solution->evaluate();
-  best_individual_ = solution->deepcopy();
+  solution_ = initialSolution->deepcopy();
+  solution_->evaluate();
+  best_individual_ = solution_->deepcopy();
+  neighborhood_->reset(solution_);
+}
 
-  while(!callbacks_->shouldTerminate()){
-    if(checkOutsideSolution()){
-      solution = best_individual_->deepcopy();
-    }
-    Neighborhood::SearchResult result = neighborhood_->search(solution);
-    if(result == Neighborhood::SearchResult::IMPROVED){
-      // send solution if it is the best so far
-      checkBetterSolution(solution);
-    }else if(result == Neighborhood::SearchResult::UNIMPROVED){
-      // nothing to do
-    }else if(result == Neighborhood::SearchResult::EXHAUSTED){
-      // restart search
-      //std::cerr << "Restarted search" << std::endl;
-      neighborhood_->reset(solution);
-      solution->smartInitialize();
-      solution->evaluate();
-    }
+bool ExhaustiveLocalSearch::step() {
+  if(callbacks_->shouldTerminate())
+    return false;
+  callbacks_->pollOutsideSolution();
+  if(checkOutsideSolution()){
+    solution_ = best_individual_->deepcopy();
+    neighborhood_->reset(solution_);
+  }
+  Neighborhood::SearchResult result = neighborhood_->search(solution_);
+  if(result == Neighborhood::SearchResult::IMPROVED){
+    // send solution if it is the best so far
+    checkBetterSolution(solution_);
+  }else if(result == Neighborhood::SearchResult::UNIMPROVED){
+    // nothing to do
+  }else if(result == Neighborhood::SearchResult::EXHAUSTED){
+    // restart search
+    //std::cerr << "Restarted search" << std::endl;
+    solution_->smartInitialize([this]() -> bool {return callbacks_->shouldTerminate();});
+    solution_->evaluate();
+    neighborhood_->reset(solution_);
   }
+  return true;
 }
 
 void ExhaustiveLocalSearch::acceptOutsideSolution(
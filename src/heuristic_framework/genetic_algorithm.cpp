@@ -23,30 +23,34 @@ GeneticAlgorithm::GeneticAlgorithm(
   assert(replacement != nullptr);
 }
 
-void GeneticAlgorithm::run(
+void GeneticAlgorithm::start(
     const std::shared_ptr<Population> &initialPopulation) {
   population_ = initialPopulation;
   population_->evaluate();
   best_individual_ = population_->getBestIndividual();
+}
 
-  while(!callbacks_->shouldTerminate()){
-    auto select_size = (int)((double)population_->size() * crossover_->getCrossoverRate());
-    auto selection = selection_->select(population_, select_size);
-    auto child_pop = crossover_->crossover(population_, selection);
-    for(uint i = 0; i < child_pop->size(); i++){
-      if(getRandomBool(mutation_->getMutationRate())){
-        const auto &individual = child_pop->getIndividual(i);
-        mutation_->mutate(individual);
-        individual->resetEvaluated();
-      }
-    }
-    checkOutsideSolution(child_pop);
-    child_pop->evaluate();
-    if(checkBetterSolution(child_pop->getBestIndividual())){
-      callbacks_->newBestSolution(child_pop->getBestIndividual());
+bool GeneticAlgorithm::step() {
+  if(callbacks_->shouldTerminate())
+    return false;
+  callbacks_->pollOutsideSolution();
+  auto select_size = (int)((double)population_->size() * crossover_->getCrossoverRate());
+  auto selection = selection_->select(population_, select_size);
+  auto child_pop = crossover_->crossover(population_, selection);
+  for(uint i = 0; i < child_pop->size(); i++){
+    if(getRandomBool(mutation_->getMutationRate())){
+      const auto &individual = child_pop->getIndividual(i);
+      mutation_->mutate(individual);
+      individual->resetEvaluated();
     }
-    population_ = replacement_->replacementFunction(population_, child_pop, population_->size());
   }
+  checkOutsideSolution(child_pop);
+  child_pop->evaluate();
+  if(checkBetterSolution(child_pop->getBestIndividual())){
+    callbacks_->newBestSolution(child_pop->getBestIndividual());
+  }
+  population_ = replacement_->replacementFunction(population_, child_pop, population_->size());
+  return true;
 }
 
 bool GeneticAlgorithm::checkBetterSolution(
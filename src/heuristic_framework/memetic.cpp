@@ -14,6 +14,7 @@ MemeticAlgorithm::MemeticAlgorithm(
   selection_ = selection;
   crossover_ = crossover;
   replacement_ = replacement;
+  stable_population_size_ = 0;
   assert(callbacks != nullptr);
   assert(neighborhood != nullptr);
   assert(mutation != nullptr);
@@ -55,59 +56,67 @@ void MemeticAlgorithm::acceptOutsideSolution(
   }
 }
 
-void MemeticAlgorithm::run(
+void MemeticAlgorithm::start(
     const std::shared_ptr<Population> &initialPopulation) {
   population_ = initialPopulation;
   population_->evaluate();
   best_individual_ = population_->getBestIndividual()->deepcopy();
-  uint stable_population_size = (uint)population_->size();
+  stable_population_size_ = (uint)population_->size();
+}
 
-  while(!callbacks_->shouldTerminate()){
-    if(checkOutsideSolution()){
-      // Add outside solution to population
-      population_->addIndividual(best_individual_);
-    }else{
-      // Add a new random solution to population
-      auto new_solution = population_->getIndividual(0)->deepcopy();
-      new_solution->smartInitialize();
-      new_solution->resetEvaluated();
-      new_solution->evaluate();
-      assert(new_solution->getFitness() > 0);
-      population_->addIndividual(new_solution);
-      neighborhood_->reset(best_individual_);
-      Neighborhood::SearchResult result = neighborhood_->search(new_solution);
-      while(result != Neighborhood::SearchResult::EXHAUSTED){
-        checkBetterSolution(new_solution);
-        result = neighborhood_->search(new_solution);
-      }
-      checkBetterSolution(new_solution);
-    }
+bool MemeticAlgorithm::step() {
+  if(callbacks_->shouldTerminate())
+    return false;
+  callbacks_->pollOutsideSolution();
+  if(checkOutsideSolution()){
+    // Add outside solution to population
+    population_->addIndividual(best_individual_);
+  }else{
+    // Add a new random solution to population
+    auto new_solution = population_->getIndividual(0)->deepcopy();
+    new_solution->smartInitialize([this]() -> bool {return callbacks_->shouldTerminate();});
+    new_solution->resetEvaluated();
+    new_solution->evaluate();
+    assert(new_solution->getFitness() > 0);
+    population_->addIndividual(new_solution);
+    if(!localSearch(new_solution))
+      return false;
+  }
 
-    // Select parents and gen new population by crossover
-    auto select_size = (int)((double)population_->size() * crossover_->getCrossoverRate());
-    auto selection = selection_->select(population_, select_size);
-    auto child_pop = crossover_->crossover(population_, selection);
+  // Select parents and gen new population by crossover
+  auto select_size = (int)((double)population_->size() * crossover_->getCrossoverRate());
+  auto selection = selection_->select(population_, select_size);
+  auto child_pop = crossover_->crossover(population_, selection);
 
-    // Mutate and locally optimize new population
-    for(uint i = 0; i < child_pop->size(); i++){
-      const auto &individual = child_pop->getIndividual((int)i);
-      if(getRandomBool(mutation_->getMutationRate())){
-        mutation_->mutate(individual);
-      }
-      individual->evaluate();
-      neighborhood_->reset(individual);
-      Neighborhood::SearchResult result = neighborhood_->search(individual);
-      while(result != Neighborhood::SearchResult::EXHAUSTED){
-        checkBetterSolution(individual);
-        result = neighborhood_->search(individual);
-      }
-      checkBetterSolution(individual);
+  // Mutate and locally optimize new population
+  for(uint i = 0; i < child_pop->size(); i++){
+    const auto &individual = child_pop->getIndividual((int)i);
+    if(getRandomBool(mutation_->getMutationRate())){
+      mutation_->mutate(individual);
     }
+    individual->evaluate();
+    if(!localSearch(individual))
+      return false;
+  }
 
-    // Merge new population into population
-    population_ = replacement_->replacementFunction(population_, child_pop, stable_population_size);
+  // Merge new population into population
+  population_ = replacement_->replacementFunction(population_, child_pop, stable_population_size_);
+  return true;
+}
+bool MemeticAlgorithm::localSearch(const std::shared_ptr<Individual> &individual) {
+  neighborhood_->reset(individual);
+  Neighborhood::SearchResult result = neighborhood_->search(individual);
+  while(result != Neighborhood::SearchResult::EXHAUSTED){
+    checkBetterSolution(individual);
+    // a generation runs many local searches, on large instances it would delay the termination by seconds
+    if(callbacks_->shouldTerminate())
+      return false;
+    result = neighborhood_->search(individual);
   }
+  checkBetterSolution(individual);
+  return true;
 }
+
 bool MemeticAlgorithm::getRandomBool(const double &success_rate) {
   return dist_(gen_) < success_rate;
 }
@@ -0,0 +1,307 @@
+#include "heuristic_framework/ruin_recreate.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+/** Exponent of the random rank in worst removal (Ropke and Pisinger), higher values remove the worst customers more
+ * deterministically */
+constexpr double worst_removal_randomness = 3.0;
+
+RuinRecreate::RuinRecreate(
+    const std::shared_ptr<Callbacks> &callbacks,
+    const std::shared_ptr<RuinRecreateOperators> &operators,
+    const RuinRecreateParameters &parameters) : parameters_(parameters), rand_(), gen_(rand_()) {
+  callbacks_ = callbacks;
+  operators_ = operators;
+  candidate_count_ = std::min(parameters.candidate_count, operators->getCandidateCount());
+  current_cost_ = 0;
+  best_cost_ = 0;
+  run_time_ = 0;
+  temperature_ = parameters.initial_temperature;
+  assert(callbacks != nullptr);
+  assert(operators != nullptr);
+  assert(candidate_count_ > 0);
+}
+
+void RuinRecreate::start(
+    const std::shared_ptr<Individual> &initial_solution) {
+  current_ = initial_solution->deepcopy();
+  current_->evaluate();
+  current_cost_ = operators_->getCost(*current_);
+  best_ = current_;
+  best_cost_ = current_cost_;
+  positions_.assign(operators_->getNodesCount(), {0, 0});
+  is_removed_.assign(operators_->getNodesCount(), false);
+  is_ruined_.assign(operators_->getRouteCount(*current_), false);
+  run_time_ = 0;
+}
+
+bool RuinRecreate::step() {
+  if(callbacks_->shouldTerminate())
+    return false;
+  const auto unit_start = std::chrono::steady_clock::now();
+  callbacks_->pollOutsideSolution();
+  checkOutsideSolution();
+
+  // exponential cooling over the run time of the units only, the time the portfolio runs other heuristics or pauses
+  // this one doesn't cool it
+  const double progress = std::min(run_time_ / parameters_.cooling_time, 1.0);
+  temperature_ = parameters_.initial_temperature *
+                 std::pow(parameters_.final_temperature / parameters_.initial_temperature, progress);
+  bool improved = false;
+  for(uint i = 0; i < parameters_.iterations_per_unit && !callbacks_->shouldTerminate(); i++){
+    if(iterate())
+      improved = true;
+  }
+  run_time_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - unit_start).count();
+  if(improved)
+    callbacks_->newBestSolution(best_);
+  return true;
+}
+
+void RuinRecreate::acceptOutsideSolution(
+    const std::shared_ptr<Individual> &individual) {
+  std::lock_guard<std::recursive_mutex> lock(outside_solution_mutex_);
+  if(outside_solution_ == nullptr || individual->betterThan(outside_solution_)){
+    outside_solution_ = individual;
+  }
+}
+
+bool RuinRecreate::checkOutsideSolution() {
+  std::shared_ptr<Individual> individual;
+  {
+    std::lock_guard<std::recursive_mutex> lock(outside_solution_mutex_);
+    individual = outside_solution_;
+    outside_solution_ = nullptr;
+  }
+  if(individual == nullptr || !individual->betterThan(best_))
+    return false;
+  // accepted solutions are never modified, the current and the best one may be shared
+  best_ = individual;
+  best_cost_ = operators_->getCost(*best_);
+  current_ = best_;
+  current_cost_ = best_cost_;
+  return true;
+}
+
+bool RuinRecreate::iterate() {
+  auto candidate = current_->deepcopy();
+  Individual &individual = *candidate;
+  const uint route_count = operators_->getRouteCount(individual);
+  for(uint r = 0; r < route_count; r++){
+    const uint route_size = operators_->getRouteSize(individual, r);
+    for(uint i = 0; i < route_size; i++)
+      positions_[operators_->getCustomer(individual, r, i)] = {r, i};
+  }
+
+  removed_.clear();
+  const auto &removals = parameters_.removals;
+  const uint customer_count = operators_->getNodesCount() - 1;
+  const uint count = std::min(std::uniform_int_distribution<uint>(1, 2 * parameters_.average_removed - 1)(gen_), customer_count);
+  switch(removals[std::uniform_int_distribution<size_t>(0, removals.size() - 1)(gen_)]){
+    case STRING_RUIN:
+      stringRuin(individual);
+      break;
+    case RANDOM_RUIN:
+      randomRuin(count);
+      break;
+    case RELATED_RUIN:
+      relatedRuin(count);
+      break;
+    case WORST_RUIN:
+      worstRuin(individual, count);
+      break;
+  }
+  removeMarked(individual);
+  recreate(individual);
+
+  const double candidate_cost = operators_->getCost(individual);
+  const bool improved = candidate->betterThan(best_);
+  if(improved){
+    best_ = candidate;
+    best_cost_ = candidate_cost;
+  }
+  if(improved || accept(candidate_cost)){
+    current_ = candidate;
+    current_cost_ = candidate_cost;
+  }
+  return improved;
+}
+
+bool RuinRecreate::accept(double candidate_cost) {
+  if(parameters_.acceptance == RECORD_TO_RECORD_ACCEPTANCE)
+    return candidate_cost <= (1 + parameters_.deviation) * best_cost_;
+  return candidate_cost < current_cost_ - temperature_ * std::log(std::uniform_real_distribution<double>(0, 1)(gen_));
+}
+
+bool RuinRecreate::markRemoved(uint node) {
+  if(is_removed_[node])
+    return false;
+  is_removed_[node] = true;
+  removed_.push_back(node);
+  return true;
+}
+
+void RuinRecreate::stringRuin(Individual &individual) {
+  const uint route_count = operators_->getRouteCount(individual);
+  uint used_routes = 0;
+  uint customer_count = 0;
+  for(uint r = 0; r < route_count; r++){
+    const uint route_size = operators_->getRouteSize(individual, r);
+    used_routes += route_size == 0 ? 0 : 1;
+    customer_count += route_size;
+  }
+  if(used_routes == 0)
+    return;
+  // longest string and number of ruined routes, so that average_removed customers are removed on average
+  const double max_length = std::min((double)parameters_.max_string_length, (double)customer_count / used_routes);
+  const double max_strings = std::max(4.0 * parameters_.average_removed / (1 + max_length) - 1, 1.0);
+  const uint string_count = (uint)std::uniform_real_distribution<double>(1, max_strings + 1)(gen_);
+  std::uniform_real_distribution<double> probability(0, 1);
+
+  std::fill(is_ruined_.begin(), is_ruined_.end(), false);
+  const uint seed = std::uniform_int_distribution<uint>(1, operators_->getNodesCount() - 1)(gen_);
+  const uint *candidates = operators_->getCandidates(seed);
+  uint ruined_count = 0;
+  for(uint k = 0; k <= candidate_count_ && ruined_count < string_count; k++){
+    const uint node = k == 0 ? seed : candidates[k - 1];
+    if(node == 0 || is_removed_[node] || is_ruined_[positions_[node].route_idx])
+      continue;
+    const uint route_idx = positions_[node].route_idx;
+    const uint route_size = operators_->getRouteSize(individual, route_idx);
+    const double max_route_length = std::min((double)route_size, max_length);
+    const uint length = (uint)std::uniform_real_distribution<double>(1, max_route_length + 1)(gen_);
+
+    // split string: a substring of kept customers inside a longer string
+    uint kept_length = 0;
+    if(length < route_size && probability(gen_) < parameters_.split_rate){
+      kept_length = 1;
+      while(length + kept_length < route_size && probability(gen_) > parameters_.split_depth)
+        kept_length++;
+    }
+    const uint total_length = length + kept_length;
+    const uint position = positions_[node].customer_idx;
+    const uint first = std::uniform_int_distribution<uint>(position + 1 >= total_length ? position + 1 - total_length : 0,
+                                                           std::min(position, route_size - total_length))(gen_);
+    const uint kept_first = first + std::uniform_int_distribution<uint>(0, length)(gen_);
+    for(uint i = first; i < first + total_length; i++){
+      if(i < kept_first || i >= kept_first + kept_length)
+        markRemoved(operators_->getCustomer(individual, route_idx, i));
+    }
+    is_ruined_[route_idx] = true;
+    ruined_count++;
+  }
+}
+
+void RuinRecreate::randomRuin(uint count) {
+  std::uniform_int_distribution<uint> node_dist(1, operators_->getNodesCount() - 1);
+  while(removed_.size() < count)
+    markRemoved(node_dist(gen_));
+}
+
+void RuinRecreate::relatedRuin(uint count) {
+  const uint seed = std::uniform_int_distribution<uint>(1, operators_->getNodesCount() - 1)(gen_);
+  markRemoved(seed);
+  const uint *candidates = operators_->getCandidates(seed);
+  for(uint k = 0; k < candidate_count_ && removed_.size() < count; k++){
+    if(candidates[k] != 0)
+      markRemoved(candidates[k]);
+  }
+}
+
+void RuinRecreate::worstRuin(Individual &individual, uint count) {
+  const uint route_count = operators_->getRouteCount(individual);
+  removal_costs_.clear();
+  for(uint r = 0; r < route_count; r++){
+    const uint route_size = operators_->getRouteSize(individual, r);
+    for(uint i = 0; i < route_size; i++){
+      const FitnessDiff diff = operators_->getRemovalCost(individual, r, i);
+      removal_costs_.emplace_back(diff.fitness + parameters_.vehicle_cost * diff.vehicles +
+                                  parameters_.violation_cost * diff.constraints, operators_->getCustomer(individual, r, i));
+    }
+  }
+  // the savings aren't updated after each removal
+  std::sort(removal_costs_.begin(), removal_costs_.end());
+  std::uniform_real_distribution<double> probability(0, 1);
+  while(removed_.size() < count && !removal_costs_.empty()){
+    const auto k = (size_t)(std::pow(probability(gen_), worst_removal_randomness) * (double)removal_costs_.size());
+    markRemoved(removal_costs_[k].second);
+    removal_costs_.erase(removal_costs_.begin() + (long)k);
+  }
+}
+
+void RuinRecreate::removeMarked(Individual &individual) {
+  const uint route_count = operators_->getRouteCount(individual);
+  for(uint r = 0; r < route_count; r++){
+    // from the route end, so that the positions of the customers in front stay valid
+    uint end = operators_->getRouteSize(individual, r);
+    while(end > 0){
+      if(!is_removed_[operators_->getCustomer(individual, r, end - 1)]){
+        end--;
+        continue;
+      }
+      uint start = end - 1;
+      while(start > 0 && is_removed_[operators_->getCustomer(individual, r, start - 1)])
+        start--;
+      operators_->performRemoval(individual, r, start, end - start);
+      end = start;
+    }
+  }
+  for(const uint node : removed_)
+    is_removed_[node] = false;
+}
+
+void RuinRecreate::recreate(Individual &individual) {
+  RuinRecreateOperators &operators = *operators_;
+  // orders of the insertion weighted as in SISR: random, demand, far from the depot, close to the depot
+  switch(std::discrete_distribution<int>({4, 4, 2, 1})(gen_)){
+    case 0:
+      std::shuffle(removed_.begin(), removed_.end(), gen_);
+      break;
+    case 1:
+      std::sort(removed_.begin(), removed_.end(), [&](uint a, uint b){ return operators.getDemand(a) > operators.getDemand(b); });
+      break;
+    case 2:
+      std::sort(removed_.begin(), removed_.end(), [&](uint a, uint b){ return operators.getDepotDistance(a) > operators.getDepotDistance(b); });
+      break;
+    default:
+      std::sort(removed_.begin(), removed_.end(), [&](uint a, uint b){ return operators.getDepotDistance(a) < operators.getDepotDistance(b); });
+      break;
+  }
+
+  const uint route_count = operators.getRouteCount(individual);
+  const double blink_rate = parameters_.blink_rate;
+  std::uniform_real_distribution<double> probability(0, 1);
+  for(const uint node : removed_){
+    // every position blinked: the front of the first route
+    CustomerPosition best_position = {0, 0};
+    FitnessDiff best_diff = {0, 0, 0};
+    bool found = false;
+    bool empty_route_tried = false;
+    for(uint r = 0; r < route_count; r++){
+      const uint route_size = operators.getRouteSize(individual, r);
+      // all empty routes are the same
+      if(route_size == 0){
+        if(empty_route_tried)
+          continue;
+        empty_route_tried = true;
+      }
+      // every position of an overloaded route is worse than an insertion without violation
+      if(found && best_diff.constraints <= 0 && operators.exceedsCapacity(individual, r, node))
+        continue;
+      for(uint i = 0; i <= route_size; i++){
+        if(blink_rate > 0 && probability(gen_) < blink_rate)
+          continue;
+        const FitnessDiff diff = operators.getInsertionCost(individual, r, i, node);
+        if(!found || diff.constraints < best_diff.constraints ||
+           (diff.constraints == best_diff.constraints && diff.vehicles < best_diff.vehicles) ||
+           (diff.constraints == best_diff.constraints && diff.vehicles == best_diff.vehicles && diff.fitness < best_diff.fitness)){
+          best_position = {r, i};
+          best_diff = diff;
+          found = true;
+        }
+      }
+    }
+    operators.performInsertion(individual, best_position.route_idx, best_position.customer_idx, node);
+  }
+}
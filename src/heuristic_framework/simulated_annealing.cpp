@@ -13,22 +13,26 @@ SimulatedAnnealing::SimulatedAnnealing(
   assert(schedule != nullptr);
 }
 
-void SimulatedAnnealing::run(
+void SimulatedAnnealing::start(
     const std::shared_ptr<Individual> &initialSolution) {
   schedule_->reset();
-  std::shared_ptr<Individual> solution = initialSolution->deepcopy();
-  solution->evaluate();
-  best_individual_ = solution->deepcopy();
+  solution_ = initialSolution->deepcopy();
+  solution_->evaluate();
+  best_individual_ = solution_->deepcopy();
+}
 
-  while(!callbacks_->shouldTerminate()){
-    if(checkOutsideSolution()){
-      solution = best_individual_->deepcopy();
-    }
-    StepResult stepResult = step_->step(solution, schedule_, best_individual_);
-    solution->evaluate();
-    schedule_->registerResult(stepResult);
-    checkBetterSolution(solution);
+bool SimulatedAnnealing::step() {
+  if(callbacks_->shouldTerminate())
+    return false;
+  callbacks_->pollOutsideSolution();
+  if(checkOutsideSolution()){
+    solution_ = best_individual_->deepcopy();
   }
+  StepResult stepResult = step_->step(solution_, schedule_, best_individual_);
+  solution_->evaluate();
+  schedule_->registerResult(stepResult);
+  checkBetterSolution(solution_);
+  return true;
 }
 
 void SimulatedAnnealing::acceptOutsideSolution(
@@ -12,22 +12,26 @@ SimulatedAnnealingBasic::SimulatedAnnealingBasic(
   assert(schedule != nullptr);
 }
 
-void SimulatedAnnealingBasic::run(
+void SimulatedAnnealingBasic::start(
     const std::shared_ptr<Individual> &initialSolution) {
-  std::shared_ptr<Individual> solution = initialSolution->deepcopy();
-  solution->evaluate();
-  best_individual_ = solution->deepcopy();
-
-  while(!callbacks_->shouldTerminate()){
-    if(checkOutsideSolution()){
-      solution = best_individual_->deepcopy();
-    }
+  solution_ = initialSolution->deepcopy();
+  solution_->evaluate();
+  best_individual_ = solution_->deepcopy();
+}
 
-    StepResult stepResult = step_->step(solution, schedule_);
-    solution->evaluate();
-    schedule_->registerResult(stepResult);
-    checkBetterSolution(solution);
+bool SimulatedAnnealingBasic::step() {
+  if(callbacks_->shouldTerminate())
+    return false;
+  callbacks_->pollOutsideSolution();
+  if(checkOutsideSolution()){
+    solution_ = best_individual_->deepcopy();
   }
+
+  StepResult stepResult = step_->step(solution_, schedule_);
+  solution_->evaluate();
+  schedule_->registerResult(stepResult);
+  checkBetterSolution(solution_);
+  return true;
 }
 
 void SimulatedAnnealingBasic::acceptOutsideSolution(
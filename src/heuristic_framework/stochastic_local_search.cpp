@@ -10,29 +10,33 @@ StochasticLocalSearch::StochasticLocalSearch(const std::shared_ptr<Callbacks> &c
   assert(mutation != nullptr);
 }
 
-void StochasticLocalSearch::run(const std::shared_ptr<Individual> &initialSolution) {
-  std::shared_ptr<Individual> solution = initialSolution->deepcopy();
-  solution->evaluate();
-  best_individual_ = solution->deepcopy();
+void StochasticLocalSearch::start(const std::shared_ptr<Individual> &initialSolution) {
+  solution_ = initialSolution->deepcopy();
+  solution_->evaluate();
+  best_individual_ = solution_->deepcopy();
+}
 
-  while(!callbacks_->shouldTerminate()){
-    if(checkOutsideSolution()){
-      solution = best_individual_->deepcopy();
-    }
-    if(mutation_->isInPlace()){
-      mutation_->mutate(solution);
-      solution->evaluate();
-      checkBetterSolution(solution);
-    }
-    else{
-      std::shared_ptr<Individual> new_solution = solution->deepcopy();
-      mutation_->mutate(new_solution);
-      new_solution->evaluate();
-      if(checkBetterSolution(new_solution)){
-        solution = new_solution;
-      }
+bool StochasticLocalSearch::step() {
+  if(callbacks_->shouldTerminate())
+    return false;
+  callbacks_->pollOutsideSolution();
+  if(checkOutsideSolution()){
+    solution_ = best_individual_->deepcopy();
+  }
+  if(mutation_->isInPlace()){
+    mutation_->mutate(solution_);
+    solution_->evaluate();
+    checkBetterSolution(solution_);
+  }
+  else{
+    std::shared_ptr<Individual> new_solution = solution_->deepcopy();
+    mutation_->mutate(new_solution);
+    new_solution->evaluate();
+    if(checkBetterSolution(new_solution)){
+      solution_ = new_solution;
     }
   }
+  return true;
 }
 
 bool StochasticLocalSearch::checkBetterSolution(
@@ -21,37 +21,41 @@ StochasticRanking::StochasticRanking(
   assert(crossover != nullptr);
 }
 
-void StochasticRanking::run(
+void StochasticRanking::start(
     const std::shared_ptr<PopulationStochasticRanking> &initialPopulation) {
   population_ = initialPopulation;
   population_->evaluate();
   best_individual_ = population_->getBestIndividual();
+}
 
-  while(!callbacks_->shouldTerminate()){
-    auto select_size = (int)((double)population_->size() * crossover_->getCrossoverRate());
-    auto population_cast = std::static_pointer_cast<Population>(population_);
-    auto selection = selection_->select(population_cast, select_size);
-    auto child_pop_cast = crossover_->crossover(population_, selection);
-    auto child_pop = std::static_pointer_cast<PopulationStochasticRanking>(child_pop_cast);
+bool StochasticRanking::step() {
+  if(callbacks_->shouldTerminate())
+    return false;
+  callbacks_->pollOutsideSolution();
+  auto select_size = (int)((double)population_->size() * crossover_->getCrossoverRate());
+  auto population_cast = std::static_pointer_cast<Population>(population_);
+  auto selection = selection_->select(population_cast, select_size);
+  auto child_pop_cast = crossover_->crossover(population_, selection);
+  auto child_pop = std::static_pointer_cast<PopulationStochasticRanking>(child_pop_cast);
 
-    for(uint i = 0; i < child_pop->size(); i++){
-      if(getRandomBool(mutation_->getMutationRate())){
-        const auto &individual = child_pop->getIndividual(i);
-        individual->evaluate();
-        mutation_->mutate(individual);
-        individual->resetEvaluated();
-      }
-    }
-    checkOutsideSolution(child_pop);
-    child_pop->evaluate();
-    if(checkBetterSolution(child_pop->getBestIndividual())){
-      callbacks_->newBestSolution(child_pop->getBestIndividual());
+  for(uint i = 0; i < child_pop->size(); i++){
+    if(getRandomBool(mutation_->getMutationRate())){
+      const auto &individual = child_pop->getIndividual(i);
+      individual->evaluate();
+      mutation_->mutate(individual);
+      individual->resetEvaluated();
     }
-    uint prev_size = population_->size();
-    population_->merge(child_pop);
-    population_->rank();
-    population_->shrink(prev_size);
   }
+  checkOutsideSolution(child_pop);
+  child_pop->evaluate();
+  if(checkBetterSolution(child_pop->getBestIndividual())){
+    callbacks_->newBestSolution(child_pop->getBestIndividual());
+  }
+  uint prev_size = population_->size();
+  population_->merge(child_pop);
+  population_->rank();
+  population_->shrink(prev_size);
+  return true;
 }
 
 bool StochasticRanking::checkBetterSolution(
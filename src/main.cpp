@@ -4,8 +4,14 @@
 #include "common/portfolio.h"
 #include "json.hpp"
 #include "common/logger.h"
+#include "common/routing_instance.h"
+#include "common/optal_comms.h"
+#include "common/serializer.h"
+#include "common/thread_scheduling.h"
 #include <fstream>
 #include <iostream>
+#include <string_view>
+#include <vector>
 
 using JSON = nlohmann::json;
 
@@ -33,21 +39,32 @@ JSON loadConfig(const char *config_filename)
 
 int main(int argc, char *argv[])
 {
-  if (argc < 4)
+  // flags may appear anywhere, the rest are positional arguments
+  std::vector<char *> args;
+  for (int i = 0; i < argc; i++)
   {
-    std::cerr << "Usage: ./Heuristic configFilename instanceFilename logfile [randomSeed]" << std::endl;
+    if (std::string_view(argv[i]) == "--binary-protocol")
+      SolutionSerializer::setBinaryProtocol(true);
+    else if (std::string_view(argv[i]) == "--shm-channel" && i + 1 < argc)
+      OptalComms::setSharedMemoryChannel(argv[++i]);
+    else
+      args.push_back(argv[i]);
   }
-  const char *config_filename = argv[1];
-  const char *instance_filename = argv[2];
-  const char *log_filename = argv[3];
+  if (args.size() < 4)
+  {
+    std::cerr << "Usage: ./Heuristic configFilename instanceFilename logfile [randomSeed] [--binary-protocol] [--shm-channel name]" << std::endl;
+  }
+  const char *config_filename = args[1];
+  const char *instance_filename = args[2];
+  const char *log_filename = args[3];
 
-  if (argc > 4)
+  if (args.size() > 4)
   {
     errno = 0;
-    const int seed = (int)strtol(argv[4], nullptr, 10);
+    const int seed = (int)strtol(args[4], nullptr, 10);
     if (errno != 0)
     {
-      std::cerr << "Seed argument present but has invalid value: " << argv[4] << std::endl;
+      std::cerr << "Seed argument present but has invalid value: " << args[4] << std::endl;
       exit(100);
     }
     srand(seed);
@@ -55,6 +72,25 @@ int main(int argc, char *argv[])
   }
 
   JSON config_json = loadConfig(config_filename);
+  if (config_json.contains("instance_cache"))
+  {
+    // directory of binary instance images reused by later runs on the same instance
+    RoutingInstance::setCacheDirectory(config_json["instance_cache"].get<std::string>());
+  }
+  // standalone runs without Optal closing stdin end after the limit with the final best solution written
+  double time_limit = 0;
+  if (config_json.contains("time_limit"))
+  {
+    if (!config_json["time_limit"].is_number() || config_json["time_limit"].get<double>() <= 0)
+    {
+      std::cerr << "Invalid time_limit, expected a positive number of seconds" << std::endl;
+      exit(100);
+    }
+    time_limit = config_json["time_limit"].get<double>();
+  }
+  // placement of the heuristic threads, unpinned and uncapped when not configured
+  auto scheduling = config_json.contains("scheduling") ?
+      std::make_shared<ThreadScheduling>(config_json["scheduling"]) : std::make_shared<ThreadScheduling>();
   std::shared_ptr<HeuristicPortfolio> portfolio = nullptr;
   if (!config_json.contains("problem"))
   {
@@ -64,17 +100,17 @@ int main(int argc, char *argv[])
   else if (config_json["problem"] == "TSP")
   {
     auto setup = SetupTSP();
-    portfolio = setup.preparePortfolio(config_json["heuristics"], instance_filename);
+    portfolio = setup.preparePortfolio(config_json["heuristics"], instance_filename, scheduling);
   }
   else if (config_json["problem"] == "CVRP")
   {
     auto setup = SetupCVRP();
-    portfolio = setup.preparePortfolio(config_json["heuristics"], instance_filename);
+    portfolio = setup.preparePortfolio(config_json["heuristics"], instance_filename, scheduling);
   }
   else if (config_json["problem"] == "VRP-TW")
   {
     auto setup = SetupVRPTW();
-    portfolio = setup.preparePortfolio(config_json["heuristics"], instance_filename);
+    portfolio = setup.preparePortfolio(config_json["heuristics"], instance_filename, scheduling);
   }
   else
   {
@@ -89,6 +125,7 @@ int main(int argc, char *argv[])
 
   auto logger = std::make_shared<ObjectiveValueLogger>(log_filename);
   portfolio->setLogger(logger);
+  portfolio->setTimeLimit(time_limit);
   portfolio->start();
 
   return 0;